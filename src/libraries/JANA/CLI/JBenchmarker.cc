@@ -5,6 +5,8 @@
 #include "JBenchmarker.h"
 
 #include <JANA/Utils/JCpuInfo.h>
+#include <JANA/Engine/JArrowProcessingController.h>
+#include <JANA/Engine/JAutotuner.h>
 
 #include <fstream>
 #include <cmath>
@@ -17,8 +19,21 @@ JBenchmarker::JBenchmarker(JApplication* app) : m_app(app) {
 
     auto params = app->GetJParameterManager();
 
-    params->SetParameter("NEVENTS", 0);
-    // Prevent users' choice of events from interfering with everything
+    params->SetDefaultParameter(
+            "BENCHMARK:AUTOTUNE",
+            m_autotune,
+            "Instead of sweeping nthreads, process the events as usual while tuning nthreads, "
+            "jana:event_source_chunksize and jana:event_queue_threshold for the best events/sec per core");
+
+    params->SetDefaultParameter(
+            "BENCHMARK:AUTOTUNE_INTERVAL_MS",
+            m_autotune_interval_ms,
+            "Time (in milliseconds) the autotuner measures each setting for");
+
+    if (!m_autotune) {
+        params->SetParameter("NEVENTS", 0);
+        // Prevent users' choice of events from interfering with everything
+    }
 
     params->SetDefaultParameter(
             "BENCHMARK:NSAMPLES",
@@ -55,6 +70,10 @@ JBenchmarker::~JBenchmarker() {}
 
 void JBenchmarker::RunUntilFinished() {
 
+    if (m_autotune) {
+        RunAutotuned();
+        return;
+    }
     m_app->SetTicker(false);
     m_app->Run(false);
 
@@ -143,6 +162,80 @@ void JBenchmarker::RunUntilFinished() {
 }
 
 
+void JBenchmarker::RunAutotuned() {
+
+    using clock_t = std::chrono::steady_clock;
+    using secs = std::chrono::duration<double>;
+
+    m_app->Run(false);
+    if (m_app->IsQuitting()) return;
+    auto japc = m_app->GetService<JArrowProcessingController>();
+    auto params = m_app->GetJParameterManager();
+
+    JAutotuner::Settings settings;
+    settings.nthreads = japc->get_nthreads();
+    settings.event_source_chunksize = params->GetParameterValue<size_t>("jana:event_source_chunksize");
+    settings.event_queue_threshold = params->GetParameterValue<size_t>("jana:event_queue_threshold");
+
+    JAutotuner::Limits limits;
+    limits.min_threads = m_min_threads;
+    limits.max_threads = m_max_threads;  // The event pool was sized for this many threads
+    limits.max_event_queue_threshold = 2 * settings.event_queue_threshold;  // Fits inside the lock-free rings
+    JAutotuner tuner(settings, limits);
+
+    LOG_INFO(m_logger) << "Autotuning every " << m_autotune_interval_ms << " ms, starting from nthreads="
+                       << settings.nthreads << ", event_source_chunksize=" << settings.event_source_chunksize
+                       << ", event_queue_threshold=" << settings.event_queue_threshold << LOG_END;
+
+    auto start_time = clock_t::now();
+    auto last_time = start_time;
+    size_t last_event_count = japc->measure_internal_performance()->monotonic_events_completed;
+
+    while (!m_app->IsQuitting() && !japc->is_stopped() && !japc->is_finished()) {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_autotune_interval_ms));
+        auto perf = japc->measure_internal_performance();
+        auto now = clock_t::now();
+        double throughput_hz = (perf->monotonic_events_completed - last_event_count) / secs(now - last_time).count();
+        last_event_count = perf->monotonic_events_completed;
+        last_time = now;
+
+        auto decision_count = tuner.get_decisions().size();
+        auto next = tuner.update(secs(now - start_time).count(), throughput_hz, *perf);
+
+        for (size_t i=decision_count; i<tuner.get_decisions().size(); ++i) {
+            auto& d = tuner.get_decisions()[i];
+            LOG_INFO(m_logger) << (d.accepted ? "Keeping " : "Reverting ") << to_string(d.knob) << " "
+                               << d.old_value << " -> " << d.new_value << " (" << d.baseline_hz << " Hz -> "
+                               << d.trial_hz << " Hz; tried because " << d.reason << ")" << LOG_END;
+        }
+
+        if (next.event_queue_threshold != settings.event_queue_threshold) {
+            japc->set_event_queue_threshold(next.event_queue_threshold);
+        }
+        if (next.event_source_chunksize != settings.event_source_chunksize) {
+            japc->set_event_source_chunksize(next.event_source_chunksize);
+        }
+        if (next.nthreads != settings.nthreads) {
+            m_app->Scale(next.nthreads);
+        }
+        settings = next;
+    }
+
+    auto& best = tuner.get_best_settings();
+    LOG_INFO(m_logger) << "Autotuning finished. Best settings found: nthreads=" << best.nthreads
+                       << ", event_source_chunksize=" << best.event_source_chunksize
+                       << ", event_queue_threshold=" << best.event_queue_threshold << LOG_END;
+
+    std::cout << "Writing autotuning decisions to: " << m_output_dir << "/autotune.dat" << std::endl;
+    mkdir(m_output_dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    std::ofstream ofs(m_output_dir + "/autotune.dat");
+    tuner.write_decisions(ofs);
+    ofs.close();
+    m_app->Quit();
+}
+
+
 void JBenchmarker::copy_to_output_dir(std::string filename) {
 
     // Substitute environment variables in given filename
@@ -17,6 +17,8 @@ class JBenchmarker {
     unsigned m_thread_step = 1;
     unsigned m_nsamples = 15;
     std::string m_output_dir = "JANA_Test_Results";
+    bool m_autotune = false;
+    unsigned m_autotune_interval_ms = 2000;
 
 public:
     explicit JBenchmarker(JApplication* app);
@@ -24,6 +26,7 @@ public:
     void RunUntilFinished();
 
 private:
+    void RunAutotuned();
     void copy_to_output_dir(std::string filename);
 };
 
@@ -6,6 +6,7 @@
 #define _JCalibration_
 
 #include <JANA/JException.h>
+#include <JANA/Calibrations/JCalibrationCache.h>
 
 #include <typeinfo>
 #include <stdint.h>
@@ -93,6 +94,10 @@ class JCalibration{
         // so the subclass should not set it.
         virtual void RetrieveEventBoundaries(void){} ///< Optional for DBs that support event-level boundaries
 
+        // Subclasses which keep a JCalibrationCache return the entry for the namepath here (or nullptr if it isn't
+        // cached), which lets the templated Get() methods skip both the string copies and the stringstream.
+        virtual const JCalibrationCache::Entry* FindCachedEntry(const string &/*namepath*/, uint64_t /*event_number*/){return NULL;}
+
     private:
         JCalibration(){} // Don't allow trivial constructor
 
@@ -146,6 +151,14 @@ bool JCalibration::Get(string namepath, map<string,T> &vals, uint64_t event_numb
     /// constants are used, then it may be more efficient for you to use
     /// the vector version of this method instead of the map one.
 
+    // Use the compiled values if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasKeyValues()){
+        entry->Get(vals);
+        RecordRequest(namepath, typeid(map<string,T>).name());
+        return false;
+    }
+
     // Get values in the form of strings
     map<string, string> svals;
     bool res = GetCalib(namepath, svals, event_number);
@@ -196,6 +209,14 @@ bool JCalibration::Get(string namepath, vector<T> &vals, uint64_t event_number)
     /// constants are used, you may want to look at using
     /// the map version of this method instead of the vector one.
 
+    // Use the compiled values if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasKeyValues()){
+        entry->Get(vals);
+        RecordRequest(namepath, typeid(vector<T>).name());
+        return false;
+    }
+
     // Get values in the form of strings
     vector<string> svals;
     bool res = GetCalib(namepath, svals, event_number);
@@ -262,6 +283,14 @@ bool JCalibration::Get(string namepath, vector< map<string,T> > &vals, uint64_t
     ///
 
 
+    // Use the compiled values if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasTable()){
+        entry->Get(vals);
+        RecordRequest(namepath, typeid(vector< map<string,T> >).name());
+        return false;
+    }
+
     // Get values in the form of strings
     vector< map<string, string> >svals;
     bool res = GetCalib(namepath, svals, event_number);
@@ -327,6 +356,14 @@ bool JCalibration::Get(string namepath, vector< vector<T> > &vals, uint64_t even
     /// So, in the above example vals[0][2] would have the value 0.234 .
     ///
 
+    // Use the compiled values if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasTable()){
+        entry->Get(vals);
+        RecordRequest(namepath, typeid(vector< vector<T> >).name());
+        return false;
+    }
+
     // Get values in the form of strings
     vector< vector<string> >svals;
     bool res = GetCalib(namepath, svals, event_number);
@@ -0,0 +1,349 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "JCalibrationCache.h"
+#include <JANA/JException.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+using namespace std;
+
+const char* JCalibrationCache::DEFAULT_FILENAME = "calib.jcache";
+
+namespace {
+
+const char kMagic[8] = {'J','C','A','L','I','B','C','1'};
+const uint32_t kVersion = 1;
+const uint32_t kByteOrderCheck = 0x01020304;
+
+struct FileHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t entry_count;
+    uint64_t entries;       // EntryRecord[entry_count]
+    uint64_t file_size;
+};
+
+/// Appends arrays to the file image, each aligned to 8 bytes
+class Image{
+    public:
+        vector<char> data;
+        unordered_map<string, uint64_t> string_offsets;
+
+        uint64_t Reserve(size_t bytes){
+            data.resize((data.size() + 7) & ~size_t(7));
+            uint64_t offset = data.size();
+            data.resize(data.size() + bytes);
+            return offset;
+        }
+
+        template<typename T> uint64_t Append(const vector<T> &v){
+            uint64_t offset = Reserve(v.size()*sizeof(T));
+            if(!v.empty()) memcpy(&data[offset], v.data(), v.size()*sizeof(T));
+            return offset;
+        }
+
+        JCalibrationCache::StringRef AddString(const string &s){
+            // Column names and common values repeat a lot across namepaths, so only store each one once
+            auto iter = string_offsets.find(s);
+            if(iter == string_offsets.end()){
+                uint64_t offset = data.size();
+                data.insert(data.end(), s.begin(), s.end());
+                iter = string_offsets.emplace(s, offset).first;
+            }
+            return {iter->second, s.size()};
+        }
+};
+
+/// Parses a token the way a stringstream would, but only where that is unambiguous: the token must consist of
+/// nothing but a number. Anything else (e.g. "nan", "0x10", "1.5cm") is left to the stringstream.
+uint8_t ParseNumber(const string &s, double &d, float &f, int64_t &i)
+{
+    d = std::numeric_limits<double>::quiet_NaN();
+    f = std::numeric_limits<float>::quiet_NaN();
+    i = 0;
+    if(s.empty() || s.find_first_not_of("0123456789+-.eE") != string::npos) return 0;
+
+    uint8_t flags = 0;
+    const char *str = s.c_str();
+    char *end;
+
+    errno = 0;
+    double dv = strtod(str, &end);
+    if(*end == '\0' && errno == 0){ d = dv; flags |= JCalibrationCache::kIsDouble; }
+
+    errno = 0;
+    float fv = strtof(str, &end);
+    if(*end == '\0' && errno == 0){ f = fv; flags |= JCalibrationCache::kIsFloat; }
+
+    errno = 0;
+    long long iv = strtoll(str, &end, 10);
+    if(*end == '\0' && errno == 0){ i = iv; flags |= JCalibrationCache::kIsInteger; }
+
+    return flags;
+}
+
+JCalibrationCache::ColumnRecord AppendColumn(Image &image, const vector<string> &values)
+{
+    vector<JCalibrationCache::StringRef> strings;
+    vector<double> doubles(values.size());
+    vector<float> floats(values.size());
+    vector<int64_t> ints(values.size());
+    vector<uint8_t> flags(values.size());
+    for(size_t i=0; i<values.size(); i++){
+        strings.push_back(image.AddString(values[i]));
+        flags[i] = ParseNumber(values[i], doubles[i], floats[i], ints[i]);
+    }
+
+    JCalibrationCache::ColumnRecord record;
+    record.count = values.size();
+    record.strings = image.Append(strings);
+    record.doubles = image.Append(doubles);
+    record.floats = image.Append(floats);
+    record.ints = image.Append(ints);
+    record.flags = image.Append(flags);
+    return record;
+}
+
+uint64_t AppendStrings(Image &image, const vector<string> &values)
+{
+    vector<JCalibrationCache::StringRef> strings;
+    for(auto &s : values) strings.push_back(image.AddString(s));
+    return image.Append(strings);
+}
+
+} // namespace
+
+
+//---------------------------------
+// Builder::Add
+//---------------------------------
+void JCalibrationCache::Builder::Add(const string &namepath, int32_t run_min, int32_t run_max, int64_t source_mtime, uint64_t source_size,
+                                     const vector< pair<string,string> > *key_values,
+                                     const vector<string> *colnames, const vector< vector<string> > *rows)
+{
+    Source source;
+    source.namepath = namepath;
+    source.run_min = run_min;
+    source.run_max = run_max;
+    source.source_mtime = source_mtime;
+    source.source_size = source_size;
+    source.flags = 0;
+    source.nrows = 0;
+    if(key_values){
+        source.flags |= kHasKeyValues;
+        source.key_values = *key_values;
+    }
+    if(colnames && rows){
+        source.flags |= kHasTable;
+        source.colnames = *colnames;
+        source.nrows = rows->size();
+        for(auto &row : *rows){
+            if(row.size() != colnames->size()) throw JException("JCalibrationCache: Table for %s is not rectangular", namepath.c_str());
+            source.cells.insert(source.cells.end(), row.begin(), row.end());
+        }
+    }
+    sources.push_back(std::move(source));
+}
+
+//---------------------------------
+// Builder::Write
+//---------------------------------
+void JCalibrationCache::Builder::Write(const string &filename) const
+{
+    // Entries are sorted so that Find() can do a binary search right on the mapped file
+    vector<const Source*> sorted;
+    for(auto &source : sources) sorted.push_back(&source);
+    sort(sorted.begin(), sorted.end(), [](const Source *a, const Source *b){
+        return (a->namepath != b->namepath) ? a->namepath < b->namepath : a->run_min < b->run_min;
+    });
+
+    Image image;
+    uint64_t header_offset = image.Reserve(sizeof(FileHeader));
+    uint64_t entries_offset = image.Reserve(sorted.size()*sizeof(EntryRecord));
+
+    vector<EntryRecord> records;
+    for(auto source : sorted){
+        EntryRecord record;
+        memset(&record, 0, sizeof(record));
+        record.namepath = image.AddString(source->namepath);
+        record.run_min = source->run_min;
+        record.run_max = source->run_max;
+        record.source_mtime = source->source_mtime;
+        record.source_size = source->source_size;
+        record.flags = source->flags;
+
+        vector<string> keys, values;
+        for(auto &kv : source->key_values){
+            keys.push_back(kv.first);
+            values.push_back(kv.second);
+        }
+        record.keys = AppendStrings(image, keys);
+        record.key_values = AppendColumn(image, values);
+
+        record.ncols = source->colnames.size();
+        record.nrows = source->nrows;
+        record.colnames = AppendStrings(image, source->colnames);
+        record.cells = AppendColumn(image, source->cells);
+        records.push_back(record);
+    }
+
+    FileHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderCheck;
+    header.entry_count = records.size();
+    header.entries = entries_offset;
+    header.file_size = image.data.size();
+    memcpy(&image.data[header_offset], &header, sizeof(header));
+    if(!records.empty()) memcpy(&image.data[entries_offset], records.data(), records.size()*sizeof(EntryRecord));
+
+    // Write to a temporary file first, so that readers never map a half-written cache
+    string tmpname = filename + ".tmp";
+    ofstream f(tmpname.c_str(), ios::binary | ios::trunc);
+    if(!f.is_open()) throw JException("JCalibrationCache: Unable to open \"%s\" for writing", tmpname.c_str());
+    f.write(image.data.data(), image.data.size());
+    f.close();
+    if(!f || rename(tmpname.c_str(), filename.c_str()) != 0){
+        unlink(tmpname.c_str());
+        throw JException("JCalibrationCache: Unable to write \"%s\"", filename.c_str());
+    }
+}
+
+
+//---------------------------------
+// JCalibrationCache    (Constructor)
+//---------------------------------
+JCalibrationCache::JCalibrationCache(const string &filename, const string &basedir):filename(filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) throw JException("JCalibrationCache: Unable to open \"%s\"", filename.c_str());
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader)){
+        close(fd);
+        throw JException("JCalibrationCache: \"%s\" is too short to be a calibration cache", filename.c_str());
+    }
+    length = st.st_size;
+    void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping stays valid without it
+    if(mapping == MAP_FAILED) throw JException("JCalibrationCache: Unable to map \"%s\"", filename.c_str());
+    base = (const char*)mapping;
+
+    try{
+        FileHeader header;
+        memcpy(&header, base, sizeof(header));
+        if(memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion){
+            throw JException("JCalibrationCache: \"%s\" is not a calibration cache of version %d", filename.c_str(), kVersion);
+        }
+        if(header.byte_order != kByteOrderCheck) throw JException("JCalibrationCache: \"%s\" was written with a different byte order", filename.c_str());
+        if(header.file_size != length) throw JException("JCalibrationCache: \"%s\" is truncated", filename.c_str());
+        if(header.entry_count > length/sizeof(EntryRecord)) throw JException("JCalibrationCache: \"%s\" is corrupt", filename.c_str());
+        CheckRange(header.entries, header.entry_count*sizeof(EntryRecord));
+
+        auto records = (const EntryRecord*)(base + header.entries);
+        entries.resize(header.entry_count);
+        for(size_t i=0; i<header.entry_count; i++){
+            auto &entry = entries[i];
+            auto &record = records[i];
+            CheckRange(record.namepath.offset, record.namepath.length);
+            if(record.cells.count != record.nrows*record.ncols) throw JException("JCalibrationCache: \"%s\" is corrupt", filename.c_str());
+            entry.record = &record;
+            entry.namepath = base + record.namepath.offset;
+            entry.namepath_length = record.namepath.length;
+            entry.keys = MakeStrings(record.keys, record.key_values.count);
+            entry.values = MakeColumn(record.key_values);
+            entry.colnames = MakeStrings(record.colnames, record.ncols);
+            entry.cells = MakeColumn(record.cells);
+
+            if(!basedir.empty()){
+                // Stat'ing here once is much cheaper than doing so on every lookup
+                struct stat source_st;
+                string source = basedir + entry.GetNamepath();
+                entry.stale = stat(source.c_str(), &source_st) != 0 ||
+                              (int64_t)source_st.st_mtime != record.source_mtime ||
+                              (uint64_t)source_st.st_size != record.source_size;
+                if(entry.stale) stale_count++;
+            }
+        }
+    }
+    catch(...){
+        munmap((void*)base, length);
+        throw;
+    }
+}
+
+//---------------------------------
+// ~JCalibrationCache    (Destructor)
+//---------------------------------
+JCalibrationCache::~JCalibrationCache()
+{
+    munmap((void*)base, length);
+}
+
+//---------------------------------
+// Find
+//---------------------------------
+const JCalibrationCache::Entry* JCalibrationCache::Find(const string &namepath, int32_t run) const
+{
+    auto less = [](const Entry &entry, const string &name){
+        int cmp = memcmp(entry.namepath, name.data(), min(entry.namepath_length, name.size()));
+        return (cmp != 0) ? cmp < 0 : entry.namepath_length < name.size();
+    };
+    auto iter = lower_bound(entries.begin(), entries.end(), namepath, less);
+    for(; iter!=entries.end(); ++iter){
+        if(iter->namepath_length != namepath.size() || memcmp(iter->namepath, namepath.data(), namepath.size()) != 0) break;
+        if(run >= iter->GetRunMin() && run <= iter->GetRunMax()) return iter->stale ? nullptr : &(*iter);
+    }
+    return nullptr;
+}
+
+//---------------------------------
+// CheckRange
+//---------------------------------
+void JCalibrationCache::CheckRange(uint64_t offset, uint64_t bytes) const
+{
+    if(offset > length || bytes > length - offset) throw JException("JCalibrationCache: \"%s\" is corrupt", filename.c_str());
+}
+
+//---------------------------------
+// MakeStrings
+//---------------------------------
+JCalibrationCache::Column JCalibrationCache::MakeStrings(uint64_t offset, uint64_t count) const
+{
+    if(count > length/sizeof(StringRef)) throw JException("JCalibrationCache: \"%s\" is corrupt", filename.c_str());
+    CheckRange(offset, count*sizeof(StringRef));
+    Column column;
+    column.base = base;
+    column.count = count;
+    column.strings = (const StringRef*)(base + offset);
+    for(size_t i=0; i<count; i++) CheckRange(column.strings[i].offset, column.strings[i].length);
+    return column;
+}
+
+//---------------------------------
+// MakeColumn
+//---------------------------------
+JCalibrationCache::Column JCalibrationCache::MakeColumn(const ColumnRecord &record) const
+{
+    Column column = MakeStrings(record.strings, record.count);
+    CheckRange(record.doubles, record.count*sizeof(double));
+    CheckRange(record.floats, record.count*sizeof(float));
+    CheckRange(record.ints, record.count*sizeof(int64_t));
+    CheckRange(record.flags, record.count*sizeof(uint8_t));
+    column.doubles = (const double*)(base + record.doubles);
+    column.floats = (const float*)(base + record.floats);
+    column.ints = (const int64_t*)(base + record.ints);
+    column.flags = (const uint8_t*)(base + record.flags);
+    return column;
+}
@@ -0,0 +1,229 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef _JCalibrationCache_
+#define _JCalibrationCache_
+
+#include <stdint.h>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// JCalibrationCache is a compiled form of a JCalibrationFile directory tree. Each namepath is parsed once, and its
+/// strings are stored together with their values as double, float and int64 in a single binary file, which is then
+/// memory-mapped. Lookups are a binary search over a sorted index, the string accessors copy straight out of the
+/// mapping, and the typed accessors skip the stringstream for any token that parses cleanly as a number. The numeric
+/// arrays can also be used in place, e.g. GetTableDoubles(), without copying anything.
+///
+/// Every entry covers the run range from the "# Run range: min - max" header that JCalibrationFile::PutCalib writes,
+/// or all runs if there is none. An entry whose text file changed (size or mtime) after it was compiled is ignored,
+/// so that callers fall back to reading the text. The file is in native byte order and is not meant to be shared
+/// between machines of different architecture; a mismatch is detected and the cache is rejected.
+class JCalibrationCache{
+    public:
+        static const char* DEFAULT_FILENAME;
+
+        /// Strings are stored as absolute offsets into the file
+        struct StringRef{
+            uint64_t offset;
+            uint64_t length;
+        };
+
+        /// A column of values: strings always, numbers only where the whole token parsed as one
+        struct ColumnRecord{
+            uint64_t count;
+            uint64_t strings;   // StringRef[count]
+            uint64_t doubles;   // double[count], NaN where not a number
+            uint64_t floats;    // float[count]
+            uint64_t ints;      // int64_t[count]
+            uint64_t flags;     // uint8_t[count], kIsDouble | kIsFloat | kIsInteger
+        };
+
+        struct EntryRecord{
+            StringRef namepath;
+            int32_t run_min;
+            int32_t run_max;
+            int64_t source_mtime;
+            uint64_t source_size;
+            uint32_t flags;     // kHasKeyValues | kHasTable
+            uint32_t ncols;
+            uint64_t nrows;
+            uint64_t keys;      // StringRef[key_values.count]
+            ColumnRecord key_values;
+            uint64_t colnames;  // StringRef[ncols]
+            ColumnRecord cells; // nrows*ncols, row-major
+        };
+
+        enum{ kIsDouble=1, kIsFloat=2, kIsInteger=4 };
+        enum{ kHasKeyValues=1, kHasTable=2 };
+
+        class Column{
+            public:
+                size_t size(void) const {return count;}
+                std::string GetString(size_t i) const {return std::string(base + strings[i].offset, strings[i].length);}
+                const double* GetDoubles(void) const {return doubles;}
+
+                template<typename T> T Get(size_t i) const
+                {
+                    T v;
+                    if(!FastGet(i, v)){
+                        // Same conversion as JCalibration::Get<T> on the text
+                        std::stringstream ss(GetString(i));
+                        ss >> v;
+                    }
+                    return v;
+                }
+
+            private:
+                friend class JCalibrationCache;
+                const char *base = nullptr;
+                size_t count = 0;
+                const StringRef *strings = nullptr;
+                const double *doubles = nullptr;
+                const float *floats = nullptr;
+                const int64_t *ints = nullptr;
+                const uint8_t *flags = nullptr;
+
+                // Only the types for which the stored number is exactly what the stringstream would produce.
+                // chars and bools are read differently by a stringstream, so they take the slow path.
+                template<typename T> using IsFastInt = std::integral_constant<bool,
+                    std::is_integral<T>::value && !std::is_same<T,bool>::value && (sizeof(T)>1)>;
+
+                bool FastGet(size_t i, double &v) const {if(!(flags[i] & kIsDouble)) return false; v = doubles[i]; return true;}
+                bool FastGet(size_t i, float &v) const {if(!(flags[i] & kIsFloat)) return false; v = floats[i]; return true;}
+
+                template<typename T>
+                typename std::enable_if<IsFastInt<T>::value, bool>::type FastGet(size_t i, T &v) const
+                {
+                    if(!(flags[i] & kIsInteger)) return false;
+                    int64_t x = ints[i];
+                    if(std::is_unsigned<T>::value){
+                        if(x<0 || (uint64_t)x > (uint64_t)std::numeric_limits<T>::max()) return false;
+                    }else{
+                        if(x < (int64_t)std::numeric_limits<T>::min() || x > (int64_t)std::numeric_limits<T>::max()) return false;
+                    }
+                    v = (T)x;
+                    return true;
+                }
+
+                template<typename T>
+                typename std::enable_if<!IsFastInt<T>::value, bool>::type FastGet(size_t, T &) const {return false;}
+        };
+
+        class Entry{
+            public:
+                std::string GetNamepath(void) const {return std::string(namepath, namepath_length);}
+                int32_t GetRunMin(void) const {return record->run_min;}
+                int32_t GetRunMax(void) const {return record->run_max;}
+                bool HasKeyValues(void) const {return record->flags & kHasKeyValues;}
+                bool HasTable(void) const {return record->flags & kHasTable;}
+                size_t GetRowCount(void) const {return record->nrows;}
+                size_t GetColumnCount(void) const {return record->ncols;}
+                std::string GetColumnName(size_t col) const {return colnames.GetString(col);}
+
+                /// Zero-copy access to the numbers, valid as long as the cache is. NaN wherever the text wasn't a number.
+                const double* GetValueDoubles(void) const {return values.GetDoubles();}
+                const double* GetTableDoubles(void) const {return cells.GetDoubles();}
+
+                // The key/value form, as in the one- or two-column text format
+                template<class T> void Get(std::map<std::string,T> &vals) const
+                {
+                    vals.clear();
+                    for(size_t i=0; i<values.size(); i++) vals[keys.GetString(i)] = values.Get<T>(i);
+                }
+                template<class T> void Get(std::vector<T> &vals) const
+                {
+                    vals.clear();
+                    vals.reserve(values.size());
+                    for(size_t i=0; i<values.size(); i++) vals.push_back(values.Get<T>(i));
+                }
+
+                // The table form
+                template<class T> void Get(std::vector< std::map<std::string,T> > &vals) const
+                {
+                    vals.assign(record->nrows, std::map<std::string,T>());
+                    for(size_t row=0; row<record->nrows; row++){
+                        for(size_t col=0; col<record->ncols; col++){
+                            vals[row][colnames.GetString(col)] = cells.Get<T>(row*record->ncols + col);
+                        }
+                    }
+                }
+                template<class T> void Get(std::vector< std::vector<T> > &vals) const
+                {
+                    vals.assign(record->nrows, std::vector<T>());
+                    for(size_t row=0; row<record->nrows; row++){
+                        vals[row].reserve(record->ncols);
+                        for(size_t col=0; col<record->ncols; col++){
+                            vals[row].push_back(cells.Get<T>(row*record->ncols + col));
+                        }
+                    }
+                }
+
+            private:
+                friend class JCalibrationCache;
+                const EntryRecord *record = nullptr;
+                const char *namepath = nullptr;
+                size_t namepath_length = 0;
+                Column keys;
+                Column values;
+                Column colnames;
+                Column cells;
+                bool stale = false;
+        };
+
+        /// Collects namepaths and writes them out as a cache file. Each namepath comes in the key/value form and/or the
+        /// table form; pass nullptr for a form that can't represent the text exactly, e.g. a ragged table.
+        class Builder{
+            public:
+                void Add(const std::string &namepath, int32_t run_min, int32_t run_max, int64_t source_mtime, uint64_t source_size,
+                         const std::vector< std::pair<std::string,std::string> > *key_values,
+                         const std::vector<std::string> *colnames, const std::vector< std::vector<std::string> > *rows);
+                size_t size(void) const {return sources.size();}
+                void Write(const std::string &filename) const; ///< Throws JException on failure
+
+            private:
+                struct Source{
+                    std::string namepath;
+                    int32_t run_min;
+                    int32_t run_max;
+                    int64_t source_mtime;
+                    uint64_t source_size;
+                    uint32_t flags;
+                    std::vector< std::pair<std::string,std::string> > key_values;
+                    std::vector<std::string> colnames;
+                    std::vector<std::string> cells;
+                    size_t nrows;
+                };
+                std::vector<Source> sources;
+        };
+
+        /// Maps the given cache file, throwing a JException if it isn't a valid one. If basedir is given, entries whose
+        /// text file in basedir has changed since the cache was compiled are ignored.
+        explicit JCalibrationCache(const std::string &filename, const std::string &basedir="");
+        ~JCalibrationCache();
+
+        JCalibrationCache(const JCalibrationCache&) = delete;
+        JCalibrationCache& operator=(const JCalibrationCache&) = delete;
+
+        /// Returns the entry for namepath whose run range contains run, or nullptr
+        const Entry* Find(const std::string &namepath, int32_t run) const;
+        size_t GetEntryCount(void) const {return entries.size();}
+        size_t GetStaleCount(void) const {return stale_count;}
+
+    private:
+        std::string filename;
+        const char *base = nullptr;
+        size_t length = 0;
+        std::vector<Entry> entries;  // Sorted by namepath, then run_min
+        size_t stale_count = 0;
+
+        Column MakeColumn(const ColumnRecord &record) const;
+        Column MakeStrings(uint64_t offset, uint64_t count) const;
+        void CheckRange(uint64_t offset, uint64_t bytes) const;
+};
+
+#endif // _JCalibrationCache_
@@ -14,6 +14,8 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <limits>
+#include <stdio.h>
 using namespace std;
 
 
@@ -59,6 +61,9 @@ JCalibrationFile::JCalibrationFile(string url, int32_t run, string context):JCal
 
     // Close info file
     f.close();
+
+    // Use the compiled constants if somebody has run CompileCache() on this directory
+    LoadCache();
 }
 
 //---------------------------------
@@ -87,6 +92,13 @@ bool JCalibrationFile::GetCalib(string namepath, map<string, string> &svals, uin
     // Clear svals map.
     svals.clear();
 
+    // Use the compiled constants if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasKeyValues()){
+        entry->Get(svals);
+        return false;
+    }
+
     // Open file
     string fname = basedir + namepath;
     ifstream f(fname.c_str());
@@ -153,6 +165,13 @@ bool JCalibrationFile::GetCalib(string namepath, vector<string> &svals, uint64_t
     // Clear svals map.
     svals.clear();
 
+    // Use the compiled constants if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasKeyValues()){
+        entry->Get(svals);
+        return false;
+    }
+
     // Open file
     string fname = basedir + namepath;
     ifstream f(fname.c_str());
@@ -219,6 +238,13 @@ bool JCalibrationFile::GetCalib(string namepath, vector< map<string, string> > &
     // Clear svals map.
     svals.clear();
 
+    // Use the compiled constants if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasTable()){
+        entry->Get(svals);
+        return false;
+    }
+
     // Open file
     string fname = basedir + namepath;
     ifstream f(fname.c_str());
@@ -303,6 +329,13 @@ bool JCalibrationFile::GetCalib(string namepath, vector< vector<string> > &svals
     // Clear svals map.
     svals.clear();
 
+    // Use the compiled constants if we have them
+    const JCalibrationCache::Entry *entry = FindCachedEntry(namepath, event_number);
+    if(entry && entry->HasTable()){
+        entry->Get(svals);
+        return false;
+    }
+
     // Open file
     string fname = basedir + namepath;
     ifstream f(fname.c_str());
@@ -544,6 +577,7 @@ void JCalibrationFile::AddToNamepathList(string dirname, vector<string> &namepat
         string name(dp->d_name);
         if(name=="." || name==".." || name==".svn")continue; // ignore this directory and its parent
         if(name=="info.xml" || name==".DS_Store")continue;
+        if(name==JCalibrationCache::DEFAULT_FILENAME)continue;
 
         // Check if this is a directory and if so, recall to add those
         // namepaths as well.
@@ -566,3 +600,158 @@ void JCalibrationFile::AddToNamepathList(string dirname, vector<string> &namepat
     closedir(dir);
 }
 
+
+//---------------------------------
+// FindCachedEntry
+//---------------------------------
+const JCalibrationCache::Entry* JCalibrationFile::FindCachedEntry(const string &namepath, uint64_t /*event_number*/)
+{
+    if(!cache)return NULL;
+    return cache->Find(namepath, GetRun());
+}
+
+//---------------------------------
+// LoadCache
+//---------------------------------
+void JCalibrationFile::LoadCache(void)
+{
+    cache.reset();
+    string fname = basedir + JCalibrationCache::DEFAULT_FILENAME;
+    struct stat st;
+    if(stat(fname.c_str(), &st) != 0)return;
+    try{
+        cache.reset(new JCalibrationCache(fname, basedir));
+        if(cache->GetStaleCount() != 0){
+            jout<<"WARNING: "<<cache->GetStaleCount()<<" of "<<cache->GetEntryCount()<<" namepaths in \""<<fname
+                <<"\" are out of date and will be read from text. Recompile to speed them up again."<<std::endl;
+        }
+    }catch(JException &e){
+        jout<<"WARNING: Ignoring calibration cache: "<<e.GetMessage()<<std::endl;
+    }
+}
+
+//---------------------------------
+// CompileCache
+//---------------------------------
+size_t JCalibrationFile::CompileCache(void)
+{
+    // Parse the text itself, not the cache we are about to replace
+    cache.reset();
+
+    vector<string> namepaths;
+    GetListOfNamepaths(namepaths);
+    JCalibrationCache::Builder builder;
+    for(unsigned int i=0; i<namepaths.size(); i++){
+        ParseForCache(namepaths[i], builder);
+    }
+    builder.Write(basedir + JCalibrationCache::DEFAULT_FILENAME);
+    LoadCache();
+
+    return builder.size();
+}
+
+//---------------------------------
+// ParseForCache
+//---------------------------------
+void JCalibrationFile::ParseForCache(string namepath, JCalibrationCache::Builder &builder)
+{
+    /// Parse the file for namepath into both the key/value and the table
+    /// forms, and hand them to the builder. Each form is checked against
+    /// what the GetCalib methods return for the text, and is left out of
+    /// the cache if the two differ, so that the cache never changes what
+    /// anybody gets back. If neither form is usable the namepath is skipped.
+
+    string fname = basedir + namepath;
+    struct stat st;
+    if(stat(fname.c_str(), &st) != 0)return;
+    ifstream f(fname.c_str());
+    if(!f.is_open())return;
+
+    int32_t run_min = std::numeric_limits<int32_t>::min();
+    int32_t run_max = std::numeric_limits<int32_t>::max();
+    vector< pair<string,string> > key_values;
+    vector<string> colnames;
+    vector< vector<string> > rows;
+    bool table_ok = true;
+
+    string line;
+    while(getline(f, line, '\n')){
+        if(line.length()==0)continue;
+        if(line.substr(0,12) == "# Run range:"){
+            int rmin, rmax;
+            if(sscanf(line.c_str(), "# Run range: %d - %d", &rmin, &rmax) == 2){
+                run_min = rmin;
+                run_max = rmax;
+            }
+        }
+        if(line.substr(0,2) == "#%"){
+            // Column names which change partway through the table can't be represented
+            if(!rows.empty())table_ok = false;
+            stringstream sss(line.substr(2));
+            colnames.clear();
+            string colname;
+            while(sss>>colname)colnames.push_back(colname);
+        }
+        if(line[0] == '#')continue;
+
+        // Key/value form: see GetCalib(string, map<string, string>&)
+        stringstream ss(line);
+        string key, val;
+        ss>>key;
+        if(key==line){
+            val = key;
+            stringstream sss;
+            sss << setw(4) << setfill('0') << key_values.size();
+            sss>>key;
+        }else{
+            ss>>val;
+        }
+        key_values.push_back(make_pair(key, val));
+
+        // Table form: see GetCalib(string, vector< map<string, string> >&)
+        stringstream ts(line);
+        vector<string> row;
+        while(ts>>val){
+            if(colnames.size()<=row.size()){
+                stringstream sss;
+                sss << setw(4) << setfill('0') << row.size();
+                colnames.push_back(sss.str());
+            }
+            row.push_back(val);
+        }
+        if(!rows.empty() && row.size() != rows[0].size())table_ok = false;
+        rows.push_back(row);
+    }
+    f.close();
+    if(rows.empty())return; // The text table readers can't handle empty files, so leave them to fail the same way
+    colnames.resize(rows[0].size());
+
+    try{
+        // Check the key/value form against the text readers
+        map<string,string> text_map, cached_map;
+        vector<string> text_vector, cached_vector;
+        for(unsigned int i=0; i<key_values.size(); i++){
+            cached_map[key_values[i].first] = key_values[i].second;
+            cached_vector.push_back(key_values[i].second);
+        }
+        bool kv_ok = !GetCalib(namepath, text_map) && !GetCalib(namepath, text_vector) &&
+                     text_map == cached_map && text_vector == cached_vector;
+
+        // Check the table form against the text readers
+        if(table_ok){
+            vector< vector<string> > text_rows;
+            vector< map<string,string> > text_maps, cached_maps(rows.size());
+            for(unsigned int i=0; i<rows.size(); i++){
+                for(unsigned int j=0; j<rows[i].size(); j++)cached_maps[i][colnames[j]] = rows[i][j];
+            }
+            table_ok = !GetCalib(namepath, text_rows) && !GetCalib(namepath, text_maps) &&
+                       text_rows == rows && text_maps == cached_maps;
+        }
+
+        if(!kv_ok && !table_ok)return;
+        builder.Add(namepath, run_min, run_max, st.st_mtime, st.st_size,
+                    kv_ok ? &key_values : NULL, table_ok ? &colnames : NULL, table_ok ? &rows : NULL);
+    }catch(JException &e){
+        // Leave it to the text reader to complain at lookup time
+    }
+}
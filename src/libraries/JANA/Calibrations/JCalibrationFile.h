@@ -6,8 +6,10 @@
 #define _JCalibrationFile_
 
 #include "JCalibration.h"
+#include "JCalibrationCache.h"
 
 #include <fstream>
+#include <memory>
 
 class JCalibrationFile:public JCalibration{
     public:
@@ -24,7 +26,14 @@ class JCalibrationFile:public JCalibration{
         bool PutCalib(string namepath, int32_t run_min, int32_t run_max, uint64_t event_min, uint64_t event_max, string &author, vector< map<string, string> > &svals, string comment="");
         void GetListOfNamepaths(vector<string> &namepaths);
 
+        /// Compiles every namepath into basedir/calib.jcache, which this and every later JCalibrationFile on the
+        /// same directory then read from. Returns the number of namepaths compiled. Don't call while other
+        /// threads are reading constants.
+        size_t CompileCache(void);
+        bool HasCache(void) const {return cache != nullptr;}
+
     protected:
+        const JCalibrationCache::Entry* FindCachedEntry(const string &namepath, uint64_t event_number) override;
 
         std::ofstream* CreateItemFile(string namepath, int32_t run_min, int32_t run_max, string &author, string &comment);
         void MakeDirectoryPath(string namepath);
@@ -33,8 +42,11 @@ class JCalibrationFile:public JCalibration{
         JCalibrationFile();
 
         string basedir;
+        std::unique_ptr<JCalibrationCache> cache;
 
         void AddToNamepathList(string dir, vector<string> &namepaths);
+        void LoadCache(void);
+        void ParseForCache(string namepath, JCalibrationCache::Builder &builder);
 };
 
 
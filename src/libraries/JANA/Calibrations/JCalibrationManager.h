@@ -7,20 +7,36 @@
 #include <JANA/Calibrations/JCalibration.h>
 #include <JANA/Calibrations/JCalibrationFile.h>
 #include <JANA/Calibrations/JCalibrationGenerator.h>
+#include <JANA/Calibrations/JCalibrationSnapshot.h>
 
 #include <JANA/Services/JServiceLocator.h>
 #include <JANA/Services/JLoggingService.h>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include "JLargeCalibration.h"
 
 class JCalibrationManager : public JService {
 
+    /// The snapshots of the most recent runs. A published table is never modified, only replaced.
+    struct SnapshotTable {
+        vector<std::shared_ptr<JCalibrationSnapshot>> snapshots;  // Oldest first
+    };
+
     vector<JCalibration *> m_calibrations;
     vector<JLargeCalibration *> m_resource_managers;
     vector<JCalibrationGenerator *> m_calibration_generators;
 
-    pthread_mutex_t m_calibration_mutex;
+    std::atomic<SnapshotTable*> m_snapshot_table {new SnapshotTable};
+    std::atomic<size_t> m_snapshot_readers {0};
+    std::mutex m_snapshot_mutex;                                        // Only taken when a run is seen for the first time
+    vector<SnapshotTable*> m_retired_tables;
+    vector<std::weak_ptr<JCalibrationSnapshot>> m_live_snapshots;       // Also the unpublished ones somebody still holds
+    vector<std::shared_ptr<JCalibrationSnapshot>> m_pinned_snapshots;   // Handed out as raw pointers, so never freed
+    size_t m_snapshot_runs = 4;
+
     pthread_mutex_t m_resource_manager_mutex;
 
     std::shared_ptr<JParameterManager> m_params;
@@ -29,6 +45,11 @@ class JCalibrationManager : public JService {
     std::string m_context = "default";
 
 public:
+    ~JCalibrationManager() override {
+        delete m_snapshot_table.load();
+        for (auto table : m_retired_tables) delete table;
+    }
+
     void acquire_services(JServiceLocator *service_locator) {
 
         // Configure our logger
@@ -45,6 +66,9 @@ public:
         m_params->SetDefaultParameter("JANA:CALIB_URL", m_url, "URL used to access calibration constants");
         m_params->SetDefaultParameter("JANA:CALIB_CONTEXT", m_context,
                                     "Calibration context to pass on to concrete JCalibration derived class");
+        m_params->SetDefaultParameter("JANA:CALIB_SNAPSHOT_RUNS", m_snapshot_runs,
+                                    "Number of most recent runs whose calibrations stay published for lock-free lookup");
+        if (m_snapshot_runs == 0) m_snapshot_runs = 1;
     }
 
     void AddCalibrationGenerator(JCalibrationGenerator *generator) {
@@ -60,87 +84,55 @@ public:
 
     vector<JCalibrationGenerator *> GetCalibrationGenerators() { return m_calibration_generators; }
 
-    void GetJCalibrations(vector<JCalibration *> &calibs) { calibs = m_calibrations; }
+    void GetJCalibrations(vector<JCalibration *> &calibs) {
+        /// Return every JCalibration this manager has created, oldest first, including the ones which were only ever
+        /// reached through GetSnapshot() or GetCalib(). Those are pinned like the ones GetJCalibration() hands out, so
+        /// that the returned pointers stay valid. Calibrations of old runs which have already been freed aren't listed.
+        std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+        calibs.clear();
+        for (auto& weak : m_live_snapshots) {
+            auto snapshot = weak.lock();
+            if (!snapshot) continue;
+            Pin(snapshot);
+            calibs.push_back(snapshot->GetJCalibration());
+        }
+    }
 
-    JCalibration *GetJCalibration(unsigned int run_number) {
-        /// Return a pointer to the JCalibration object that is valid for the given run number.
+    std::shared_ptr<const JCalibrationSnapshot> GetSnapshot(unsigned int run_number) {
+        /// Return the calibration snapshot for the given run number, creating it if this is the first time the run
+        /// has been seen. Returns nullptr if no JCalibration could be created for this run.
         ///
-        /// This first searches through the list of existing JCalibration objects (created by JCalibrationManager)
-        /// to see if it already has the right one. If so, a pointer to it is returned. If not, a new JCalibration
-        /// object is created and added to the internal list. Note that since we need to make sure the list is not
-        /// modified by one thread while being searched by another, a mutex is locked while searching the list.
+        /// This is cheap and lock-free whenever the run is one of the last JANA:CALIB_SNAPSHOT_RUNS runs to be looked
+        /// up, which lets every factory call it in ChangeRun() at once. Hold on to the snapshot for as long as the run
+        /// lasts: it is freed once it is no longer published and the last shared_ptr to it is gone.
+
+        // A table is only deleted while no reader is counted, and a reader counted after the table was replaced
+        // can't have loaded it, so this is safe without taking any lock.
+        m_snapshot_readers.fetch_add(1);
+        std::shared_ptr<JCalibrationSnapshot> snapshot = FindSnapshot(*m_snapshot_table.load(), run_number);
+        m_snapshot_readers.fetch_sub(1);
+        if (snapshot) return snapshot;
+        return CreateSnapshot(run_number, false);
+    }
+
+    JCalibration *GetJCalibration(unsigned int run_number) {
+        /// Return a pointer to the JCalibration object that is valid for the given run number. The same object is
+        /// returned for the same run number as long as the URL and context don't change, and it is never freed.
+        /// Prefer GetSnapshot(), which lets the calibrations of old runs be freed once they are no longer used.
         /// It is <b>NOT</b> efficient to get or even use the JCalibration object every event. Factories should access
         /// it in their brun() callback and keep a local copy of the required constants for use in the evnt() callback.
 
-
-        // Lock mutex to keep list from being modified while we search it
-        pthread_mutex_lock(&m_calibration_mutex);
-
-        vector<JCalibration *>::iterator iter = m_calibrations.begin();
-        for (; iter != m_calibrations.end(); iter++) {
-            if ((*iter)->GetRun() != (int) run_number)continue;
-            if ((*iter)->GetURL() != m_url)continue;                    // These allow specialty programs to change
-            if ((*iter)->GetContext() != m_context)continue;        // the source and still use us to instantiate
-            // Found it! Unlock mutex and return pointer
-            JCalibration *g = *iter;
-            pthread_mutex_unlock(&m_calibration_mutex);
-            return g;
-        }
-
-        // JCalibration object for this run_number doesn't exist in our list. Create a new one and add it to the list.
-        // We need to create an object of the appropriate subclass of JCalibration. This determined by looking through the
-        // existing JCalibrationGenerator objects and finding the which claims the highest probability of being able to
-        // open it based on the URL. If there are no generators claiming a non-zero probability and the URL starts with
-        // "file://", then a JCalibrationFile object is created (i.e. we don't bother making a JCalibrationGeneratorFile
-        // class and instead, handle it here.)
-
-        JCalibrationGenerator *gen = nullptr;
-        double liklihood = 0.0;
-        for (unsigned int i = 0; i < m_calibration_generators.size(); i++) {
-            double my_liklihood = m_calibration_generators[i]->CheckOpenable(m_url, run_number, m_context);
-            if (my_liklihood > liklihood) {
-                liklihood = my_liklihood;
-                gen = m_calibration_generators[i];
-            }
-        }
-
-        // Make the JCalibration object
-        JCalibration *g = nullptr;
-        if (gen) {
-            g = gen->MakeJCalibration(m_url, run_number, m_context);
+        m_snapshot_readers.fetch_add(1);
+        std::shared_ptr<JCalibrationSnapshot> snapshot = FindSnapshot(*m_snapshot_table.load(), run_number);
+        m_snapshot_readers.fetch_sub(1);
+        if (snapshot && !snapshot->m_pinned) {
+            std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+            Pin(snapshot);
         }
-        if (gen == nullptr && (m_url.find("file://") == 0)) {
-            g = new JCalibrationFile(m_url, run_number, m_context);
-        }
-        if (g) {
-            m_calibrations.push_back(g);
-            LOG_INFO(m_logger)
-                << "Created JCalibration object of type: " << g->className() << "\n"
-                << "  Generated via: "
-                << (gen == nullptr ? "fallback creation of JCalibrationFile" : gen->Description())
-                << "\n"
-                << "  Run: " << g->GetRun() << "\n"
-                << "  URL: " << g->GetURL() << "\n"
-                << "  context: " << g->GetContext()
-                << LOG_END;
-        } else {
-            JLogMessage m(m_logger, JLogger::Level::ERROR);
-            m << "Unable to create JCalibration object!\n"
-              << "  Run: " << run_number << "\n"
-              << "  URL: " << m_url << "\n"
-              << "  context: " << m_context << "\n";
-
-            if (gen) {
-                m << "  Attempted to use generator: " << gen->Description();
-            } else {
-                m << "  No appropriate generators found. Attempted JCalibrationFile";
-            }
-            std::move(m) << LOG_END;
+        else if (!snapshot) {
+            snapshot = CreateSnapshot(run_number, true);
         }
-
-        // Unlock calibration mutex
-        pthread_mutex_unlock(&m_calibration_mutex);
-        return g;
+        return snapshot ? snapshot->GetJCalibration() : nullptr;
     }
 
     template<class T>
@@ -153,12 +145,12 @@ public:
         // it easier for the user to understand how to call us.
 
         vals.clear();
-        JCalibration *calib = GetJCalibration(run_number);
-        if (!calib) {
+        auto snapshot = GetSnapshot(run_number);
+        if (!snapshot) {
             LOG_ERROR(m_logger) << "Unable to get JCalibration object for run " << run_number << LOG_END;
             return true;
         }
-        return calib->Get(namepath, vals, event_number);
+        return snapshot->Get(namepath, vals, event_number);
     }
 
     template<class T>
@@ -167,12 +159,12 @@ public:
         /// the current event and call its Get() method to get the constants.
 
         vals.clear();
-        JCalibration *calib = GetJCalibration(run_number);
-        if (!calib) {
+        auto snapshot = GetSnapshot(run_number);
+        if (!snapshot) {
             LOG_ERROR(m_logger) << "Unable to get JCalibration object for run " << run_number << LOG_END;
             return true;
         }
-        return calib->Get(namepath, vals, event_number);
+        return snapshot->Get(namepath, vals, event_number);
     }
 
 
@@ -219,6 +211,121 @@ public:
         return resource_manager;
 
     }
+
+private:
+    std::shared_ptr<JCalibrationSnapshot> FindSnapshot(const SnapshotTable& table, unsigned int run_number) {
+        for (auto& snapshot : table.snapshots) {
+            if (snapshot->Matches(run_number, m_url, m_context)) return snapshot;
+        }
+        return nullptr;
+    }
+
+    void Pin(const std::shared_ptr<JCalibrationSnapshot>& snapshot) {
+        // Call with m_snapshot_mutex held
+        if (snapshot->m_pinned) return;
+        m_pinned_snapshots.push_back(snapshot);
+        snapshot->m_pinned = true;
+        m_calibrations.push_back(snapshot->GetJCalibration());
+    }
+
+    std::shared_ptr<JCalibrationSnapshot> CreateSnapshot(unsigned int run_number, bool pin) {
+
+        std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+
+        // Somebody may have beaten us to it, or the run may have dropped out of the table while still in use
+        auto snapshot = FindSnapshot(*m_snapshot_table.load(), run_number);
+        if (!snapshot) {
+            for (auto& weak : m_live_snapshots) {
+                auto candidate = weak.lock();
+                if (candidate && candidate->Matches(run_number, m_url, m_context)) {
+                    snapshot = candidate;
+                    break;
+                }
+            }
+            if (!snapshot) {
+                JCalibration *calib = MakeJCalibration(run_number);
+                if (!calib) return nullptr;
+                snapshot = std::make_shared<JCalibrationSnapshot>(run_number, m_url, m_context, std::shared_ptr<JCalibration>(calib));
+                m_live_snapshots.erase(std::remove_if(m_live_snapshots.begin(), m_live_snapshots.end(),
+                                                      [](const std::weak_ptr<JCalibrationSnapshot>& w){ return w.expired(); }),
+                                       m_live_snapshots.end());
+                m_live_snapshots.push_back(snapshot);
+            }
+            Publish(snapshot);
+        }
+        if (pin) Pin(snapshot);
+        return snapshot;
+    }
+
+    void Publish(const std::shared_ptr<JCalibrationSnapshot>& snapshot) {
+        // Call with m_snapshot_mutex held. Copies the table, dropping the oldest runs, and swaps it in.
+        SnapshotTable* old_table = m_snapshot_table.load();
+        auto new_table = new SnapshotTable;
+        size_t keep = std::min(old_table->snapshots.size(), m_snapshot_runs - 1);
+        new_table->snapshots.assign(old_table->snapshots.end() - keep, old_table->snapshots.end());
+        new_table->snapshots.push_back(snapshot);
+        m_snapshot_table.store(new_table);
+        m_retired_tables.push_back(old_table);
+
+        // Readers who arrive from now on only see the new table, so the old ones can go as soon as nobody is reading.
+        // If somebody is, they get another chance the next time a run is published, or when we are destroyed.
+        if (m_snapshot_readers.load() == 0) {
+            for (auto table : m_retired_tables) delete table;
+            m_retired_tables.clear();
+        }
+    }
+
+    JCalibration *MakeJCalibration(unsigned int run_number) {
+        // Create a new JCalibration object of the appropriate subclass of JCalibration. This determined by looking
+        // through the existing JCalibrationGenerator objects and finding the which claims the highest probability of
+        // being able to open it based on the URL. If there are no generators claiming a non-zero probability and the
+        // URL starts with "file://", then a JCalibrationFile object is created (i.e. we don't bother making a
+        // JCalibrationGeneratorFile class and instead, handle it here.)
+
+        JCalibrationGenerator *gen = nullptr;
+        double liklihood = 0.0;
+        for (unsigned int i = 0; i < m_calibration_generators.size(); i++) {
+            double my_liklihood = m_calibration_generators[i]->CheckOpenable(m_url, run_number, m_context);
+            if (my_liklihood > liklihood) {
+                liklihood = my_liklihood;
+                gen = m_calibration_generators[i];
+            }
+        }
+
+        // Make the JCalibration object
+        JCalibration *g = nullptr;
+        if (gen) {
+            g = gen->MakeJCalibration(m_url, run_number, m_context);
+        }
+        if (gen == nullptr && (m_url.find("file://") == 0)) {
+            g = new JCalibrationFile(m_url, run_number, m_context);
+        }
+        if (g) {
+            LOG_INFO(m_logger)
+                << "Created JCalibration object of type: " << g->className() << "\n"
+                << "  Generated via: "
+                << (gen == nullptr ? "fallback creation of JCalibrationFile" : gen->Description())
+                << "\n"
+                << "  Run: " << g->GetRun() << "\n"
+                << "  URL: " << g->GetURL() << "\n"
+                << "  context: " << g->GetContext()
+                << LOG_END;
+        } else {
+            JLogMessage m(m_logger, JLogger::Level::ERROR);
+            m << "Unable to create JCalibration object!\n"
+              << "  Run: " << run_number << "\n"
+              << "  URL: " << m_url << "\n"
+              << "  context: " << m_context << "\n";
+
+            if (gen) {
+                m << "  Attempted to use generator: " << gen->Description();
+            } else {
+                m << "  No appropriate generators found. Attempted JCalibrationFile";
+            }
+            std::move(m) << LOG_END;
+        }
+        return g;
+    }
 };
 
 #endif //JANA2_JCALIBRATIONMANAGER_H
@@ -0,0 +1,50 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JCALIBRATIONSNAPSHOT_H
+#define JANA2_JCALIBRATIONSNAPSHOT_H
+
+#include <JANA/Calibrations/JCalibration.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+/// JCalibrationSnapshot is the calibration of one run: the JCalibration for that run, together with the URL and
+/// context it was opened with. It never changes after JCalibrationManager builds it, so any number of threads may
+/// share it. Factories should grab one in ChangeRun() and hold on to it until the run changes again. The snapshot,
+/// and the JCalibration inside it, are freed once the manager no longer publishes it and nobody holds it anymore.
+class JCalibrationSnapshot {
+
+    int32_t m_run;
+    std::string m_url;
+    std::string m_context;
+    std::shared_ptr<JCalibration> m_calibration;
+
+    friend class JCalibrationManager;
+    mutable std::atomic_bool m_pinned {false};  // Whether the manager has handed out the JCalibration as a raw pointer
+
+public:
+    JCalibrationSnapshot(int32_t run, std::string url, std::string context, std::shared_ptr<JCalibration> calibration)
+        : m_run(run)
+        , m_url(std::move(url))
+        , m_context(std::move(context))
+        , m_calibration(std::move(calibration)) {}
+
+    int32_t GetRun() const { return m_run; }
+    const std::string& GetURL() const { return m_url; }
+    const std::string& GetContext() const { return m_context; }
+    JCalibration* GetJCalibration() const { return m_calibration.get(); }
+
+    bool Matches(int32_t run, const std::string& url, const std::string& context) const {
+        return m_run == run && m_url == url && m_context == context;
+    }
+
+    /// Returns false on success and true on error, like JCalibration::Get()
+    template<class T>
+    bool Get(const std::string& namepath, T& vals, uint64_t event_number=0) const {
+        return m_calibration->Get(namepath, vals, event_number);
+    }
+};
+
+#endif //JANA2_JCALIBRATIONSNAPSHOT_H
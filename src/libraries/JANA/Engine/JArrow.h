@@ -12,13 +12,14 @@
 
 #include "JArrowMetrics.h"
 #include <JANA/JLogger.h>
+#include <JANA/Utils/JWaitSignal.h>
 
 class JArrow {
 
 public:
     enum class Status { Unopened, Running, Paused, Finished };
     enum class NodeType {Source, Sink, Stage, Group};
-    enum class BackoffStrategy { Constant, Linear, Exponential };
+    enum class BackoffStrategy { Constant, Linear, Exponential, Adaptive };
     using duration_t = std::chrono::steady_clock::duration;
 
 private:
@@ -126,6 +127,16 @@ public:
         return m_thread_count;
     }
 
+    /// Adds one thread to a running arrow, unless the arrow is sequential and already has a thread.
+    /// This lets a scheduler claim an arrow without holding a topology-wide lock.
+    bool try_claim() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_status != Status::Running) return false;
+        if (!m_is_parallel && m_thread_count > 0) return false;
+        m_thread_count += 1;
+        return true;
+    }
+
     // TODO: Metrics should be encapsulated so that only actions are to update, clear, or summarize
     JArrowMetrics& get_metrics() {
         return m_metrics;
@@ -155,6 +166,13 @@ public:
 
     virtual void set_threshold(size_t /* threshold */) {}
 
+    /// Whether the arrow's output currently has no room, in which case executing it can't make progress
+    virtual bool is_backpressured() { return false; }
+
+    /// Signal which fires when new input arrives, for BackoffStrategy::Adaptive to park on. Arrows without
+    /// an input queue return nullptr, in which case parking degrades to sleeping.
+    virtual JWaitSignal* get_input_signal() { return nullptr; }
+
 
 
 
@@ -27,6 +27,9 @@ private:
     duration_t m_last_latency;
     duration_t m_total_queue_latency;
     duration_t m_last_queue_latency;
+    size_t m_total_steal_count;    // Items this arrow took from another location's queue
+    size_t m_total_recycle_count;  // Events this arrow took from the event pool
+    duration_t m_total_recycle_latency;
 
 
     // TODO: We might want to add a timestamp, so that
@@ -46,6 +49,9 @@ public:
         m_last_latency = duration_t::zero();
         m_total_queue_latency = duration_t::zero();
         m_last_queue_latency = duration_t::zero();
+        m_total_steal_count = 0;
+        m_total_recycle_count = 0;
+        m_total_recycle_latency = duration_t::zero();
         m_mutex.unlock();
     }
 
@@ -66,6 +72,9 @@ public:
         m_total_latency += other.m_total_latency;
         m_total_queue_latency += other.m_total_queue_latency;
         m_last_queue_latency = other.m_last_queue_latency;
+        m_total_steal_count += other.m_total_steal_count;
+        m_total_recycle_count += other.m_total_recycle_count;
+        m_total_recycle_latency += other.m_total_recycle_latency;
 
         other.m_last_status = Status::NotRunYet;
         other.m_total_message_count = 0;
@@ -76,6 +85,9 @@ public:
         other.m_last_latency = duration_t::zero();
         other.m_total_queue_latency = duration_t::zero();
         other.m_last_queue_latency = duration_t::zero();
+        other.m_total_steal_count = 0;
+        other.m_total_recycle_count = 0;
+        other.m_total_recycle_latency = duration_t::zero();
         other.m_mutex.unlock();
         m_mutex.unlock();
     };
@@ -96,6 +108,9 @@ public:
         m_last_queue_visits = other.m_last_queue_visits;
         m_total_queue_latency += other.m_total_queue_latency;
         m_last_queue_latency = other.m_last_queue_latency;
+        m_total_steal_count += other.m_total_steal_count;
+        m_total_recycle_count += other.m_total_recycle_count;
+        m_total_recycle_latency += other.m_total_recycle_latency;
         other.m_mutex.unlock();
         m_mutex.unlock();
     };
@@ -110,7 +125,10 @@ public:
                 const size_t& message_count_delta,
                 const size_t& queue_visit_delta,
                 const duration_t& latency_delta,
-                const duration_t& queue_latency_delta) {
+                const duration_t& queue_latency_delta,
+                const size_t& steal_count_delta = 0,
+                const size_t& recycle_count_delta = 0,
+                const duration_t& recycle_latency_delta = duration_t::zero()) {
 
         m_mutex.lock();
         m_last_status = last_status;
@@ -128,6 +146,9 @@ public:
         m_total_latency += latency_delta;
         m_total_queue_latency += queue_latency_delta;
         m_last_queue_latency = queue_latency_delta;
+        m_total_steal_count += steal_count_delta;
+        m_total_recycle_count += recycle_count_delta;
+        m_total_recycle_latency += recycle_latency_delta;
         m_mutex.unlock();
 
     };
@@ -160,6 +181,18 @@ public:
         return m_total_message_count;
     }
 
+    size_t get_total_steal_count() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_total_steal_count;
+    }
+
+    /// Time spent recycling pooled events (JFactorySet::Release() and friends), and how many events that covers
+    void get_recycle_metrics(size_t& total_recycle_count, duration_t& total_recycle_latency) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        total_recycle_count = m_total_recycle_count;
+        total_recycle_latency = m_total_recycle_latency;
+    }
+
     Status get_last_status() {
         std::lock_guard<std::mutex> lock(m_mutex);
         return m_last_status;
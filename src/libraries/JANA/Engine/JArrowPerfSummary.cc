@@ -50,10 +50,10 @@ std::ostream& operator<<(std::ostream& os, const JArrowPerfSummary& s) {
     os << "  +--------------------------+------------+--------+-----+---------+-------+--------+---------+-------------+" << std::endl;
 
 
-    os << "  +--------------------------+-------------+--------------+----------------+--------------+----------------+" << std::endl;
-    os << "  |           Name           | Avg latency | Inst latency | Queue latency  | Queue visits | Queue overhead | " << std::endl;
-    os << "  |                          | [ms/event]  |  [ms/event]  |   [ms/visit]   |    [count]   |     [0..1]     | " << std::endl;
-    os << "  +--------------------------+-------------+--------------+----------------+--------------+----------------+" << std::endl;
+    os << "  +--------------------------+-------------+--------------+----------------+--------------+----------------+--------------+--------------+" << std::endl;
+    os << "  |           Name           | Avg latency | Inst latency | Queue latency  | Queue visits | Queue overhead | Stolen items | Recycle time |" << std::endl;
+    os << "  |                          | [ms/event]  |  [ms/event]  |   [ms/visit]   |    [count]   |     [0..1]     |    [count]   |  [us/event]  |" << std::endl;
+    os << "  +--------------------------+-------------+--------------+----------------+--------------+----------------+--------------+--------------+" << std::endl;
 
     for (auto as : s.arrows) {
         os << "  | " << std::setprecision(3)
@@ -63,15 +63,22 @@ std::ostream& operator<<(std::ostream& os, const JArrowPerfSummary& s) {
            << std::setw(15) << as.avg_queue_latency_ms << " |"
            << std::setw(13) << as.queue_visit_count << " |"
            << std::setw(15) << as.avg_queue_overhead_frac << " |"
-           << std::endl;
+           << std::setw(13) << as.total_steal_count << " |";
+        if (as.avg_recycle_latency_us >= 0) {
+            os << std::setw(13) << as.avg_recycle_latency_us << " |";
+        }
+        else {
+            os << "            - |";
+        }
+        os << std::endl;
     }
-    os << "  +--------------------------+-------------+--------------+----------------+--------------+----------------+" << std::endl;
+    os << "  +--------------------------+-------------+--------------+----------------+--------------+----------------+--------------+--------------+" << std::endl;
 
 
-    os << "  +----+----------------------+-------------+------------+-----------+----------------+------------------+" << std::endl;
-    os << "  | ID | Last arrow name      | Useful time | Retry time | Idle time | Scheduler time | Scheduler visits |" << std::endl;
-    os << "  |    |                      |     [ms]    |    [ms]    |    [ms]   |      [ms]      |     [count]      |" << std::endl;
-    os << "  +----+----------------------+-------------+------------+-----------+----------------+------------------+" << std::endl;
+    os << "  +----+----------------------+-------------+------------+-----------+-----------+-----------+----------------+------------------+" << std::endl;
+    os << "  | ID | Last arrow name      | Useful time | Retry time | Spin time | Park time | Idle time | Scheduler time | Scheduler visits |" << std::endl;
+    os << "  |    |                      |     [ms]    |    [ms]    |    [ms]   |    [ms]   |    [ms]   |      [ms]      |     [count]      |" << std::endl;
+    os << "  +----+----------------------+-------------+------------+-----------+-----------+-----------+----------------+------------------+" << std::endl;
 
     for (auto ws : s.workers) {
         os << "  |"
@@ -79,12 +86,14 @@ std::ostream& operator<<(std::ostream& os, const JArrowPerfSummary& s) {
            << std::setw(20) << std::left << ws.last_arrow_name << " |"
            << std::setw(12) << std::right << ws.last_useful_time_ms << " |"
            << std::setw(11) << ws.last_retry_time_ms << " |"
+           << std::setw(10) << ws.last_spin_time_ms << " |"
+           << std::setw(10) << ws.last_park_time_ms << " |"
            << std::setw(10) << ws.last_idle_time_ms << " |"
            << std::setw(15) << ws.last_scheduler_time_ms << " |"
            << std::setw(17) << ws.scheduler_visit_count << " |"
            << std::endl;
     }
-    os << "  +----+----------------------+-------------+------------+-----------+----------------+------------------+" << std::endl;
+    os << "  +----+----------------------+-------------+------------+-----------+-----------+-----------+----------------+------------------+" << std::endl;
     return os;
 }
 
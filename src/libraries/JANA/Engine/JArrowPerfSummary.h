@@ -33,6 +33,8 @@ struct ArrowSummary {
     double last_queue_latency_ms;
     double avg_queue_overhead_frac;
     size_t queue_visit_count;
+    size_t total_steal_count;
+    double avg_recycle_latency_us;
 };
 
 struct WorkerSummary {
@@ -48,6 +50,10 @@ struct WorkerSummary {
     double last_retry_time_ms;
     double last_idle_time_ms;
     double last_scheduler_time_ms;
+    double total_spin_time_ms;
+    double total_park_time_ms;
+    double last_spin_time_ms;
+    double last_park_time_ms;
     long scheduler_visit_count;
     std::string last_arrow_name;
     double last_arrow_avg_latency_ms;
@@ -62,6 +68,8 @@ struct JArrowPerfSummary : public JPerfSummary {
     double avg_seq_bottleneck_hz;
     double avg_par_bottleneck_hz;
     double avg_efficiency_frac;
+    size_t event_queue_pending = 0;   // Events waiting in the queues which jana:event_queue_threshold applies to
+    size_t event_queue_capacity = 0;  // Sum of those queues' thresholds. Subevent queues aren't included
 
     std::vector<WorkerSummary> workers;
     std::vector<ArrowSummary> arrows;
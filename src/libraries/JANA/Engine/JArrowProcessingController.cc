@@ -4,6 +4,7 @@
 
 #include <JANA/Engine/JArrowProcessingController.h>
 #include <JANA/Engine/JArrowPerfSummary.h>
+#include <JANA/Engine/JEventDrivenScheduler.h>
 #include <JANA/Utils/JCpuInfo.h>
 #include <JANA/JLogger.h>
 
@@ -23,11 +24,20 @@ void JArrowProcessingController::acquire_services(JServiceLocator * sl) {
     params->SetDefaultParameter("jana:timeout", m_timeout_s, "Max. time (in seconds) system will wait for a thread to update its heartbeat before killing it and launching a new one. 0 to disable timeout completely.");
     params->SetDefaultParameter("jana:warmup_timeout", m_warmup_timeout_s, "Max. time (in seconds) system will wait for the initial events to complete before killing program.");
     // Originally "THREAD_TIMEOUT" and "THREAD_TIMEOUT_FIRST_EVENT"
+    params->SetDefaultParameter("jana:scheduler", m_scheduler_type, "Scheduler: 'roundrobin' (workers backoff on their assignment) or 'eventdriven' (idle workers park until woken)");
 }
 
 void JArrowProcessingController::initialize() {
 
-    m_scheduler = new JScheduler(m_topology);
+    if (m_scheduler_type == "roundrobin") {
+        m_scheduler = new JScheduler(m_topology);
+    }
+    else if (m_scheduler_type == "eventdriven") {
+        m_scheduler = new JEventDrivenScheduler(m_topology);
+    }
+    else {
+        throw JException("Invalid value for jana:scheduler: '%s'", m_scheduler_type.c_str());
+    }
     m_scheduler->logger = m_scheduler_logger;
     LOG_INFO(m_logger) << m_topology->mapping << LOG_END;
 }
@@ -38,10 +48,80 @@ void JArrowProcessingController::run(size_t nthreads) {
 
 void JArrowProcessingController::scale(size_t nthreads) {
 
+    // m_workers_mutex is only held while m_workers and m_active_worker_count are updated, never while waiting for
+    // a worker to stop, so that measuring performance doesn't block behind a worker finishing its assignment.
+    // Only scale() modifies m_workers, so scale() may read it without m_workers_mutex. Everybody else reads a
+    // snapshot taken under m_workers_mutex, see get_workers().
+    std::lock_guard<std::mutex> scale_lock(m_scale_mutex);
+
+    if (m_topology->m_current_status == JArrowTopology::Status::Running) {
+        // Add or retire workers without disturbing the ones that keep running, so the pipeline never drains
+        scale_live(nthreads);
+        return;
+    }
+
     LOG_INFO(m_logger) << "scale(): Stopping all running workers" << LOG_END;
     request_pause();
     wait_until_paused();
     LOG_INFO(m_logger) << "scale(): All workers are stopped" << LOG_END;
+    {
+        std::lock_guard<std::mutex> lock(m_workers_mutex);
+        create_workers(nthreads);
+    }
+
+    LOG_INFO(m_logger) << "scale(): Restarting " << nthreads << " workers" << LOG_END;
+    // topology->run needs to happen _before_ threads are started so that threads don't quit due to lack of assignments
+    m_topology->run(nthreads);
+
+    for (size_t i=0; i<nthreads; ++i) {
+        m_workers.at(i)->start();
+    };
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
+    m_active_worker_count = nthreads;
+}
+
+void JArrowProcessingController::scale_live(size_t nthreads) {
+
+    size_t old_nthreads = m_active_worker_count;
+    if (nthreads > old_nthreads) {
+        LOG_INFO(m_logger) << "scale(): Adding " << nthreads - old_nthreads << " workers to the running topology" << LOG_END;
+        {
+            std::lock_guard<std::mutex> lock(m_workers_mutex);
+            create_workers(nthreads);
+        }
+        for (size_t i=old_nthreads; i<nthreads; ++i) {
+            m_workers[i]->wait_for_stop(); // Reap the thread of a previously retired worker, if there is one
+            m_workers[i]->start();
+        }
+        std::lock_guard<std::mutex> lock(m_workers_mutex);
+        m_active_worker_count = nthreads;
+    }
+    else if (nthreads < old_nthreads) {
+        LOG_INFO(m_logger) << "scale(): Retiring " << old_nthreads - nthreads << " workers from the running topology" << LOG_END;
+        {
+            // Stop reporting on the retiring workers first, since their heartbeats are about to stop on purpose
+            std::lock_guard<std::mutex> lock(m_workers_mutex);
+            m_active_worker_count = nthreads;
+        }
+        // Retiring workers finish their current assignment and hand it back to the scheduler before exiting
+        for (size_t i=nthreads; i<old_nthreads; ++i) {
+            m_workers[i]->request_stop();
+        }
+        m_scheduler->wake_all_workers();  // Parked workers notice the stop request and exit
+        for (size_t i=nthreads; i<old_nthreads; ++i) {
+            m_workers[i]->wait_for_stop();
+        }
+    }
+
+    // Throughput measurements from before and after the change aren't comparable, so restart the stopwatch
+    auto& metrics = m_topology->metrics;
+    metrics.stop(get_monotonic_event_count());
+    metrics.reset();
+    metrics.start(nthreads);
+}
+
+void JArrowProcessingController::create_workers(size_t nthreads) {
+
     bool pin_to_cpu = (m_topology->mapping.get_affinity() != JProcessorMapping::AffinityStrategy::None);
     size_t next_worker_id = m_workers.size();
 
@@ -51,22 +131,53 @@ void JArrowProcessingController::scale(size_t nthreads) {
         size_t next_loc_id = m_topology->mapping.get_loc_id(next_worker_id);
 
         auto worker = new JWorker(m_scheduler, next_worker_id, next_cpu_id, next_loc_id, pin_to_cpu);
+        worker->set_task_pool(m_topology->task_pool.get());
         worker->logger = m_worker_logger;
         m_workers.push_back(worker);
         next_worker_id++;
     }
+}
 
-    LOG_INFO(m_logger) << "scale(): Restarting " << nthreads << " workers" << LOG_END;
-    // topology->run needs to happen _before_ threads are started so that threads don't quit due to lack of assignments
-    m_topology->run(nthreads);
+std::vector<JWorker*> JArrowProcessingController::get_workers() {
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
+    return m_workers;
+}
 
-    for (size_t i=0; i<nthreads; ++i) {
-        m_workers.at(i)->start();
-    };
+size_t JArrowProcessingController::get_monotonic_event_count() {
+    size_t monotonic_event_count = 0;
+    for (JArrow* arrow : m_topology->sinks) {
+        monotonic_event_count += arrow->get_metrics().get_total_message_count();
+    }
+    return monotonic_event_count;
+}
+
+size_t JArrowProcessingController::get_nthreads() {
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
+    return m_active_worker_count;
+}
+
+void JArrowProcessingController::set_event_source_chunksize(size_t chunksize) {
+    LOG_DEBUG(m_logger) << "Setting event source chunksize to " << chunksize << LOG_END;
+    m_topology->event_source_chunksize = chunksize;
+    for (JArrow* source : m_topology->sources) {
+        source->set_chunksize(chunksize);
+    }
+}
+
+void JArrowProcessingController::set_event_queue_threshold(size_t threshold) {
+    LOG_DEBUG(m_logger) << "Setting event queue threshold to " << threshold << LOG_END;
+    m_topology->event_queue_threshold = threshold;
+    // m_topology->queues only holds the event queues. The subevent queues keep jana:subevent_queue_threshold
+    for (JArrowTopology::EventQueue* queue : m_topology->queues) {
+        queue->set_threshold(threshold);
+    }
 }
 
 void JArrowProcessingController::request_pause() {
     m_topology->request_pause();
+    if (m_scheduler != nullptr) {
+        m_scheduler->wake_all_workers();  // Parked workers notice the pause and exit
+    }
     // Or:
     // for (JWorker* worker : m_workers) {
     //     worker->request_stop();
@@ -74,7 +185,8 @@ void JArrowProcessingController::request_pause() {
 }
 
 void JArrowProcessingController::wait_until_paused() {
-    for (JWorker* worker : m_workers) {
+    // scale() calls this while holding m_scale_mutex, so we mustn't take that here
+    for (JWorker* worker : get_workers()) {
         worker->wait_for_stop();
     }
     // Join all the worker threads.
@@ -97,7 +209,7 @@ void JArrowProcessingController::request_stop() {
 
 void JArrowProcessingController::wait_until_stopped() {
     // Join all workers
-    for (JWorker* worker : m_workers) {
+    for (JWorker* worker : get_workers()) {
         worker->wait_for_stop();
     }
     // finish out the topology
@@ -138,6 +250,7 @@ bool JArrowProcessingController::is_timed_out() {
 
     // Find all workers whose last heartbeat exceeds timeout
     bool found_timeout = false;
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
     for (size_t i=0; i<metrics->workers.size(); ++i) {
         if (metrics->workers[i].last_heartbeat_ms > (timeout_s * 1000)) {
             found_timeout = true;
@@ -151,13 +264,19 @@ bool JArrowProcessingController::is_timed_out() {
 
 JArrowProcessingController::~JArrowProcessingController() {
 
-    for (JWorker* worker : m_workers) {
+    // Wait for any scale() in progress, so that nobody adds workers behind our back
+    std::lock_guard<std::mutex> scale_lock(m_scale_mutex);
+    auto workers = get_workers();
+    for (JWorker* worker : workers) {
         worker->request_stop();
     }
-    for (JWorker* worker : m_workers) {
+    if (m_scheduler != nullptr) {
+        m_scheduler->wake_all_workers();
+    }
+    for (JWorker* worker : workers) {
         worker->wait_for_stop();
     }
-    for (JWorker* worker : m_workers) {
+    for (JWorker* worker : workers) {
         delete worker;
     }
     delete m_topology;
@@ -178,17 +297,18 @@ std::unique_ptr<const JArrowPerfSummary> JArrowProcessingController::measure_int
 
     // Measure perf on all Workers first, as this will prompt them to publish
     // any ArrowMetrics they have collected
+    // Retired workers are left out, since their heartbeats have stopped on purpose
     m_perf_summary.workers.clear();
-    for (JWorker* worker : m_workers) {
-        WorkerSummary summary;
-        worker->measure_perf(summary);
-        m_perf_summary.workers.push_back(summary);
+    {
+        std::lock_guard<std::mutex> lock(m_workers_mutex);
+        for (size_t i=0; i<m_active_worker_count; ++i) {
+            WorkerSummary summary;
+            m_workers[i]->measure_perf(summary);
+            m_perf_summary.workers.push_back(summary);
+        }
     }
 
-    size_t monotonic_event_count = 0;
-    for (JArrow* arrow : m_topology->sinks) {
-        monotonic_event_count += arrow->get_metrics().get_total_message_count();
-    }
+    size_t monotonic_event_count = get_monotonic_event_count();
 
     // Uptime
     m_topology->metrics.split(monotonic_event_count);
@@ -197,6 +317,13 @@ std::unique_ptr<const JArrowPerfSummary> JArrowProcessingController::measure_int
     double worst_seq_latency = 0;
     double worst_par_latency = 0;
 
+    m_perf_summary.event_queue_pending = 0;
+    m_perf_summary.event_queue_capacity = 0;
+    for (JArrowTopology::EventQueue* queue : m_topology->queues) {
+        m_perf_summary.event_queue_pending += queue->size();
+        m_perf_summary.event_queue_capacity += queue->get_threshold();
+    }
+
     m_perf_summary.arrows.clear();
     for (JArrow* arrow : m_topology->arrows) {
         JArrowMetrics::Status last_status;
@@ -229,6 +356,14 @@ std::unique_ptr<const JArrowPerfSummary> JArrowProcessingController::measure_int
         summary.total_messages_completed = total_message_count;
         summary.last_messages_completed = last_message_count;
         summary.queue_visit_count = total_queue_visits;
+        summary.total_steal_count = arrow->get_metrics().get_total_steal_count();
+
+        size_t total_recycle_count;
+        JArrowMetrics::duration_t total_recycle_latency;
+        arrow->get_metrics().get_recycle_metrics(total_recycle_count, total_recycle_latency);
+        summary.avg_recycle_latency_us = (total_recycle_count == 0)
+                                       ? -1  // Only arrows which take events from the pool recycle them
+                                       : std::chrono::duration<double, std::micro>(total_recycle_latency).count() / total_recycle_count;
 
         summary.avg_queue_latency_ms = (total_queue_visits == 0)
                                        ? std::numeric_limits<double>::infinity()
@@ -13,6 +13,7 @@
 #include <JANA/Engine/JArrowPerfSummary.h>
 
 #include <vector>
+#include <mutex>
 
 class JArrowProcessingController : public JProcessingController {
 public:
@@ -23,6 +24,9 @@ public:
 
     void initialize() override;
     void run(size_t nthreads) override;
+
+    /// While the topology is running, workers are added or retired live: new workers join the scheduler immediately,
+    /// and retiring workers finish their current assignment and exit. Otherwise, all workers restart.
     void scale(size_t nthreads) override;
     void request_pause();
     void wait_until_paused();
@@ -36,21 +40,37 @@ public:
     std::unique_ptr<const JPerfSummary> measure_performance() override;
     std::unique_ptr<const JArrowPerfSummary> measure_internal_performance();
 
+    /// Knobs which may be turned while the topology is running, e.g. by JAutotuner.
+    /// The event source chunksize should be kept at or below the event queue threshold, or the sources will stall.
+    /// The event queue threshold applies to the event queues only. Subevent queues keep jana:subevent_queue_threshold.
+    size_t get_nthreads();
+    void set_event_source_chunksize(size_t chunksize);
+    void set_event_queue_threshold(size_t threshold);
+
     void print_report() override;
     void print_final_report() override;
 
 
 private:
 
+    void scale_live(size_t nthreads);
+    void create_workers(size_t nthreads);
+    std::vector<JWorker*> get_workers();  // Snapshot of m_workers. Workers are only deleted by the destructor
+    size_t get_monotonic_event_count();
+
     using jclock_t = std::chrono::steady_clock;
     int m_timeout_s = 8;
     int m_warmup_timeout_s = 30;
+    std::string m_scheduler_type = "roundrobin";
 
     JArrowPerfSummary m_perf_summary;
     JArrowTopology* m_topology;       // Owned by JArrowProcessingController
     JScheduler* m_scheduler = nullptr;
 
-    std::vector<JWorker*> m_workers;
+    std::vector<JWorker*> m_workers;  // Workers beyond m_active_worker_count are retired, but kept around for reuse
+    size_t m_active_worker_count = 0;
+    std::mutex m_workers_mutex;       // Lets scale() be called while somebody else is measuring performance
+    std::mutex m_scale_mutex;         // Serializes scale(). Unlike m_workers_mutex, this is held while workers stop
     JLogger m_logger;
     JLogger m_worker_logger;
     JLogger m_scheduler_logger;
@@ -8,6 +8,7 @@
 
 
 #include <JANA/Services/JComponentManager.h>
+#include <JANA/Services/JTaskPool.h>
 #include <JANA/Status/JPerfMetrics.h>
 #include <JANA/Utils/JEventPool.h>
 #include <JANA/Utils/JProcessorMapping.h>
@@ -30,6 +31,7 @@ struct JArrowTopology {
     // Otherwise there is a potential use-after-free when JArrowTopology or JArrowProcessingController access components
 
     std::shared_ptr<JEventPool> event_pool; // TODO: Belongs somewhere else
+    std::shared_ptr<JTaskPool> task_pool;   // Intra-event parallelism, shared by the workers and the processor arrow
     JPerfMetrics metrics;
 
     std::vector<JArrow*> arrows;
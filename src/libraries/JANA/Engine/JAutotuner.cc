@@ -0,0 +1,232 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <JANA/Engine/JAutotuner.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+
+std::string to_string(JAutotuner::Knob knob) {
+    switch (knob) {
+        case JAutotuner::Knob::NThreads: return "nthreads";
+        case JAutotuner::Knob::EventSourceChunksize: return "event_source_chunksize";
+        case JAutotuner::Knob::EventQueueThreshold: return "event_queue_threshold";
+    }
+    return "unknown";
+}
+
+
+JAutotuner::JAutotuner(Settings initial, Limits limits)
+    : m_settings(initial)
+    , m_baseline_settings(initial)
+    , m_limits(limits) {
+}
+
+
+JAutotuner::Settings JAutotuner::update(double time_s, double throughput_hz, const JArrowPerfSummary& perf) {
+
+    switch (m_phase) {
+        case Phase::Trial:
+            decide(time_s, throughput_hz);
+            if (m_rejections_this_round >= 3) {
+                // Every knob has had its chance, and none of them helped
+                m_phase = Phase::Hold;
+                m_hold_remaining = m_limits.hold_intervals;
+                m_rejections_this_round = 0;
+            }
+            else if (!m_decisions.back().accepted) {
+                m_phase = Phase::Baseline;  // We went back to the old settings, whose throughput has to be measured again
+            }
+            else if (!propose_trial(perf)) {
+                m_phase = Phase::Hold;
+                m_hold_remaining = m_limits.hold_intervals;
+            }
+            break;
+
+        case Phase::Hold:
+            if (m_hold_remaining > 1) {
+                m_hold_remaining -= 1;
+                break;
+            }
+            measure_baseline(throughput_hz, perf);  // The last interval we held still for serves as the baseline
+            break;
+
+        case Phase::Baseline:
+            measure_baseline(throughput_hz, perf);
+            break;
+    }
+    return m_settings;
+}
+
+
+void JAutotuner::measure_baseline(double throughput_hz, const JArrowPerfSummary& perf) {
+    m_baseline_hz = throughput_hz;
+    m_baseline_settings = m_settings;
+    if (throughput_hz <= 0) {
+        m_phase = Phase::Baseline;  // Nothing to compare against yet, e.g. still warming up
+    }
+    else if (!propose_trial(perf)) {
+        m_phase = Phase::Hold;
+        m_hold_remaining = m_limits.hold_intervals;
+    }
+}
+
+
+bool JAutotuner::propose_trial(const JArrowPerfSummary& perf) {
+
+    for (size_t i=0; i<3; ++i) {
+        auto knob = static_cast<Knob>((m_next_knob + i) % 3);
+        std::string reason;
+        int direction = suggest_direction(knob, perf, reason) * m_flip[static_cast<int>(knob)];
+        if (m_flip[static_cast<int>(knob)] < 0) {
+            reason += ", but that was rejected last time";
+        }
+
+        size_t old_value = value_of(m_settings, knob);
+        size_t new_value = old_value;
+        switch (knob) {
+            case Knob::NThreads: {
+                size_t step = std::max<size_t>(1, old_value / 8);
+                new_value = (direction > 0) ? old_value + step : ((old_value > step) ? old_value - step : 0);
+                new_value = std::max(m_limits.min_threads, std::min(m_limits.max_threads, new_value));
+                break;
+            }
+            case Knob::EventSourceChunksize: {
+                // Chunks larger than the queue threshold would never fit, so the sources would stall
+                size_t max_value = std::min(m_limits.max_event_source_chunksize, m_settings.event_queue_threshold);
+                new_value = (direction > 0) ? old_value * 2 : old_value / 2;
+                new_value = std::max(m_limits.min_event_source_chunksize, std::min(max_value, new_value));
+                break;
+            }
+            case Knob::EventQueueThreshold: {
+                size_t min_value = std::max(m_limits.min_event_queue_threshold, m_settings.event_source_chunksize);
+                new_value = (direction > 0) ? old_value * 2 : old_value / 2;
+                new_value = std::max(min_value, std::min(m_limits.max_event_queue_threshold, new_value));
+                break;
+            }
+        }
+        if (new_value == old_value) {
+            continue;  // Already at the limit in this direction
+        }
+        value_of(m_settings, knob) = new_value;
+        m_trial_knob = knob;
+        m_trial_reason = reason;
+        m_next_knob = (static_cast<size_t>(knob) + 1) % 3;
+        m_phase = Phase::Trial;
+        return true;
+    }
+    return false;
+}
+
+
+int JAutotuner::suggest_direction(Knob knob, const JArrowPerfSummary& perf, std::string& reason) {
+
+    std::ostringstream ss;
+    ss << std::setprecision(3);
+    int direction = 1;
+
+    switch (knob) {
+        case Knob::NThreads:
+            if (perf.avg_seq_bottleneck_hz < perf.avg_par_bottleneck_hz) {
+                ss << "a sequential arrow is the bottleneck (" << perf.avg_seq_bottleneck_hz << " Hz)";
+                direction = -1;
+            }
+            else {
+                ss << "the parallel arrows are the bottleneck (" << perf.avg_par_bottleneck_hz << " Hz)";
+            }
+            break;
+
+        case Knob::EventSourceChunksize: {
+            double overhead_frac = 0;
+            size_t source_count = 0;
+            for (auto& arrow : perf.arrows) {
+                if (arrow.arrow_type == JArrow::NodeType::Source && !std::isnan(arrow.avg_queue_overhead_frac)) {
+                    overhead_frac += arrow.avg_queue_overhead_frac;
+                    source_count += 1;
+                }
+            }
+            if (source_count != 0) overhead_frac /= source_count;
+            ss << "sources spend " << 100 * overhead_frac << "% of their time on queue overhead";
+            direction = (overhead_frac > 0.25) ? 1 : -1;
+            break;
+        }
+
+        case Knob::EventQueueThreshold: {
+            // Only the event queues count, since they are the only ones the threshold knob changes
+            double occupancy = (perf.event_queue_capacity == 0) ? 0 : double(perf.event_queue_pending) / perf.event_queue_capacity;
+            ss << "queue occupancy is " << 100 * occupancy << "%";
+            direction = (occupancy < 0.25) ? 1 : -1;
+            break;
+        }
+    }
+    reason = ss.str();
+    return direction;
+}
+
+
+size_t& JAutotuner::value_of(Settings& settings, Knob knob) {
+    switch (knob) {
+        case Knob::NThreads: return settings.nthreads;
+        case Knob::EventSourceChunksize: return settings.event_source_chunksize;
+        case Knob::EventQueueThreshold: break;
+    }
+    return settings.event_queue_threshold;
+}
+
+
+void JAutotuner::decide(double time_s, double trial_hz) {
+
+    size_t old_value = value_of(m_baseline_settings, m_trial_knob);
+    size_t new_value = value_of(m_settings, m_trial_knob);
+    bool adds_resources = new_value > old_value;
+    bool accepted;
+
+    if (m_trial_knob == Knob::NThreads) {
+        // Compare what the threads we added (or removed) contribute against what an average thread contributes
+        double threshold_hz = m_limits.min_marginal_efficiency * m_baseline_hz / old_value;
+        if (adds_resources) {
+            accepted = (trial_hz - m_baseline_hz) / (new_value - old_value) >= threshold_hz;
+        }
+        else {
+            accepted = (m_baseline_hz - trial_hz) / (old_value - new_value) < threshold_hz;
+        }
+    }
+    else if (adds_resources) {
+        accepted = trial_hz >= m_baseline_hz * (1 + m_limits.min_improvement);
+    }
+    else {
+        accepted = trial_hz >= m_baseline_hz * (1 - m_limits.min_improvement);
+    }
+
+    m_decisions.push_back({time_s, m_trial_knob, old_value, new_value, m_baseline_hz, trial_hz, accepted, m_trial_reason});
+
+    if (accepted) {
+        m_baseline_hz = trial_hz;
+        m_baseline_settings = m_settings;
+        m_rejections_this_round = 0;
+    }
+    else {
+        m_settings = m_baseline_settings;
+        m_flip[static_cast<int>(m_trial_knob)] *= -1;
+        m_rejections_this_round += 1;
+    }
+}
+
+
+void JAutotuner::write_decisions(std::ostream& os) const {
+    os << "#   time_s                    knob      old      new  baseline_hz     trial_hz  accepted  reason" << std::endl;
+    for (auto& d : m_decisions) {
+        os << std::setw(10) << std::setprecision(1) << std::fixed << d.time_s << " "
+           << std::setw(23) << to_string(d.knob) << " "
+           << std::setw(8) << d.old_value << " "
+           << std::setw(8) << d.new_value << " "
+           << std::setw(12) << std::setprecision(1) << d.baseline_hz << " "
+           << std::setw(12) << std::setprecision(1) << d.trial_hz << " "
+           << std::setw(9) << (d.accepted ? "yes" : "no") << "  "
+           << d.reason << std::endl;
+    }
+}
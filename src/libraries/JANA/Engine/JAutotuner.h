@@ -0,0 +1,106 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JAUTOTUNER_H
+#define JANA2_JAUTOTUNER_H
+
+#include <JANA/Engine/JArrowPerfSummary.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// JAutotuner adjusts the thread count, the event source chunksize, and the event queue threshold of a running
+/// topology, in order to get the most events/sec out of each core. It is a hill climber: every measurement interval,
+/// it either measures a baseline, or tries moving one knob and compares the throughput against that baseline.
+///
+/// The direction of each move comes from the arrow metrics:
+///   - nthreads goes down if a sequential arrow is the bottleneck, otherwise up
+///   - the source chunksize goes up if the sources spend much of their time on queue overhead, otherwise down
+///   - the queue threshold goes up if the queues are running dry, otherwise down
+/// A move towards more resources (threads, chunk size, queue space) is only kept if it pays for itself:
+/// each added thread has to contribute at least min_marginal_efficiency of the average thread's throughput, and
+/// larger chunks or queues have to improve throughput by min_improvement. A move towards fewer resources is kept
+/// unless it costs as much. Once a full round of moves has been rejected, the tuner holds still for a while
+/// before probing again, so that it can follow changing conditions without constantly perturbing the run.
+///
+/// JAutotuner only makes decisions; somebody else (JBenchmarker) measures throughput and applies the settings.
+/// This keeps it deterministic and easy to test.
+class JAutotuner {
+
+public:
+    enum class Knob { NThreads, EventSourceChunksize, EventQueueThreshold };
+
+    struct Settings {
+        size_t nthreads;
+        size_t event_source_chunksize;
+        size_t event_queue_threshold;
+    };
+
+    struct Limits {
+        size_t min_threads = 1;
+        size_t max_threads = 1;
+        size_t min_event_source_chunksize = 1;
+        size_t max_event_source_chunksize = 1024;
+        size_t min_event_queue_threshold = 1;
+        size_t max_event_queue_threshold = 1024;
+        double min_marginal_efficiency = 0.5;  // Fraction of an average thread's throughput a new thread must add
+        double min_improvement = 0.05;         // Fractional change in throughput that counts as a real difference
+        size_t hold_intervals = 5;             // Intervals to wait after a fruitless round before probing again
+    };
+
+    struct Decision {
+        double time_s;
+        Knob knob;
+        size_t old_value;
+        size_t new_value;
+        double baseline_hz;
+        double trial_hz;
+        bool accepted;
+        std::string reason;
+    };
+
+private:
+    enum class Phase { Baseline, Trial, Hold };
+
+    Settings m_settings;
+    Settings m_baseline_settings;
+    Limits m_limits;
+    Phase m_phase = Phase::Baseline;
+    Knob m_trial_knob = Knob::NThreads;
+    size_t m_next_knob = 0;
+    size_t m_rejections_this_round = 0;
+    size_t m_hold_remaining = 0;
+    double m_baseline_hz = 0;
+    std::string m_trial_reason;
+    int m_flip[3] = {1, 1, 1};   // Becomes -1 once a move in the suggested direction was rejected
+    std::vector<Decision> m_decisions;
+
+public:
+    JAutotuner(Settings initial, Limits limits);
+
+    /// update() takes the throughput measured over the last interval, which was run with get_settings(), plus a
+    /// performance summary taken at the end of it. It returns the settings to run the next interval with.
+    Settings update(double time_s, double throughput_hz, const JArrowPerfSummary& perf);
+
+    const Settings& get_settings() const { return m_settings; }
+
+    /// The best settings found so far. These differ from get_settings() while a trial is running.
+    const Settings& get_best_settings() const { return m_baseline_settings; }
+    const std::vector<Decision>& get_decisions() const { return m_decisions; }
+
+    /// Writes every decision as a whitespace-separated table, in the style of JBenchmarker's rates.dat
+    void write_decisions(std::ostream& os) const;
+
+private:
+    void measure_baseline(double throughput_hz, const JArrowPerfSummary& perf);
+    bool propose_trial(const JArrowPerfSummary& perf);
+    int suggest_direction(Knob knob, const JArrowPerfSummary& perf, std::string& reason);
+    size_t& value_of(Settings& settings, Knob knob);
+    void decide(double time_s, double trial_hz);
+};
+
+std::string to_string(JAutotuner::Knob knob);
+
+#endif //JANA2_JAUTOTUNER_H
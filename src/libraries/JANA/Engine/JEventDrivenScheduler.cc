@@ -0,0 +1,172 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <JANA/Engine/JEventDrivenScheduler.h>
+#include <JANA/Engine/JArrowTopology.h>
+
+
+JEventDrivenScheduler::JEventDrivenScheduler(JArrowTopology* topology, std::chrono::milliseconds park_timeout)
+    : JScheduler(topology)
+    , m_park_timeout(park_timeout)
+{
+    // Workers return to us as soon as they encounter ComeBackLater, instead of sleeping on the arrow
+    for (JArrow* arrow : m_topology->arrows) {
+        arrow->set_backoff_tries(0);
+    }
+}
+
+
+JArrow* JEventDrivenScheduler::find_runnable(uint32_t worker_id, JArrow* excluded) {
+
+    auto& arrows = m_topology->arrows;
+    size_t arrow_count = arrows.size();
+    if (arrow_count == 0) return nullptr;
+
+    JArrow* best = nullptr;
+    size_t best_pending = 0;
+
+    // Each worker starts scanning at a different offset, so that ties don't all go to the same arrow
+    for (size_t i=0; i<arrow_count; ++i) {
+        JArrow* candidate = arrows[(worker_id + i) % arrow_count];
+
+        if (candidate == excluded) continue;
+        if (candidate->get_status() != JArrow::Status::Running) continue;
+        if (!candidate->is_parallel() && candidate->get_thread_count() != 0) continue;
+
+        size_t pending = candidate->get_pending();
+        if (candidate->get_type() != JArrow::NodeType::Source && pending == 0) {
+            if (candidate->get_running_upstreams() == 0) {
+                // No more work is ever coming
+                deactivate_if_drained(candidate);
+            }
+            continue;
+        }
+        if (candidate->is_backpressured()) continue;
+
+        if (best == nullptr || pending > best_pending) {
+            best = candidate;
+            best_pending = pending;
+        }
+    }
+    return best;
+}
+
+
+void JEventDrivenScheduler::deactivate_if_drained(JArrow* arrow) {
+
+    {
+        std::lock_guard<std::mutex> lock(m_state_mutex);
+        if (arrow->get_type() == JArrow::NodeType::Source ||
+            arrow->get_status() != JArrow::Status::Running ||
+            arrow->get_running_upstreams() != 0 ||
+            arrow->get_pending() != 0 ||
+            arrow->get_thread_count() != 0) {
+            return;
+        }
+        LOG_DEBUG(logger) << "Deactivating arrow '" << arrow->get_name() << "' (" << m_topology->running_arrow_count - 1 << " remaining)" << LOG_END;
+        arrow->pause();
+        assert(m_topology->running_arrow_count >= 0);
+        if (m_topology->running_arrow_count == 0) {
+            LOG_DEBUG(logger) << "All arrows deactivated. Deactivating topology." << LOG_END;
+            m_topology->achieve_pause();
+        }
+    }
+    // Downstream arrows may now be drained as well, and if the topology paused, parked workers need to leave
+    notify(true);
+}
+
+
+void JEventDrivenScheduler::notify(bool all) {
+    if (m_parked_count == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(m_park_mutex);
+        m_generation += 1;
+    }
+    if (all) {
+        m_park_cv.notify_all();
+    }
+    else {
+        m_park_cv.notify_one();
+    }
+}
+
+
+JArrow* JEventDrivenScheduler::next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status last_result) {
+
+    if (assignment != nullptr) {
+        assignment->update_thread_count(-1);
+        deactivate_if_drained(assignment);
+    }
+
+    // Don't hand the worker straight back the arrow which just told it to come back later
+    JArrow* excluded = (last_result == JArrowMetrics::Status::ComeBackLater) ? assignment : nullptr;
+
+    while (true) {
+        JArrow* candidate = find_runnable(worker_id, excluded);
+        if (candidate == nullptr) {
+            LOG_TRACE(logger) << "Worker " << worker_id << ", "
+                              << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                              << ", " << to_string(last_result) << " => nothing runnable" << LOG_END;
+            return nullptr;
+        }
+        if (candidate->try_claim()) {
+            LOG_DEBUG(logger) << "Worker " << worker_id << ", "
+                              << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                              << ", " << to_string(last_result) << " => "
+                              << candidate->get_name() << "  [" << candidate->get_thread_count() << " threads]" << LOG_END;
+            return candidate;
+        }
+        // Somebody else claimed this sequential arrow in the meantime. The next scan will skip it.
+    }
+}
+
+
+void JEventDrivenScheduler::last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) {
+
+    LOG_DEBUG(logger) << "Worker " << worker_id << ", "
+                      << ((assignment == nullptr) ? "idle" : assignment->get_name())
+                      << ", " << to_string(result) << ") => Shutting down!" << LOG_END;
+    if (assignment != nullptr) {
+        assignment->update_thread_count(-1);
+    }
+}
+
+
+bool JEventDrivenScheduler::wait_for_work(uint32_t worker_id) {
+
+    if (m_topology->running_arrow_count == 0) {
+        return false;
+    }
+
+    // We register as parked _before_ rescanning. Anyone who makes progress after our rescan is then
+    // guaranteed to see us and bump the generation, so the notification can't get lost.
+    m_parked_count += 1;
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_park_mutex);
+        generation = m_generation;
+    }
+    if (m_topology->running_arrow_count == 0 || find_runnable(worker_id, nullptr) != nullptr) {
+        m_parked_count -= 1;
+        return true;
+    }
+
+    LOG_TRACE(logger) << "Worker " << worker_id << " parking" << LOG_END;
+    {
+        std::unique_lock<std::mutex> lock(m_park_mutex);
+        m_park_cv.wait_for(lock, m_park_timeout, [&](){ return m_generation != generation; });
+    }
+    m_parked_count -= 1;
+    return true;
+}
+
+
+void JEventDrivenScheduler::report_progress(JArrow*) {
+    notify(false);
+}
+
+
+void JEventDrivenScheduler::wake_all_workers() {
+    notify(true);
+}
@@ -0,0 +1,63 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JEVENTDRIVENSCHEDULER_H
+#define JANA2_JEVENTDRIVENSCHEDULER_H
+
+#include <JANA/Engine/JScheduler.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+
+/// JEventDrivenScheduler is an alternative to the round-robin JScheduler. It differs in three ways:
+///
+/// 1. There is no global lock on the assignment path. Each worker scans the arrows starting from its own
+///    offset, and claims an arrow via JArrow::try_claim(), which only locks that arrow. A mutex is taken only
+///    when an arrow is being deactivated, which happens a handful of times per run.
+///
+/// 2. Arrows are only considered runnable if they have input waiting (sources excepted) and their output
+///    isn't backpressured. Among runnable arrows, the one with the most pending input wins, so that queues
+///    drain before the sources pull in more events.
+///
+/// 3. Workers never sleep-backoff inside an assignment. Arrows are set to zero backoff tries, so a worker
+///    who encounters ComeBackLater immediately returns to the scheduler. If nothing is runnable, the worker
+///    parks on a condition variable until some other worker reports progress.
+///
+/// Parking is guarded by a timeout, so that a missed notification can only ever cost latency, not liveness.
+class JEventDrivenScheduler : public JScheduler {
+
+private:
+    std::mutex m_state_mutex;                    // Protects arrow deactivation and topology pause
+    std::mutex m_park_mutex;
+    std::condition_variable m_park_cv;
+    std::atomic<size_t> m_parked_count {0};
+    uint64_t m_generation = 0;                   // Protected by m_park_mutex. Bumped on every notification.
+    std::chrono::milliseconds m_park_timeout;
+
+    JArrow* find_runnable(uint32_t worker_id, JArrow* excluded);
+    void deactivate_if_drained(JArrow* arrow);
+    void notify(bool all);
+
+public:
+
+    explicit JEventDrivenScheduler(JArrowTopology* topology,
+                                   std::chrono::milliseconds park_timeout = std::chrono::milliseconds(10));
+
+    JArrow* next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) override;
+
+    void last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result) override;
+
+    bool wait_for_work(uint32_t worker_id) override;
+
+    void report_progress(JArrow* assignment) override;
+
+    void wake_all_workers() override;
+
+    size_t get_parked_count() const { return m_parked_count; }
+};
+
+
+#endif //JANA2_JEVENTDRIVENSCHEDULER_H
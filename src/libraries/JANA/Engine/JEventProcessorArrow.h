@@ -9,6 +9,7 @@
 #include <JANA/JEventProcessor.h>
 #include <JANA/Engine/JArrow.h>
 #include <JANA/Engine/JMailbox.h>
+#include <JANA/Services/JTaskPool.h>
 
 class JEventPool;
 
@@ -23,16 +24,21 @@ private:
     EventQueue* m_input_queue;
     EventQueue* m_output_queue;
     std::shared_ptr<JEventPool> m_pool;
+    JTaskPool* m_task_pool = nullptr;
 
 public:
 
     JEventProcessorArrow(std::string name,
                          EventQueue *input_queue,
                          EventQueue *output_queue,
-                         std::shared_ptr<JEventPool> pool);
+                         std::shared_ptr<JEventPool> pool,
+                         bool is_parallel = true);
 
     void add_processor(JEventProcessor* processor);
 
+    /// When the pool has intra-event parallelism enabled, the processors run concurrently on each batch
+    void set_task_pool(JTaskPool* task_pool) { m_task_pool = task_pool; }
+
     void initialize() final;
     void finalize() final;
     void execute(JArrowMetrics& result, size_t location_id) final;
@@ -40,6 +46,8 @@ public:
     size_t get_pending() final;
     size_t get_threshold() final;
     void set_threshold(size_t) final;
+    bool is_backpressured() final;
+    JWaitSignal* get_input_signal() final;
 
 };
 
@@ -0,0 +1,119 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#include <JANA/Engine/JEventReorderArrow.h>
+#include <JANA/Utils/JEventPool.h>
+#include <JANA/JEventProcessor.h>
+#include <JANA/JEventSource.h>
+
+
+JEventReorderArrow::JEventReorderArrow(std::string name,
+                                       EventQueue *input_queue,
+                                       std::shared_ptr<JEventPool> pool)
+        : JArrow(std::move(name), false, NodeType::Sink)
+        , m_input_queue(input_queue)
+        , m_pool(std::move(pool)) {
+}
+
+void JEventReorderArrow::add_processor(JEventProcessor* processor) {
+    m_processors.push_back(processor);
+}
+
+void JEventReorderArrow::execute(JArrowMetrics& result, size_t location_id) {
+
+    auto start_total_time = std::chrono::steady_clock::now();
+
+    std::vector<Event> events;
+    size_t stolen_count;
+    auto in_status = m_input_queue->pop(events, get_chunksize(), location_id, stolen_count);
+
+    // Release every event which is next in line for its source, plus whatever it unblocks
+    std::vector<Event> ready;
+    for (auto& event : events) {
+        auto& source = m_sources[event->GetJEventSource()];
+        if (event->GetSequenceNumber() != source.next_sequence_number) {
+            source.waiting.emplace(event->GetSequenceNumber(), std::move(event));
+            m_waiting_count += 1;
+            continue;
+        }
+        ready.push_back(std::move(event));
+        source.next_sequence_number += 1;
+        auto it = source.waiting.begin();
+        while (it != source.waiting.end() && it->first == source.next_sequence_number) {
+            ready.push_back(std::move(it->second));
+            it = source.waiting.erase(it);
+            m_waiting_count -= 1;
+            source.next_sequence_number += 1;
+        }
+    }
+    m_max_waiting_count = std::max(m_max_waiting_count, m_waiting_count);
+
+    LOG_TRACE(m_logger) << "JEventReorderArrow '" << get_name() << "' [" << location_id << "]: "
+                        << "popped " << events.size() << " events, releasing " << ready.size()
+                        << ", holding back " << m_waiting_count << LOG_END;
+
+    auto start_latency_time = std::chrono::steady_clock::now();
+    if (!ready.empty()) {
+        std::vector<std::shared_ptr<const JEvent>> batch(ready.begin(), ready.end());
+        for (JEventProcessor* processor : m_processors) {
+            processor->DoMapBatch(batch);
+        }
+    }
+    auto end_latency_time = std::chrono::steady_clock::now();
+
+    for (auto& x : ready) {
+        x->GetJEventSource()->DoFinish(*x);
+        m_pool->put(x, location_id);
+    }
+    auto end_queue_time = std::chrono::steady_clock::now();
+
+    JArrowMetrics::Status status;
+    if (in_status == EventQueue::Status::Ready) {
+        status = JArrowMetrics::Status::KeepGoing;
+    }
+    else {
+        status = JArrowMetrics::Status::ComeBackLater;
+    }
+    auto latency = (end_latency_time - start_latency_time);
+    auto overhead = (end_queue_time - start_total_time) - latency;
+    result.update(status, ready.size(), 1, latency, overhead, stolen_count);
+}
+
+void JEventReorderArrow::initialize() {
+
+    LOG_DEBUG(m_logger) << "JEventReorderArrow: Initializing arrow '" << get_name() << "'" << LOG_END;
+    for (auto processor : m_processors) {
+        LOG_INFO(m_logger) << "Initializing JEventProcessor '" << processor->GetType() << "' (ordered)" << LOG_END;
+        processor->DoInitialize();
+    }
+}
+
+void JEventReorderArrow::finalize() {
+    LOG_DEBUG(m_logger) << "JEventReorderArrow: Finalizing arrow '" << get_name() << "'" << LOG_END;
+    if (m_waiting_count != 0) {
+        LOG_WARN(m_logger) << "JEventReorderArrow '" << get_name() << "': " << m_waiting_count
+                           << " events never became next in line and were not processed" << LOG_END;
+    }
+    for (auto processor : m_processors) {
+        LOG_INFO(m_logger) << "Finalizing JEventProcessor '" << processor->GetType() << "'" << LOG_END;
+        processor->DoFinalize();
+    }
+}
+
+size_t JEventReorderArrow::get_pending() {
+    return m_input_queue->size();
+}
+
+size_t JEventReorderArrow::get_threshold() {
+    return m_input_queue->get_threshold();
+}
+
+void JEventReorderArrow::set_threshold(size_t threshold) {
+    m_input_queue->set_threshold(threshold);
+}
+
+JWaitSignal* JEventReorderArrow::get_input_signal() {
+    return &m_input_queue->get_push_signal();
+}
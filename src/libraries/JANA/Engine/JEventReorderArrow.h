@@ -0,0 +1,71 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JEVENTREORDERARROW_H
+#define JANA2_JEVENTREORDERARROW_H
+
+
+#include <JANA/JEventProcessor.h>
+#include <JANA/Engine/JArrow.h>
+#include <JANA/Engine/JMailbox.h>
+
+#include <map>
+#include <unordered_map>
+
+class JEventPool;
+
+/// JEventReorderArrow runs the JEventProcessors which asked for SetEventsOrdered(true). Events arrive in whatever
+/// order the upstream workers finished them. Each one is held in a reorder buffer until every event its JEventSource
+/// emitted before it (according to JEvent::GetSequenceNumber) has been processed, and then handed to the processors.
+///
+/// This arrow is sequential, since the processors must see one event after another. Its input mailbox must allow work
+/// stealing, so that whichever worker runs it can drain every location.
+///
+/// The reorder buffer can only ever hold events which are in flight, so its memory is bounded by jana:event_pool_size.
+/// Once it is waiting on a slow event, the event pool runs dry and the sources stop emitting until it catches up.
+class JEventReorderArrow : public JArrow {
+
+public:
+    using Event = std::shared_ptr<JEvent>;
+    using EventQueue = JMailbox<Event>;
+
+private:
+    struct SourceState {
+        uint64_t next_sequence_number = 0;
+        std::map<uint64_t, Event> waiting;   // Keyed by sequence number
+    };
+
+    std::vector<JEventProcessor*> m_processors;
+    EventQueue* m_input_queue;
+    std::shared_ptr<JEventPool> m_pool;
+    std::unordered_map<JEventSource*, SourceState> m_sources;
+    size_t m_waiting_count = 0;
+    size_t m_max_waiting_count = 0;
+
+public:
+
+    JEventReorderArrow(std::string name,
+                       EventQueue *input_queue,
+                       std::shared_ptr<JEventPool> pool);
+
+    void add_processor(JEventProcessor* processor);
+
+    void initialize() final;
+    void finalize() final;
+    void execute(JArrowMetrics& result, size_t location_id) final;
+
+    size_t get_pending() final;
+    size_t get_threshold() final;
+    void set_threshold(size_t) final;
+    JWaitSignal* get_input_signal() final;
+
+    /// Number of events currently held back, waiting for an earlier event
+    size_t get_waiting_count() const { return m_waiting_count; }
+
+    /// Largest number of events held back at any one time, for tuning jana:event_pool_size
+    size_t get_max_waiting_count() const { return m_max_waiting_count; }
+};
+
+
+#endif //JANA2_JEVENTREORDERARROW_H
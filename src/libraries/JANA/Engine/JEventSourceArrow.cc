@@ -16,22 +16,100 @@ JEventSourceArrow::JEventSourceArrow(std::string name,
                                      EventQueue* output_queue,
                                      std::shared_ptr<JEventPool> pool
                                      )
-    : JArrow(name, false, NodeType::Source)
+    : JArrow(name, source->IsParallelGetEventEnabled(), NodeType::Source)
     , m_source(source)
     , m_output_queue(output_queue)
     , m_pool(pool) {
+    set_barrier_group(std::make_shared<BarrierGroup>());
 }
 
 
+void JEventSourceArrow::set_barrier_group(std::shared_ptr<BarrierGroup> group) {
+    m_barrier_group = std::move(group);
+    std::lock_guard<std::mutex> lock(m_barrier_group->mutex);
+    m_barrier_group->sources.push_back(m_source);
+}
+
+
+bool JEventSourceArrow::is_waiting_on_barrier() {
+    auto& group = *m_barrier_group;
+    size_t held_count = group.held_barrier_count;
+    if (held_count == 0 && !group.barrier_in_flight) return false;
+    if (group.active_emitters > 0) return true;
+    // Held barriers count as in flight, too
+    size_t in_flight_count = 0;
+    for (auto source : group.sources) {
+        in_flight_count += source->GetEventsInFlight();
+    }
+    return in_flight_count > held_count;
+}
+
 
 void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
+    m_active_executors += 1;
+    emit(result, location_id);
+    // Several workers may be in here at once, and only the last one out may finalize the source
+    if (m_active_executors.fetch_sub(1) == 1 && m_source_exhausted && !m_finish_claimed.exchange(true)) {
+        finish();
+    }
+}
+
+
+void JEventSourceArrow::emit(JArrowMetrics& result, size_t location_id) {
 
     JEventSource::ReturnStatus in_status = JEventSource::ReturnStatus::Success;
     auto start_time = std::chrono::steady_clock::now();
 
+    auto& group = *m_barrier_group;
+    if (group.held_barrier_count != 0 || group.barrier_in_flight) {
+        std::unique_lock<std::mutex> lock(group.mutex);
+        if (is_waiting_on_barrier()) {
+            result.update(JArrowMetrics::Status::ComeBackLater, 0, 1, std::chrono::milliseconds(0), std::chrono::steady_clock::now() - start_time);
+            return;
+        }
+        if (!m_held_barriers.empty()) {
+            // Everything before the barrier has finished, so it gets the pipeline to itself
+            auto reserved_count = m_output_queue->reserve(1, location_id);
+            if (reserved_count == 0) {
+                result.update(JArrowMetrics::Status::ComeBackLater, 0, 1, std::chrono::milliseconds(0), std::chrono::steady_clock::now() - start_time);
+                return;
+            }
+            auto barrier = std::move(m_held_barriers.front());
+            m_held_barriers.pop_front();
+            group.barrier_in_flight = true;   // Before the held count drops, so that emitters never see neither
+            m_held_barrier_count -= 1;
+            group.held_barrier_count -= 1;
+            lock.unlock();
+            LOG_DEBUG(m_logger) << "JEventSourceArrow '" << get_name() << "': Emitting barrier event "
+                                << barrier->GetEventNumber() << LOG_END;
+            auto out_status = m_output_queue->push(barrier, reserved_count, location_id);
+            auto status = (out_status == EventQueue::Status::Ready) ? JArrowMetrics::Status::KeepGoing : JArrowMetrics::Status::ComeBackLater;
+            result.update(status, 1, 1, std::chrono::milliseconds(0), std::chrono::steady_clock::now() - start_time);
+            return;
+        }
+        if (group.held_barrier_count != 0) {
+            // Another source's barrier is next, and only that source's arrow may emit it
+            result.update(JArrowMetrics::Status::ComeBackLater, 0, 1, std::chrono::milliseconds(0), std::chrono::steady_clock::now() - start_time);
+            return;
+        }
+        group.barrier_in_flight = false;  // The barrier has finished, so resume as usual
+    }
+
+    // Announce ourselves before checking for barriers one more time. A barrier is only emitted once no emitters are
+    // left, so either it waits for us, or we see it and back off.
+    group.active_emitters += 1;
+    if (group.held_barrier_count != 0 || group.barrier_in_flight) {
+        group.active_emitters -= 1;
+        result.update(JArrowMetrics::Status::ComeBackLater, 0, 1, std::chrono::milliseconds(0), std::chrono::steady_clock::now() - start_time);
+        return;
+    }
+
     auto chunksize = get_chunksize();
     auto reserved_count = m_output_queue->reserve(chunksize, location_id);
     auto emit_count = reserved_count;
+    std::vector<Event> chunk_buffer;
+    size_t recycle_count = 0;
+    JArrowMetrics::duration_t recycle_latency = JArrowMetrics::duration_t::zero();
 
     if (reserved_count != chunksize) {
         // Ensures that the source _only_ emits in increments of
@@ -42,32 +120,34 @@ void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
         LOG_DEBUG(m_logger) << "JEventSourceArrow asked for " << chunksize << ", but only reserved " << reserved_count << LOG_END;
     }
     else {
+        chunk_buffer.reserve(emit_count);
         for (size_t i=0; i<emit_count && in_status==JEventSource::ReturnStatus::Success; ++i) {
-            auto event = m_pool->get(location_id);
+            if (group.held_barrier_count != 0) {
+                break;  // Another worker read a barrier, which should be kept waiting as briefly as possible
+            }
+            auto event = m_pool->get(location_id, &recycle_latency);
             if (event == nullptr) {
                 in_status = JEventSource::ReturnStatus::TryAgain;
                 break;
             }
-            if (event->GetJEventSource() != m_source) {
-                // If we have multiple event sources, we need to make sure we are using
-                // event-source-specific factories on top of the default ones.
-                // This is obviously not the best way to handle this but I'll need to
-                // rejigger the whole thing anyway when we re-add parallel event sources.
-                auto factory_set = new JFactorySet();
-                auto src_fac_gen = m_source->GetFactoryGenerator();
-                if (src_fac_gen != nullptr) {
-                    src_fac_gen->GenerateFactories(factory_set);
-                }
-                factory_set->Merge(*event->GetFactorySet());
-                event->SetFactorySet(factory_set);
-                event->SetJEventSource(m_source);
-            }
+            recycle_count += 1;
+            // If we have multiple event sources, we need to make sure we are using
+            // event-source-specific factories on top of the default ones.
+            m_pool->switch_source(*event, m_source);
             event->SetSequential(false);
             event->SetJApplication(m_source->GetApplication());
             event->GetJCallGraphRecorder()->Reset();
             in_status = m_source->DoNext(event);
             if (in_status == JEventSource::ReturnStatus::Success) {
-                m_chunk_buffer.push_back(std::move(event));
+                if (event->GetSequential()) {
+                    // Emit whatever came before the barrier now, and nothing after it until it has finished
+                    std::lock_guard<std::mutex> lock(group.mutex);
+                    m_held_barriers.push_back(std::move(event));
+                    m_held_barrier_count += 1;
+                    group.held_barrier_count += 1;
+                    break;
+                }
+                chunk_buffer.push_back(std::move(event));
             }
             else {
                 m_pool->put(event, location_id);
@@ -76,8 +156,9 @@ void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
     }
 
     auto latency_time = std::chrono::steady_clock::now();
-    auto message_count = m_chunk_buffer.size();
-    auto out_status = m_output_queue->push(m_chunk_buffer, reserved_count, location_id);
+    auto message_count = chunk_buffer.size();
+    auto out_status = m_output_queue->push(chunk_buffer, reserved_count, location_id);
+    group.active_emitters -= 1;
     auto finished_time = std::chrono::steady_clock::now();
 
     if (message_count != 0) {
@@ -95,7 +176,7 @@ void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
     JArrowMetrics::Status status;
 
     if (in_status == JEventSource::ReturnStatus::Finished) {
-        finish();
+        m_source_exhausted = true;  // execute() finishes the arrow once no other worker is still emitting
         status = JArrowMetrics::Status::Finished;
     }
     else if (in_status == JEventSource::ReturnStatus::Success && out_status == EventQueue::Status::Ready) {
@@ -104,7 +185,7 @@ void JEventSourceArrow::execute(JArrowMetrics& result, size_t location_id) {
     else {
         status = JArrowMetrics::Status::ComeBackLater;
     }
-    result.update(status, message_count, 1, latency, overhead);
+    result.update(status, message_count, 1, latency, overhead, 0, recycle_count, recycle_latency);
 }
 
 void JEventSourceArrow::initialize() {
@@ -116,3 +197,13 @@ void JEventSourceArrow::finalize() {
     LOG_INFO(m_logger) << "Finalizing JEventSource '" << m_source->GetResourceName() << "' (" << m_source->GetTypeName() << ")" << LOG_END;
     m_source->DoFinalize();
 }
+
+bool JEventSourceArrow::is_backpressured() {
+    // execute() only emits whole chunks, so anything less than a chunk's worth of room counts as full.
+    // Likewise, if every event is in flight, there is nothing to read into until one comes back to the pool.
+    // While another source's barrier is held, only that source's arrow has anything to do.
+    return m_output_queue->size() + get_chunksize() > m_output_queue->get_threshold() ||
+           !m_pool->has_available_events() ||
+           is_waiting_on_barrier() ||
+           (m_held_barrier_count == 0 && m_barrier_group->held_barrier_count != 0);
+}
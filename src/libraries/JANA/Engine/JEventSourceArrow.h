@@ -11,23 +11,54 @@
 #include <JANA/Engine/JArrow.h>
 #include <JANA/Engine/JMailbox.h>
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 using Event = std::shared_ptr<JEvent>;
 using EventQueue = JMailbox<Event>;
 
 class JEventPool;
 
+/// JEventSourceArrow emits events from one JEventSource. It is sequential, unless the source declared that its
+/// GetEvent() is reentrant via JEventSource::EnableParallelGetEvent(), in which case several workers may execute
+/// it at once. Everything below is therefore kept safe for concurrent execute() calls.
 class JEventSourceArrow : public JArrow {
+public:
+    /// Barrier events (JEvent::SetSequential(true)) are held back until every event emitted before them has
+    /// finished, and once emitted, nothing else is emitted until they have finished themselves. This holds for
+    /// every source in the group, so sources which share one (as JTopologyBuilder's do) never run alongside
+    /// each other's barriers. The sources are only registered while the topology is built.
+    struct BarrierGroup {
+        std::mutex mutex;
+        std::vector<JEventSource*> sources;             // Whose events in flight a barrier waits for
+        std::atomic<size_t> active_emitters {0};        // Workers currently pulling events out of any of the sources
+        std::atomic<size_t> held_barrier_count {0};
+        std::atomic<bool> barrier_in_flight {false};
+    };
+
 private:
     JEventSource* m_source;
     EventQueue* m_output_queue;
     std::shared_ptr<JEventPool> m_pool;
-    std::vector<Event> m_chunk_buffer;
+    std::atomic<size_t> m_active_executors {0};        // Workers currently inside execute()
+    std::atomic<bool> m_source_exhausted {false};
+    std::atomic<bool> m_finish_claimed {false};
+
+    std::shared_ptr<BarrierGroup> m_barrier_group;
+    std::deque<Event> m_held_barriers;                 // This source's, in the order they were read. Guarded by the group's mutex
+    std::atomic<size_t> m_held_barrier_count {0};
+
+    bool is_waiting_on_barrier();
+    void emit(JArrowMetrics& result, size_t location_id);
 
 public:
     JEventSourceArrow(std::string name, JEventSource* source, EventQueue* output_queue, std::shared_ptr<JEventPool> pool);
+    void set_barrier_group(std::shared_ptr<BarrierGroup> group);
     void initialize() final;
     void finalize() final;
     void execute(JArrowMetrics& result, size_t location_id) final;
+    bool is_backpressured() final;
 };
 
 #endif //JANA2_JEVENTSOURCEARROW_H
@@ -8,7 +8,12 @@
 
 #include <queue>
 #include <mutex>
+#include <atomic>
+#include <thread>
 #include <JANA/Services/JLoggingService.h>
+#include <JANA/JException.h>
+#include <JANA/Utils/JRingBuffer.h>
+#include <JANA/Utils/JWaitSignal.h>
 
 /// JMailbox is a threadsafe event queue designed for communication between Arrows.
 /// It is different from the standard data structure in the following ways:
@@ -24,12 +29,19 @@
 /// ints starting at 0. While JArrows are wired to one logical JMailbox, JWorkers interact with
 /// the physical DomainLocalMailbox corresponding to their very own memory domain.
 ///
+/// The physical storage comes in two flavors, chosen at construction time:
+///   - Backend::Locking:  a std::deque guarded by a std::mutex. pop() fails with Congested under contention.
+///   - Backend::LockFree: a bounded JRingBuffer. Nothing ever fails with Congested. The ring's capacity is
+///                        twice the threshold (rounded up to a power of two). Callers must reserve() before
+///                        they push(). A reserved push() always fits, because the reservation is only released
+///                        once its items are in the ring. An unreserved push() which would overflow the ring
+///                        throws instead of waiting.
+///
 /// \tparam T must be moveable. Usually this is unique_ptr<JEvent>.
 ///
 /// Improvements:
 ///   1. Pad DomainLocalMailbox
-///   2. Enable work stealing
-///   3. Triple mutex trick to give push() priority?
+///   2. Triple mutex trick to give push() priority?
 
 
 #ifndef CACHE_LINE_BYTES
@@ -40,25 +52,48 @@
 template <typename T>
 class JMailbox {
 
+public:
+
+    enum class Status {Ready, Congested, Empty, Full};
+    enum class Backend {Locking, LockFree};
+
 private:
 
     struct alignas(CACHE_LINE_BYTES) LocalMailbox {
         std::mutex mutex;
         std::deque<T> queue;
+        std::atomic<size_t> queue_size {0};             // Mirrors queue.size(), so that size(domain) needn't lock
         size_t reserved_count = 0;
+        std::unique_ptr<JRingBuffer<T>> ring;          // Only used by Backend::LockFree
+        std::atomic<size_t> atomic_reserved_count {0};  // Only used by Backend::LockFree
+
+        /// Before C++17, new[] ignores the cache line alignment, so the array gets aligned storage like JRingBuffer
+        static void* operator new[](size_t size) {
+            void* ptr = nullptr;
+            if (posix_memalign(&ptr, alignof(LocalMailbox), size) != 0) {
+                throw std::bad_alloc();
+            }
+            return ptr;
+        }
+
+        static void operator delete[](void* ptr) {
+            free(ptr);
+        }
     };
 
     // TODO: Copy these params into DLMB for better locality
-    size_t m_threshold;
+    std::atomic<size_t> m_threshold;   // May be changed while the topology is running, e.g. by JAutotuner
     size_t m_locations_count;
     bool m_enable_work_stealing = false;
+    Backend m_backend = Backend::Locking;
     std::unique_ptr<LocalMailbox[]> m_mailboxes;
+    std::vector<std::vector<std::vector<size_t>>> m_neighbors;  // location_id => tiers, nearest first => location_ids
+    JWaitSignal m_push_signal;
+    std::atomic<bool> m_push_signal_enabled {false};  // Until somebody waits on the signal, pushes skip notifying it
     JLogger m_logger;
 
 public:
 
-    enum class Status {Ready, Congested, Empty, Full};
-
     friend std::ostream& operator<<(std::ostream& os, const Status& s) {
         switch (s) {
             case Status::Ready:     os << "Ready"; break;
@@ -74,12 +109,27 @@ public:
     /// threshold: the (soft) maximum number of items in the queue at any time
     /// domain_count: the number of domains
     /// enable_work_stealing: allow domains to pop from other domains' queues when theirs is empty
-    JMailbox(size_t threshold=100, size_t locations_count=1, bool enable_work_stealing=false)
+    /// backend: whether each domain's queue is a mutex-guarded deque or a lock-free ring buffer
+    JMailbox(size_t threshold=100, size_t locations_count=1, bool enable_work_stealing=false, Backend backend=Backend::Locking)
         : m_threshold(threshold)
         , m_locations_count(locations_count)
-        , m_enable_work_stealing(enable_work_stealing) {
+        , m_enable_work_stealing(enable_work_stealing)
+        , m_backend(backend) {
 
         m_mailboxes = std::unique_ptr<LocalMailbox[]>(new LocalMailbox[locations_count]);
+        m_neighbors.resize(locations_count);
+        for (size_t i=0; i<locations_count; ++i) {
+            std::vector<size_t> others;
+            for (size_t j=0; j<locations_count; ++j) {
+                if (j != i) others.push_back(j);
+            }
+            m_neighbors[i].push_back(std::move(others));
+        }
+        if (m_backend == Backend::LockFree) {
+            for (size_t i=0; i<locations_count; ++i) {
+                m_mailboxes[i].ring = std::unique_ptr<JRingBuffer<T>>(new JRingBuffer<T>(2*threshold));
+            }
+        }
     }
 
     virtual ~JMailbox() {
@@ -92,6 +142,10 @@ public:
     size_t size() {
         size_t result = 0;
         for (size_t i = 0; i<m_locations_count; ++i) {
+            if (m_backend == Backend::LockFree) {
+                result += m_mailboxes[i].ring->size();
+                continue;
+            }
             std::lock_guard<std::mutex> lock(m_mailboxes[i].mutex);
             result += m_mailboxes[i].queue.size();
         }
@@ -99,9 +153,13 @@ public:
     };
 
     /// size(domain) counts the number of items in the queue for a particular domain
-    /// Meant to be used by Scheduler::next_assignment() and measure_perf(), eventually
+    /// Meant to be used by Scheduler::next_assignment() and measure_perf(), eventually.
+    /// This never takes the domain's lock, so it is only a snapshot, like size() on the ring buffer.
     size_t size(size_t domain) {
-        return m_mailboxes[domain].queue.size();
+        if (m_backend == Backend::LockFree) {
+            return m_mailboxes[domain].ring->size();
+        }
+        return m_mailboxes[domain].queue_size.load(std::memory_order_relaxed);
     }
 
     /// reserve(requested_count) keeps our queues bounded in size. The caller should
@@ -114,10 +172,21 @@ public:
     size_t reserve(size_t requested_count, size_t domain = 0) {
 
         LocalMailbox& mb = m_mailboxes[domain];
+        size_t threshold = m_threshold;
+        if (m_backend == Backend::LockFree) {
+            size_t reserved = mb.atomic_reserved_count.load();
+            size_t reservation;
+            do {
+                size_t occupied = mb.ring->size() + reserved;
+                if (occupied >= threshold) return 0;
+                reservation = std::min(threshold - occupied, requested_count);
+            } while (!mb.atomic_reserved_count.compare_exchange_weak(reserved, reserved + reservation));
+            return reservation;
+        }
         std::lock_guard<std::mutex> lock(mb.mutex);
-        size_t doable_count = m_threshold - mb.queue.size() - mb.reserved_count;
-        if (doable_count > 0) {
-            size_t reservation = std::min(doable_count, requested_count);
+        size_t occupied = mb.queue.size() + mb.reserved_count;
+        if (occupied < threshold) {  // The threshold may have been lowered below the current occupancy
+            size_t reservation = std::min(threshold - occupied, requested_count);
             mb.reserved_count += reservation;
             return reservation;
         }
@@ -128,16 +197,34 @@ public:
     /// succeed, although it may exceed the threshold if the caller didn't reserve
     /// space, and it may take a long time because it will wait on a mutex.
     /// Note that if the caller had called reserve(), they must pass in the reserved_count here.
+    /// On the LockFree backend, pushing more than was reserved may overflow the ring, in which case this throws.
     Status push(std::vector<T>& buffer, size_t reserved_count = 0, size_t domain = 0) {
 
         auto& mb = m_mailboxes[domain];
-        std::lock_guard<std::mutex> lock(mb.mutex);
-        mb.reserved_count -= reserved_count;
-        for (const T& t : buffer) {
-             mb.queue.push_back(std::move(t));
+        bool pushed_any = !buffer.empty();
+        size_t size;
+        if (m_backend == Backend::LockFree) {
+            for (T& t : buffer) {
+                push_ring(mb, t);
+            }
+            buffer.clear();
+            mb.atomic_reserved_count -= reserved_count;  // Only now, so that reserve() can't hand out the same slots twice
+            size = mb.ring->size();
+        }
+        else {
+            std::lock_guard<std::mutex> lock(mb.mutex);
+            mb.reserved_count -= reserved_count;
+            for (const T& t : buffer) {
+                 mb.queue.push_back(std::move(t));
+            }
+            buffer.clear();
+            size = mb.queue.size();
+            mb.queue_size.store(size, std::memory_order_relaxed);
+        }
+        if (pushed_any && m_push_signal_enabled.load(std::memory_order_relaxed)) {
+            m_push_signal.notify(true);
         }
-        buffer.clear();
-        if (mb.queue.size() > m_threshold) {
+        if (size > m_threshold) {
             return Status::Full;
         }
         return Status::Ready;
@@ -146,10 +233,22 @@ public:
     Status push(T& item, size_t reserved_count = 0, size_t domain = 0) {
 
         auto& mb = m_mailboxes[domain];
-        std::lock_guard<std::mutex> lock(mb.mutex);
-        mb.reserved_count -= reserved_count;
-        mb.queue.push_back(std::move(item));
-        size_t size = mb.queue.size();
+        size_t size;
+        if (m_backend == Backend::LockFree) {
+            push_ring(mb, item);
+            mb.atomic_reserved_count -= reserved_count;
+            size = mb.ring->size();
+        }
+        else {
+            std::lock_guard<std::mutex> lock(mb.mutex);
+            mb.reserved_count -= reserved_count;
+            mb.queue.push_back(std::move(item));
+            size = mb.queue.size();
+            mb.queue_size.store(size, std::memory_order_relaxed);
+        }
+        if (m_push_signal_enabled.load(std::memory_order_relaxed)) {
+            m_push_signal.notify(false);
+        }
         if (size > m_threshold) {
             return Status::Full;
         }
@@ -160,9 +259,108 @@ public:
     /// pop() will pop up to requested_count items for the desired domain.
     /// If many threads are contending for the queue, this will fail with Status::Contention,
     /// in which case the caller should probably consult the Scheduler.
+    /// If work stealing is enabled and the domain's own queue is empty, pop() will instead take
+    /// a batch from the fullest queue among the nearest non-empty neighbors (see set_neighbors()).
     Status pop(std::vector<T>& buffer, size_t requested_count, size_t location_id = 0) {
+        size_t stolen_count;
+        return pop(buffer, requested_count, location_id, stolen_count);
+    }
+
+    /// This overload also reports how many of the popped items were stolen from a neighbor.
+    Status pop(std::vector<T>& buffer, size_t requested_count, size_t location_id, size_t& stolen_count) {
+
+        stolen_count = 0;
+        size_t initial_size = buffer.size();
+        auto status = pop_local(buffer, requested_count, location_id);
+        if (m_enable_work_stealing && status == Status::Empty && buffer.size() == initial_size) {
+            stolen_count = steal(buffer, requested_count, location_id);
+            if (stolen_count != 0) {
+                return Status::Ready;
+            }
+        }
+        return status;
+    }
+
+    Status pop(T& item, bool& success, size_t location_id = 0) {
+        size_t stolen_count;
+        return pop(item, success, location_id, stolen_count);
+    }
+
+    /// When popping a single item, we still steal a whole batch (half of the victim's queue), in order to
+    /// amortize the cost of stealing. The surplus goes into our own domain's queue, so we reserve room for it
+    /// there first and never steal more than that reservation plus the one item we return.
+    Status pop(T& item, bool& success, size_t location_id, size_t& stolen_count) {
+
+        stolen_count = 0;
+        auto status = pop_local(item, success, location_id);
+        if (m_enable_work_stealing && status == Status::Empty && !success) {
+            std::vector<T> batch;
+            size_t reserved_count = reserve(m_threshold, location_id);
+            stolen_count = steal(batch, reserved_count + 1, location_id);
+            if (stolen_count != 0) {
+                item = std::move(batch.front());
+                success = true;
+                batch.erase(batch.begin());
+                status = Status::Ready;
+            }
+            if (!batch.empty() || reserved_count != 0) {
+                push(batch, reserved_count, location_id);  // Also returns whatever part of the reservation went unused
+            }
+        }
+        return status;
+    }
+
+
+    size_t get_threshold() { return m_threshold; }
+
+    /// set_threshold() may be called while other threads are using the mailbox. Lowering the threshold never drops
+    /// items; it only turns away new reservations until the queue has drained below it. The LockFree backend
+    /// can't grow its rings, so the threshold is capped at half their capacity, which leaves headroom for
+    /// callers that push without reserving.
+    void set_threshold(size_t threshold) {
+        if (m_backend == Backend::LockFree) {
+            threshold = std::min(threshold, m_mailboxes[0].ring->capacity() / 2);
+        }
+        m_threshold = threshold;
+    }
+    Backend get_backend() { return m_backend; }
+    size_t get_locations_count() { return m_locations_count; }
+
+    /// The push signal is notified whenever items are pushed, so that consumers may park until then. Notifying
+    /// costs an atomic increment per push, so it only starts once somebody has asked for the signal. A push racing
+    /// with the first call may go unnoticed, which merely costs the caller one park timeout.
+    JWaitSignal& get_push_signal() {
+        m_push_signal_enabled.store(true, std::memory_order_relaxed);
+        return m_push_signal;
+    }
+
+    bool is_work_stealing_enabled() { return m_enable_work_stealing; }
+
+    /// set_neighbors() tells location_id where to steal from, as a list of tiers ordered nearest-first.
+    /// Within a tier, the fullest queue is chosen. By default, all other locations form a single tier.
+    void set_neighbors(size_t location_id, std::vector<std::vector<size_t>> tiers) {
+        m_neighbors[location_id] = std::move(tiers);
+    }
+
+private:
+
+    Status pop_local(std::vector<T>& buffer, size_t requested_count, size_t location_id) {
 
         auto& mb = m_mailboxes[location_id];
+        if (m_backend == Backend::LockFree) {
+            T item;
+            for (size_t i=0; i<requested_count && mb.ring->try_pop(item); ++i) {
+                buffer.push_back(std::move(item));
+            }
+            auto size = mb.ring->size();
+            if (size >= m_threshold) {
+                return Status::Full;
+            }
+            else if (size != 0) {
+                return Status::Ready;
+            }
+            return Status::Empty;
+        }
         if (!mb.mutex.try_lock()) {
             return Status::Congested;
         }
@@ -173,6 +371,7 @@ public:
             mb.queue.pop_front();
         }
         auto size = mb.queue.size();
+        mb.queue_size.store(size, std::memory_order_relaxed);
         mb.mutex.unlock();
         if (size >= m_threshold) {
             return Status::Full;
@@ -184,10 +383,14 @@ public:
     }
 
 
-    Status pop(T& item, bool& success, size_t location_id = 0) {
+    Status pop_local(T& item, bool& success, size_t location_id) {
 
         success = false;
         auto& mb = m_mailboxes[location_id];
+        if (m_backend == Backend::LockFree) {
+            success = mb.ring->try_pop(item);
+            return (mb.ring->size() != 0) ? Status::Ready : Status::Empty;
+        }
         if (!mb.mutex.try_lock()) {
             return Status::Congested;
         }
@@ -195,6 +398,7 @@ public:
         if (nitems > 1) {
             item = std::move(mb.queue.front());
             mb.queue.pop_front();
+            mb.queue_size.store(nitems - 1, std::memory_order_relaxed);
             success = true;
             mb.mutex.unlock();
             return Status::Ready;
@@ -202,6 +406,7 @@ public:
         else if (nitems == 1) {
             item = std::move(mb.queue.front());
             mb.queue.pop_front();
+            mb.queue_size.store(0, std::memory_order_relaxed);
             success = true;
             mb.mutex.unlock();
             return Status::Empty;
@@ -210,9 +415,46 @@ public:
         return Status::Empty;
     }
 
+    /// steal() moves up to requested_count items (but no more than half of the victim's queue) from the
+    /// fullest queue in the nearest tier which has anything in it. Returns the number of items stolen.
+    size_t steal(std::vector<T>& buffer, size_t requested_count, size_t location_id) {
+
+        for (const auto& tier : m_neighbors[location_id]) {
+            size_t victim = location_id;
+            size_t victim_size = 0;
+            for (size_t candidate : tier) {
+                size_t candidate_size = size(candidate);
+                if (candidate_size > victim_size) {
+                    victim = candidate;
+                    victim_size = candidate_size;
+                }
+            }
+            if (victim_size == 0) continue;
+
+            size_t batch_size = std::min(requested_count, (victim_size + 1) / 2);
+            size_t initial_size = buffer.size();
+            pop_local(buffer, batch_size, victim);
+            size_t stolen_count = buffer.size() - initial_size;
+            if (stolen_count != 0) {
+                return stolen_count;
+            }
+        }
+        return 0;
+    }
 
-    size_t get_threshold() { return m_threshold; }
-    void set_threshold(size_t threshold) { m_threshold = threshold; }
+    /// The ring buffer is bounded, and reservations plus the items already in the ring never add up to more than
+    /// the threshold. If it is full anyway, somebody pushed without reserving. Waiting for a consumer could deadlock, e.g. when the pusher is the only
+    /// worker, so we fail loudly instead. try_push() also fails when the slot is still being emptied by a consumer
+    /// which claimed it one lap ago and got preempted. That consumer isn't waiting on anything, so we retry.
+    void push_ring(LocalMailbox& mb, T& item) {
+        while (!mb.ring->try_push(item)) {
+            if (mb.ring->size() >= mb.ring->capacity()) {
+                throw JException("JMailbox: Lock-free ring buffer is full (capacity=%zu, threshold=%zu). Items must be reserved before they are pushed.",
+                                 mb.ring->capacity(), m_threshold.load());
+            }
+            std::this_thread::yield();
+        }
+    }
 
 };
 
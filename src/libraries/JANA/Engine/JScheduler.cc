@@ -41,11 +41,23 @@ JArrow* JScheduler::next_assignment(uint32_t worker_id, JArrow* assignment, JArr
     // Choose a new arrow. Loop over all arrows, starting at where we last left off, and pick the first
     // arrow that works
     size_t current_idx = m_next_idx;
+    JArrow* backpressured_source = nullptr;
     do {
         JArrow* candidate = m_topology->arrows[current_idx];
         current_idx += 1;
         current_idx %= m_topology->arrows.size();
 
+        if (candidate->get_type() == JArrow::NodeType::Source && candidate->is_backpressured()) {
+            // E.g. the source is holding back a barrier event. Visiting it would only waste a trip here, unless
+            // there is nothing else to do, in which case it is handed out below.
+            if (backpressured_source == nullptr &&
+                candidate->get_status() == JArrow::Status::Running &&
+                (candidate->is_parallel() || candidate->get_thread_count() == 0)) {
+                backpressured_source = candidate;
+            }
+            continue;
+        }
+
         if (candidate->get_status() == JArrow::Status::Running &&
             (candidate->is_parallel() || candidate->get_thread_count() == 0)) {
 
@@ -67,8 +79,10 @@ JArrow* JScheduler::next_assignment(uint32_t worker_id, JArrow* assignment, JArr
                 return candidate;
 
             }
-            else {
-                // Candidate can be paused immediately because there is no more work coming
+            else if (candidate->get_thread_count() == 0) {
+                // Candidate can be paused immediately because there is no more work coming.
+                // If another worker is still executing it, that worker may yet push output downstream,
+                // so it is left to pause the arrow when it checks back in.
                 LOG_DEBUG(logger) << "Deactivating arrow '" << candidate->get_name() << "' (" << m_topology->running_arrow_count - 1 << " remaining)" << LOG_END;
                 candidate->pause();
                 assert(m_topology->running_arrow_count >= 0);
@@ -81,6 +95,16 @@ JArrow* JScheduler::next_assignment(uint32_t worker_id, JArrow* assignment, JArr
 
     } while (current_idx != m_next_idx);
 
+    if (backpressured_source != nullptr) {
+        // A worker which gets no assignment shuts down, so rather than losing it, let it visit the source anyway.
+        // The source reports ComeBackLater and the worker backs off until the rest of the topology catches up.
+        backpressured_source->update_thread_count(1);
+        LOG_DEBUG(logger) << "Worker " << worker_id << " => " << backpressured_source->get_name()
+                          << " (backpressured, but nothing else is runnable)" << LOG_END;
+        m_mutex.unlock();
+        return backpressured_source;
+    }
+
     m_mutex.unlock();
     return nullptr;  // We've looped through everything with no luck
 }
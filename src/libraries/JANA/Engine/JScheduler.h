@@ -17,8 +17,10 @@
     /// not unlike OpenMP's `schedule dynamic`.
     class JScheduler {
 
-    private:
+    protected:
         JArrowTopology* m_topology;
+
+    private:
         size_t m_next_idx;
         std::mutex m_mutex;
 
@@ -26,16 +28,29 @@
 
         /// Constructor. Note that a Scheduler operates on a vector of Arrow*s.
         JScheduler(JArrowTopology* topology);
+        virtual ~JScheduler() = default;
 
         /// Lets a Worker ask the Scheduler for another assignment. If no assignments make sense,
         /// Scheduler returns nullptr, which tells that Worker to idle until his next checkin.
         /// If next_assignment() makes any changes to internal Scheduler state or to any of its arrows,
         /// it must be synchronized.
-        JArrow* next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
+        virtual JArrow* next_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
 
         /// Lets a Worker tell the scheduler that he is shutting down and won't be working on his assignment
         /// any more. The scheduler is thus free to reassign the arrow to one of the remaining workers.
-        void last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
+        virtual void last_assignment(uint32_t worker_id, JArrow* assignment, JArrowMetrics::Status result);
+
+        /// Lets a Worker who received a nullptr assignment ask whether it should wait for more work (true)
+        /// or shut down (false). This scheduler only hands out nullptr once the topology has paused, so
+        /// workers always shut down.
+        virtual bool wait_for_work(uint32_t /*worker_id*/) { return false; }
+
+        /// Lets a Worker tell the scheduler that its assignment made progress, which may have created work
+        /// for somebody else. This scheduler never lets workers idle, so there is nobody to tell.
+        virtual void report_progress(JArrow* /*assignment*/) {}
+
+        /// Wakes up any workers who are waiting for work, so that they can notice that they should stop.
+        virtual void wake_all_workers() {}
 
         /// Logger is public so that somebody else can configure it
         JLogger logger;
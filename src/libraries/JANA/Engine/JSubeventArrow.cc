@@ -1,56 +1,273 @@
 
+
 // Copyright 2020, Jefferson Science Associates, LLC.
 // Subject to the terms in the LICENSE file found in the top-level directory.
 
 #include "JSubeventArrow.h"
 
 
+namespace {
+
+/// All three arrows report back to the scheduler the same way JEventProcessorArrow does
+template <typename InStatus, typename OutStatus>
+JArrowMetrics::Status to_arrow_status(InStatus in_status, OutStatus out_status) {
+    if (in_status == InStatus::Ready && out_status == OutStatus::Ready) {
+        return JArrowMetrics::Status::KeepGoing;
+    }
+    return JArrowMetrics::Status::ComeBackLater;
+}
 
+/// Only finds anything if processing was interrupted partway through
+void delete_subevents(JMailbox<JSubevent>& mailbox) {
+    std::vector<JSubevent> items;
+    for (size_t location_id=0; location_id<mailbox.get_locations_count(); ++location_id) {
+        mailbox.pop(items, mailbox.size(location_id), location_id);
+    }
+    for (auto& item : items) {
+        delete item.subevent_data;
+    }
+}
+} // namespace
 
 
 JSubeventArrow::JSubeventArrow(std::string name, JSubeventProcessor* processor,
                                JMailbox<JSubevent>* inbox, JMailbox<JSubevent>* outbox)
     : JArrow(name, true, NodeType::Stage), m_processor(processor), m_inbox(inbox), m_outbox(outbox) {
+}
 
-
+JSubeventArrow::~JSubeventArrow() {
+    delete_subevents(*m_inbox);
+    delete m_inbox;
 }
 
-void JSubeventArrow::execute(JArrowMetrics& /* results */, size_t /* location_id */) {
-    // auto in_result = _inbox.pop(in_buffer, get_chunksize());
-    // for (JObject* item : in_buffer) {
-    //    _processor.process(item);
-    // }
-    // auto out_result = _outbox.push(out_buffer);
-    // measure everything
+void JSubeventArrow::execute(JArrowMetrics& result, size_t location_id) {
+
+    auto start_total_time = std::chrono::steady_clock::now();
+
+    // Every subevent we take in comes out again, so we only take in as many as the outbox has room for.
+    // The merge arrow is sequential, so its inbox only has the one location.
+    auto reserved_count = m_outbox->reserve(get_chunksize(), 0);
+    std::vector<JSubevent> items;
+    size_t stolen_count = 0;
+    auto in_status = JMailbox<JSubevent>::Status::Empty;
+    if (reserved_count != 0) {
+        in_status = m_inbox->pop(items, reserved_count, location_id, stolen_count);
+    }
+
+    auto start_latency_time = std::chrono::steady_clock::now();
+    for (auto& item : items) {
+        if (item.subevent_data != nullptr) {
+            m_processor->process(*item.subevent_data);
+        }
+    }
+    auto end_latency_time = std::chrono::steady_clock::now();
+
+    auto message_count = items.size();
+    auto out_status = m_outbox->push(items, reserved_count, 0);
+    if (reserved_count == 0) {
+        out_status = JMailbox<JSubevent>::Status::Full;
+    }
+    auto end_queue_time = std::chrono::steady_clock::now();
+
+    auto latency = (end_latency_time - start_latency_time);
+    auto overhead = (end_queue_time - start_total_time) - latency;
+    result.update(to_arrow_status(in_status, out_status), message_count, 1, latency, overhead, stolen_count);
 }
 
+size_t JSubeventArrow::get_pending() { return m_inbox->size(); }
+
+size_t JSubeventArrow::get_threshold() { return m_inbox->get_threshold(); }
+
+void JSubeventArrow::set_threshold(size_t threshold) { m_inbox->set_threshold(threshold); }
+
+bool JSubeventArrow::is_backpressured() { return m_outbox->size() >= m_outbox->get_threshold(); }
+
+JWaitSignal* JSubeventArrow::get_input_signal() { return &m_inbox->get_push_signal(); }
+
+
+
 JSplitArrow::JSplitArrow(std::string name, JSubeventProcessor* processor,
                          JMailbox<Event>* inbox, JMailbox<JSubevent>* outbox)
     : JArrow(name, true, NodeType::Stage), m_processor(processor), m_inbox(inbox), m_outbox(outbox) {
+}
 
+JSplitArrow::~JSplitArrow() {
+    for (auto& item : m_overflow) {
+        delete item.subevent_data;
+    }
 }
 
-void JSplitArrow::execute(JArrowMetrics& /* results */, size_t /* location_id */) {
-    // input_queue.pop(in_buffer, get_chunksize());
-    // _processor.split(event, in_buffer);
-    // size_t count = in_buffer.size();
-    // for (size_t i=0; i<count; ++i) {
-    //     out_buffer.push_back(JSubevent(event, buffer[i], i, count));
-    // }
-    // _outbox.push(out_buffer);
-    // measure everything
+void JSplitArrow::execute(JArrowMetrics& result, size_t location_id) {
+
+    auto start_total_time = std::chrono::steady_clock::now();
+
+    // Subevents left over from last time go first, and we don't split anything new until they are all gone
+    std::vector<JSubevent> items;
+    bool has_overflow;
+    {
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        has_overflow = !m_overflow.empty();
+        if (has_overflow) {
+            auto reserved_count = m_outbox->reserve(m_overflow.size(), location_id);
+            items.insert(items.end(), std::make_move_iterator(m_overflow.begin()), std::make_move_iterator(m_overflow.begin() + reserved_count));
+            m_overflow.erase(m_overflow.begin(), m_overflow.begin() + reserved_count);
+        }
+    }
+    if (has_overflow) {
+        auto message_count = items.size();
+        auto out_status = m_outbox->push(items, message_count, location_id);
+        auto status = (message_count != 0 && out_status == JMailbox<JSubevent>::Status::Ready) ? JArrowMetrics::Status::KeepGoing
+                                                                                             : JArrowMetrics::Status::ComeBackLater;
+        result.update(status, 0, 1, std::chrono::milliseconds(0), std::chrono::steady_clock::now() - start_total_time);
+        return;
+    }
+
+    std::vector<Event> events;
+    size_t stolen_count = 0;
+    auto in_status = m_inbox->pop(events, get_chunksize(), location_id, stolen_count);
+
+    auto start_latency_time = std::chrono::steady_clock::now();
+    std::vector<JObject*> subevents;
+    for (auto& event : events) {
+        subevents.clear();
+        m_processor->split(*event, subevents);
+        long count = subevents.size();
+        if (count == 0) {
+            items.push_back({event, nullptr, 0, 0});
+        }
+        for (long i=0; i<count; ++i) {
+            items.push_back({event, subevents[i], i, count});
+        }
+    }
+    auto end_latency_time = std::chrono::steady_clock::now();
+
+    auto out_status = JMailbox<JSubevent>::Status::Ready;
+    if (!items.empty()) {
+        auto reserved_count = m_outbox->reserve(items.size(), location_id);
+        if (reserved_count != items.size()) {
+            std::lock_guard<std::mutex> lock(m_overflow_mutex);
+            m_overflow.insert(m_overflow.end(), std::make_move_iterator(items.begin() + reserved_count), std::make_move_iterator(items.end()));
+            items.erase(items.begin() + reserved_count, items.end());
+            out_status = JMailbox<JSubevent>::Status::Full;
+        }
+        auto push_status = m_outbox->push(items, reserved_count, location_id);
+        if (out_status == JMailbox<JSubevent>::Status::Ready) {
+            out_status = push_status;
+        }
+    }
+    auto end_queue_time = std::chrono::steady_clock::now();
+
+    auto latency = (end_latency_time - start_latency_time);
+    auto overhead = (end_queue_time - start_total_time) - latency;
+    result.update(to_arrow_status(in_status, out_status), events.size(), 1, latency, overhead, stolen_count);
+}
+
+size_t JSplitArrow::get_pending() {
+    std::lock_guard<std::mutex> lock(m_overflow_mutex);
+    return m_inbox->size() + m_overflow.size();
 }
 
+size_t JSplitArrow::get_threshold() { return m_inbox->get_threshold(); }
+
+void JSplitArrow::set_threshold(size_t threshold) { m_inbox->set_threshold(threshold); }
+
+bool JSplitArrow::is_backpressured() { return m_outbox->size() >= m_outbox->get_threshold(); }
+
+JWaitSignal* JSplitArrow::get_input_signal() { return &m_inbox->get_push_signal(); }
+
+
+
 JMergeArrow::JMergeArrow(std::string name, JSubeventProcessor* processor, JMailbox<JSubevent>* inbox, JMailbox<Event>* outbox)
-    : JArrow(name, true, NodeType::Stage), m_processor(processor), m_inbox(inbox), m_outbox(outbox) {
+    : JArrow(name, false, NodeType::Stage), m_processor(processor), m_inbox(inbox), m_outbox(outbox) {
+}
 
+JMergeArrow::~JMergeArrow() {
+    // Only non-empty if processing was interrupted partway through an event
+    for (auto& pair : m_partial_events) {
+        for (auto subevent : pair.second.subevents) {
+            delete subevent;
+        }
+    }
+    delete_subevents(*m_inbox);
+    delete m_inbox;
 }
 
-void JMergeArrow::execute(JArrowMetrics& /* results */, size_t /* location_id */) {
-    // This is the complicated one
-    // For now, don't worry about allocations, or about queue overflow
-    // Maintain a map of {parent, (count, [subevents])}
-    // on each add, if subevents.size() = count, then
-    //
-    // Alternative: If item is not part of current event, then push back onto queue
+void JMergeArrow::execute(JArrowMetrics& result, size_t location_id) {
+
+    auto start_total_time = std::chrono::steady_clock::now();
+
+    // Merged events left over from last time go first, and we don't take in anything new until they are all gone
+    if (!m_overflow.empty()) {
+        auto reserved_count = m_outbox->reserve(m_overflow.size(), location_id);
+        std::vector<Event> merged_events(std::make_move_iterator(m_overflow.begin()), std::make_move_iterator(m_overflow.begin() + reserved_count));
+        m_overflow.erase(m_overflow.begin(), m_overflow.begin() + reserved_count);
+        m_overflow_count = m_overflow.size();
+        auto out_status = m_outbox->push(merged_events, reserved_count, location_id);
+        auto status = (reserved_count != 0 && out_status == JMailbox<Event>::Status::Ready) ? JArrowMetrics::Status::KeepGoing
+                                                                                          : JArrowMetrics::Status::ComeBackLater;
+        result.update(status, 0, 1, std::chrono::milliseconds(0), std::chrono::steady_clock::now() - start_total_time);
+        return;
+    }
+
+    std::vector<JSubevent> items;
+    auto in_status = m_inbox->pop(items, get_chunksize(), 0);
+
+    auto start_latency_time = std::chrono::steady_clock::now();
+    std::vector<Event> merged_events;
+    for (auto& item : items) {
+        if (item.subevent_count == 0) {
+            // Nothing was split off, so there is nothing to wait for
+            std::vector<JObject*> none;
+            m_processor->merge(*item.parent, none);
+            merged_events.push_back(std::move(item.parent));
+            continue;
+        }
+        auto& partial = m_partial_events[item.parent.get()];
+        if (partial.subevents.empty()) {
+            partial.subevents.resize(item.subevent_count, nullptr);
+        }
+        partial.subevents[item.subevent_id] = item.subevent_data;
+        partial.received_count += 1;
+
+        if (partial.received_count == item.subevent_count) {
+            m_processor->merge(*item.parent, partial.subevents);
+            for (auto subevent : partial.subevents) {
+                delete subevent;
+            }
+            m_partial_events.erase(item.parent.get());
+            merged_events.push_back(std::move(item.parent));
+        }
+    }
+    auto end_latency_time = std::chrono::steady_clock::now();
+
+    auto out_status = JMailbox<Event>::Status::Ready;
+    auto message_count = merged_events.size();
+    if (!merged_events.empty()) {
+        auto reserved_count = m_outbox->reserve(merged_events.size(), location_id);
+        if (reserved_count != merged_events.size()) {
+            m_overflow.insert(m_overflow.end(), std::make_move_iterator(merged_events.begin() + reserved_count), std::make_move_iterator(merged_events.end()));
+            m_overflow_count = m_overflow.size();
+            merged_events.erase(merged_events.begin() + reserved_count, merged_events.end());
+            out_status = JMailbox<Event>::Status::Full;
+        }
+        auto push_status = m_outbox->push(merged_events, reserved_count, location_id);
+        if (out_status == JMailbox<Event>::Status::Ready) {
+            out_status = push_status;
+        }
+    }
+    auto end_queue_time = std::chrono::steady_clock::now();
+
+    auto latency = (end_latency_time - start_latency_time);
+    auto overhead = (end_queue_time - start_total_time) - latency;
+    result.update(to_arrow_status(in_status, out_status), message_count, 1, latency, overhead);
 }
+
+size_t JMergeArrow::get_pending() { return m_inbox->size() + m_overflow_count; }
+
+size_t JMergeArrow::get_threshold() { return m_inbox->get_threshold(); }
+
+void JMergeArrow::set_threshold(size_t threshold) { m_inbox->set_threshold(threshold); }
+
+bool JMergeArrow::is_backpressured() { return m_outbox->size() >= m_outbox->get_threshold(); }
+
+JWaitSignal* JMergeArrow::get_input_signal() { return &m_inbox->get_push_signal(); }
@@ -9,87 +9,100 @@
 #include "JMailbox.h"
 #include "JArrow.h"
 #include <JANA/JEvent.h>
+#include <JANA/JSubeventProcessor.h>
+
+#include <deque>
+#include <unordered_map>
 
 using Event = std::shared_ptr<JEvent>;
 
 
 /// Data structure containing all of the metadata needed to merge subevents
 /// on a per-event basis without needing a barrier. This is used internally by
-/// Queues and Arrows and the user should never need to interact with it directly
+/// Queues and Arrows and the user should never need to interact with it directly.
+/// A parent which split into no subevents at all still sends a single JSubevent with
+/// subevent_data == nullptr and subevent_count == 0, so that it reaches the merge.
 struct JSubevent {
-    JEvent* parent;
+    Event parent;
     JObject* subevent_data;
     long subevent_id;
     long subevent_count;
 };
 
 
-
-/// SubtaskProcessor offers sub-event-level parallelism. The idea is to split parent
-/// event S into independent subtasks T, and automatically bundling them with
-/// bookkeeping information X onto a Queue<pair<T,X>. process :: T -> U handles the stateless,
-/// parallel parts; its Arrow pushes messages on to a Queue<pair<U,X>, so that merge() :: S -> [U] -> V
-/// "joins" all completed "subtasks" of type U corresponding to one parent of type S, (i.e.
-/// a specific JEvent), back into a single entity of type V, (most likely the same JEvent as S,
-/// only now containing more data) which is pushed onto a Queue<V>, bookkeeping information now gone.
-/// Note that there is no blocking and that our streaming paradigm is not compromised.
-
-/// Abstract class which is meant to extended by the user to contain all
-/// subtask-related functions. (Data lives in a JObject instead)
-/// Future versions might be templated for two reasons:
-///  1. To make the functions non-virtual,
-///  2. To replace the generic JObject pointer with something typesafe
-/// Future versions could also recycle JObjects by using another Queue.
-class JSubeventProcessor {
-
-    virtual void split(JEvent& parent, std::vector<JObject*>& subevents) = 0;
-
-    virtual void process(JObject& subevent) = 0;
-
-    virtual void merge(JEvent& parent, std::vector<JObject*>& subevents) = 0;
-
-};
+/// The subevent pipeline is made of three arrows, which together replace a single Event -> Event stage:
+///
+///   JSplitArrow:    Event -> [JSubevent]   Parallel. Calls JSubeventProcessor::split on each parent event.
+///   JSubeventArrow: JSubevent -> JSubevent Parallel. Calls JSubeventProcessor::process on each subevent.
+///   JMergeArrow:    [JSubevent] -> Event   Sequential. Collects subevents until all subevent_count of them
+///                                          have arrived, then calls JSubeventProcessor::merge on the parent.
+///
+/// JSubeventArrow and JMergeArrow own their input queues; the Event queues belong to the topology.
+///
+/// Every arrow reserves room in its output queue before pushing. A single event may split into more subevents
+/// than the queue will ever have room for at once, so JSplitArrow (and likewise JMergeArrow) holds on to whatever
+/// didn't fit, and pushes it the next time around instead of taking in more input.
+///
+/// Subevent data is owned by whichever arrow, queue, or overflow currently holds its JSubevent, so each arrow
+/// deletes the subevents left in its overflow and owned inbox when it is destroyed mid-run.
 
 class JSubeventArrow : public JArrow {
     JSubeventProcessor* m_processor;
-    JMailbox<JSubevent>* m_inbox;
-    JMailbox<JSubevent>* m_outbox;
+    JMailbox<JSubevent>* m_inbox;   // owning
+    JMailbox<JSubevent>* m_outbox;  // non-owning
 public:
     JSubeventArrow(std::string name, JSubeventProcessor* processor,
                    JMailbox<JSubevent>* inbox, JMailbox<JSubevent>* outbox);
+    ~JSubeventArrow() override;
     void execute(JArrowMetrics&, size_t location_id) override;
     size_t get_pending() final;
     size_t get_threshold() final;
     void set_threshold(size_t) final;
+    bool is_backpressured() final;
+    JWaitSignal* get_input_signal() final;
 };
 
 class JSplitArrow : public JArrow {
     JSubeventProcessor* m_processor;
-    JMailbox<Event>* m_inbox;
-    JMailbox<JSubevent>* m_outbox;
+    JMailbox<Event>* m_inbox;       // non-owning
+    JMailbox<JSubevent>* m_outbox;  // non-owning
+    std::mutex m_overflow_mutex;
+    std::deque<JSubevent> m_overflow;  // Subevents which didn't fit into the outbox yet
 public:
     JSplitArrow(std::string name, JSubeventProcessor* processor,
                 JMailbox<Event>* inbox, JMailbox<JSubevent>* outbox);
+    ~JSplitArrow() override;
     void execute(JArrowMetrics&, size_t location_id) override;
     size_t get_pending() final;
     size_t get_threshold() final;
     void set_threshold(size_t) final;
+    bool is_backpressured() final;
+    JWaitSignal* get_input_signal() final;
 };
 
 class JMergeArrow : public JArrow {
+    struct PartialEvent {
+        std::vector<JObject*> subevents;  // Indexed by subevent_id
+        long received_count = 0;
+    };
+
     JSubeventProcessor* m_processor;
-    JMailbox<JSubevent>* m_inbox;
-    JMailbox<Event>* m_outbox;
+    JMailbox<JSubevent>* m_inbox;   // owning
+    JMailbox<Event>* m_outbox;      // non-owning
+    std::unordered_map<JEvent*, PartialEvent> m_partial_events;  // Only touched by one thread, since we are sequential
+    std::vector<Event> m_overflow;                              // Merged events which didn't fit into the outbox yet
+    std::atomic<size_t> m_overflow_count {0};                   // So that get_pending() doesn't race with execute()
 public:
     JMergeArrow(std::string name, JSubeventProcessor* processor,
                 JMailbox<JSubevent>* inbox, JMailbox<Event>* outbox);
+    ~JMergeArrow() override;
     void execute(JArrowMetrics&, size_t location_id) override;
     size_t get_pending() final;
     size_t get_threshold() final;
     void set_threshold(size_t) final;
+    bool is_backpressured() final;
+    JWaitSignal* get_input_signal() final;
 };
 
 
 #endif //JANA2_JSUBEVENTARROW_H
-
-
@@ -8,6 +8,8 @@
 #include <JANA/Engine/JArrowTopology.h>
 #include "JEventSourceArrow.h"
 #include "JEventProcessorArrow.h"
+#include "JSubeventArrow.h"
+#include "JEventReorderArrow.h"
 #include <memory>
 
 
@@ -15,6 +17,7 @@ class JTopologyBuilder : public JService {
 
 	std::shared_ptr<JParameterManager> m_params;
 	std::shared_ptr<JComponentManager> m_components;
+	std::shared_ptr<JTaskPool> m_task_pool;
         JLogger m_logger;
 	JArrowTopology* m_override = nullptr; // Non-owning; caller responsible for deletion.
 
@@ -37,6 +40,7 @@ public:
 	void acquire_services(JServiceLocator* sl) override {
 		m_components = sl->get<JComponentManager>();
 		m_params = sl->get<JParameterManager>();
+		m_task_pool = sl->get<JTaskPool>();
                 m_logger = sl->get<JLoggingService>()->get_logger("JArrow");
 	};
 
@@ -44,45 +48,96 @@ public:
 
 		auto topology = new JArrowTopology;
 		topology->component_manager = m_components;  // Ensure the lifespan of the component manager exceeds that of the topology
+		topology->task_pool = m_task_pool;
 
 		size_t event_pool_size = nthreads;
 		size_t event_queue_threshold = 80;
 		size_t event_source_chunksize = 40;
 		size_t event_processor_chunksize = 1;
-		size_t location_count = 1;
+		size_t subevent_queue_threshold = 1000;
+		size_t subevent_chunksize = 16;
                 bool enable_call_graph_recording = false;
                 bool enable_stealing = false;
 		bool limit_total_events_in_flight = true;
 		int affinity = 2;
 		int locality = 0;
+		std::string queue_backend = "locking";
+		std::string backoff_strategy = "exponential";
 
 		m_params->SetDefaultParameter("jana:event_pool_size", event_pool_size);
 		m_params->SetDefaultParameter("jana:limit_total_events_in_flight", limit_total_events_in_flight);
 		m_params->SetDefaultParameter("jana:event_queue_threshold", event_queue_threshold);
 		m_params->SetDefaultParameter("jana:event_source_chunksize", event_source_chunksize);
 		m_params->SetDefaultParameter("jana:event_processor_chunksize", event_processor_chunksize);
+		m_params->SetDefaultParameter("jana:subevent_queue_threshold", subevent_queue_threshold, "Subevent mailbox buffer size. Only used if there are JSubeventProcessors");
+		m_params->SetDefaultParameter("jana:subevent_chunksize", subevent_chunksize, "Number of subevents a worker processes per visit to the subevent arrow");
 		m_params->SetDefaultParameter("jana:enable_stealing", enable_stealing);
 		m_params->SetDefaultParameter("jana:affinity", affinity);
 		m_params->SetDefaultParameter("jana:locality", locality);
+		m_params->SetDefaultParameter("jana:queue_backend", queue_backend, "Event queue storage: 'locking' (mutex+deque) or 'lockfree' (ring buffer)");
+		m_params->SetDefaultParameter("jana:backoff_strategy", backoff_strategy, "How workers wait for input: 'constant', 'linear', 'exponential' (sleep), or 'adaptive' (spin, yield, then park until woken)");
+
+		EventQueue::Backend backend;
+		if (queue_backend == "locking") {
+			backend = EventQueue::Backend::Locking;
+		}
+		else if (queue_backend == "lockfree") {
+			backend = EventQueue::Backend::LockFree;
+		}
+		else {
+			throw JException("Invalid value for jana:queue_backend: '%s'", queue_backend.c_str());
+		}
+
+		JArrow::BackoffStrategy processor_backoff;
+		if (backoff_strategy == "constant") {
+			processor_backoff = JArrow::BackoffStrategy::Constant;
+		}
+		else if (backoff_strategy == "linear") {
+			processor_backoff = JArrow::BackoffStrategy::Linear;
+		}
+		else if (backoff_strategy == "exponential") {
+			processor_backoff = JArrow::BackoffStrategy::Exponential;
+		}
+		else if (backoff_strategy == "adaptive") {
+			processor_backoff = JArrow::BackoffStrategy::Adaptive;
+		}
+		else {
+			throw JException("Invalid value for jana:backoff_strategy: '%s'", backoff_strategy.c_str());
+		}
 
 
             // TODO: Move params onto JProcessorTopology. Maybe do the same for nthreads actually
 		topology->mapping.initialize(static_cast<JProcessorMapping::AffinityStrategy>(affinity),
 		                             static_cast<JProcessorMapping::LocalityStrategy>(locality));
 
+		// Each location gets its own share of the event pool, which is first-touched on that location.
+		// The remainder is spread over the first locations, so that the shares add up to exactly jana:event_pool_size.
+		size_t location_count = topology->mapping.get_loc_count();
+		std::vector<size_t> location_pool_sizes(location_count, event_pool_size / location_count);
+		for (size_t loc=0; loc<event_pool_size % location_count; ++loc) {
+			location_pool_sizes[loc] += 1;
+		}
 		topology->event_pool = std::make_shared<JEventPool>(m_components,
-                                                                    event_pool_size,
-		                                                    location_count,
-                                                                    limit_total_events_in_flight);
+                                                                    location_pool_sizes,
+                                                                    limit_total_events_in_flight,
+                                                                    &topology->mapping);
 
 		// Assume the simplest possible topology for now, complicate later
-		auto queue = new EventQueue(event_queue_threshold, topology->mapping.get_loc_count(), enable_stealing);
+		auto queue = new EventQueue(event_queue_threshold, topology->mapping.get_loc_count(), enable_stealing, backend);
 		topology->queues.push_back(queue);
+		if (enable_stealing) {
+			for (size_t loc_id=0; loc_id<topology->mapping.get_loc_count(); ++loc_id) {
+				queue->set_neighbors(loc_id, topology->mapping.get_neighbor_tiers(loc_id));
+			}
+		}
 
+		// Barrier events hold back every source, not just their own
+		auto barrier_group = std::make_shared<JEventSourceArrow::BarrierGroup>();
 		for (auto src : m_components->get_evt_srces()) {
 
 			// create arrow for each source. Don't open until arrow.run() called
-			JArrow *arrow = new JEventSourceArrow(src->GetName(), src, queue, topology->event_pool);
+			auto arrow = new JEventSourceArrow(src->GetName(), src, queue, topology->event_pool);
+			arrow->set_barrier_group(barrier_group);
 			arrow->set_backoff_tries(0);
                         arrow->set_running_arrows(&topology->running_arrow_count);
 			topology->arrows.push_back(arrow);
@@ -91,19 +146,91 @@ public:
                         arrow->set_logger(m_logger);
 		}
 
-		auto proc_arrow = new JEventProcessorArrow("processors", queue, nullptr, topology->event_pool);
-                for (auto src_arrow : topology->sources) {
-                    src_arrow->attach(proc_arrow);
+		// Each JSubeventProcessor inserts a split -> process -> merge stage in front of the JEventProcessors
+		EventQueue* upstream_queue = queue;
+		std::vector<JArrow*> upstream_arrows = topology->sources;
+		auto subevent_backend = (backend == EventQueue::Backend::Locking) ? JMailbox<JSubevent>::Backend::Locking
+		                                                                  : JMailbox<JSubevent>::Backend::LockFree;
+		for (auto subevt_proc : m_components->get_subevt_procs()) {
+			auto name = subevt_proc->GetTypeName();
+			auto subevent_queue = new JMailbox<JSubevent>(subevent_queue_threshold, topology->mapping.get_loc_count(), enable_stealing, subevent_backend);
+			auto merge_queue = new JMailbox<JSubevent>(subevent_queue_threshold, 1, false, subevent_backend);
+			auto merged_queue = new EventQueue(event_queue_threshold, topology->mapping.get_loc_count(), enable_stealing, backend);
+			topology->queues.push_back(merged_queue);
+			if (enable_stealing) {
+				for (size_t loc_id=0; loc_id<topology->mapping.get_loc_count(); ++loc_id) {
+					subevent_queue->set_neighbors(loc_id, topology->mapping.get_neighbor_tiers(loc_id));
+					merged_queue->set_neighbors(loc_id, topology->mapping.get_neighbor_tiers(loc_id));
+				}
+			}
+
+			auto split_arrow = new JSplitArrow(name + ":split", subevt_proc, upstream_queue, subevent_queue);
+			auto subevent_arrow = new JSubeventArrow(name + ":process", subevt_proc, subevent_queue, merge_queue);
+			auto merge_arrow = new JMergeArrow(name + ":merge", subevt_proc, merge_queue, merged_queue);
+			split_arrow->set_chunksize(event_processor_chunksize);
+			subevent_arrow->set_chunksize(subevent_chunksize);
+			merge_arrow->set_chunksize(subevent_queue_threshold);
+
+			for (auto upstream : upstream_arrows) {
+				upstream->attach(split_arrow);
+			}
+			split_arrow->attach(subevent_arrow);
+			subevent_arrow->attach(merge_arrow);
+
+			for (JArrow* arrow : std::vector<JArrow*> {split_arrow, subevent_arrow, merge_arrow}) {
+				arrow->set_backoff_strategy(processor_backoff);
+				arrow->set_running_arrows(&topology->running_arrow_count);
+				arrow->set_logger(m_logger);
+				topology->arrows.push_back(arrow);
+			}
+			upstream_queue = merged_queue;
+			upstream_arrows = std::vector<JArrow*> {merge_arrow};
+		}
+
+		// Processors which asked for ordered events run behind a reorder buffer. Everybody else stays fully parallel.
+		std::vector<JEventProcessor*> unordered_procs;
+		std::vector<JEventProcessor*> ordered_procs;
+		for (auto proc : m_components->get_evt_procs()) {
+			(proc->AreEventsOrdered() ? ordered_procs : unordered_procs).push_back(proc);
+		}
+		EventQueue* reorder_queue = nullptr;
+		if (!ordered_procs.empty()) {
+			// The reorder arrow is sequential, so it needs to be able to steal from every location
+			reorder_queue = new EventQueue(event_queue_threshold, topology->mapping.get_loc_count(), true, backend);
+			topology->queues.push_back(reorder_queue);
+		}
+
+		auto proc_arrow = new JEventProcessorArrow("processors", upstream_queue, reorder_queue, topology->event_pool);
+                for (auto upstream : upstream_arrows) {
+                    upstream->attach(proc_arrow);
                 }
 		proc_arrow->set_chunksize(event_processor_chunksize);
+		proc_arrow->set_task_pool(m_task_pool.get());
+		proc_arrow->set_backoff_strategy(processor_backoff);
 		topology->arrows.push_back(proc_arrow);
                 proc_arrow->set_running_arrows(&topology->running_arrow_count);
                 proc_arrow->set_logger(m_logger);
 
-                for (auto proc : m_components->get_evt_procs()) {
+                for (auto proc : unordered_procs) {
 			proc_arrow->add_processor(proc);
 		}
-		topology->sinks.push_back(proc_arrow);
+
+		if (ordered_procs.empty()) {
+			topology->sinks.push_back(proc_arrow);
+		}
+		else {
+			auto reorder_arrow = new JEventReorderArrow("ordered_processors", reorder_queue, topology->event_pool);
+			proc_arrow->attach(reorder_arrow);
+			reorder_arrow->set_chunksize(event_queue_threshold);
+			reorder_arrow->set_backoff_strategy(processor_backoff);
+			reorder_arrow->set_running_arrows(&topology->running_arrow_count);
+			reorder_arrow->set_logger(m_logger);
+			for (auto proc : ordered_procs) {
+				reorder_arrow->add_processor(proc);
+			}
+			topology->arrows.push_back(reorder_arrow);
+			topology->sinks.push_back(reorder_arrow);
+		}
 
 		return topology;
 	}
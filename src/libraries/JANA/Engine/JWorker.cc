@@ -71,6 +71,13 @@ void JWorker::measure_perf(WorkerSummary& summary) {
     summary.last_idle_time_ms = millis(last_idle_time).count();
     summary.last_heartbeat_ms = millis(JWorkerMetrics::clock_t::now() - last_heartbeat).count();
 
+    JWorkerMetrics::duration_t total_spin_time, total_park_time, last_spin_time, last_park_time;
+    latest_worker_metrics.get_wait_times(total_spin_time, total_park_time, last_spin_time, last_park_time);
+    summary.total_spin_time_ms = millis(total_spin_time).count();
+    summary.total_park_time_ms = millis(total_park_time).count();
+    summary.last_spin_time_ms = millis(last_spin_time).count();
+    summary.last_park_time_ms = millis(last_park_time).count();
+
     summary.worker_id = m_worker_id;
     summary.cpu_id = m_cpu_id;
     summary.is_pinned = m_pin_to_cpu;
@@ -164,6 +171,47 @@ void JWorker::wait_for_stop() {
     }
 }
 
+constexpr std::chrono::microseconds JWorker::k_adaptive_max_park_time;
+
+/// wait_adaptive() implements BackoffStrategy::Adaptive. Successive failed tries escalate from spinning
+/// (cheapest wakeup, burns the core), to yielding (lets other threads run), to parking on the arrow's input
+/// signal (frees the core; woken by JMailbox::push). Every phase returns as soon as new input has arrived.
+/// Parking is capped at k_adaptive_max_park_time, so that a worker whose upstream has gone quiet still returns to the
+/// scheduler promptly.
+void JWorker::wait_adaptive(uint32_t current_tries, JWaitSignal* signal, uint64_t epoch,
+                            JWorkerMetrics::duration_t park_timeout,
+                            JWorkerMetrics::duration_t& spin_duration,
+                            JWorkerMetrics::duration_t& park_duration) {
+
+    using jclock_t = JWorkerMetrics::clock_t;
+    auto start_time = jclock_t::now();
+
+    if (current_tries == 1) {
+        for (unsigned i=0; i<k_adaptive_spin_count; ++i) {
+            if (signal != nullptr && signal->has_changed(epoch)) break;
+            JCpuRelax();
+        }
+        spin_duration += jclock_t::now() - start_time;
+    }
+    else if (current_tries == 2) {
+        for (unsigned i=0; i<k_adaptive_yield_count; ++i) {
+            if (signal != nullptr && signal->has_changed(epoch)) break;
+            std::this_thread::yield();
+        }
+        spin_duration += jclock_t::now() - start_time;
+    }
+    else {
+        park_timeout = std::min(park_timeout, std::chrono::duration_cast<JWorkerMetrics::duration_t>(k_adaptive_max_park_time));
+        if (signal != nullptr) {
+            signal->wait_for(epoch, park_timeout);
+        }
+        else {
+            std::this_thread::sleep_for(park_timeout);
+        }
+        park_duration += jclock_t::now() - start_time;
+    }
+}
+
 void JWorker::loop() {
     using jclock_t = JWorkerMetrics::clock_t;
     try {
@@ -186,15 +234,23 @@ void JWorker::loop() {
             auto idle_duration = jclock_t::duration::zero();
             auto retry_duration = jclock_t::duration::zero();
             auto useful_duration = jclock_t::duration::zero();
+            auto spin_duration = jclock_t::duration::zero();
+            auto park_duration = jclock_t::duration::zero();
 
             if (m_assignment == nullptr) {
-                LOG_DEBUG(logger) << "Worker " << m_worker_id << " shutdown driven by topology pause" << LOG_END;
-                m_run_state = RunState::Stopped;
-                return;
-
-                // LOG_DEBUG(logger) << "Worker " << m_worker_id << " idling due to lack of assignments" << LOG_END;
-                // std::this_thread::sleep_for(std::chrono::microseconds(1));
-                // idle_duration = jclock_t::now() - scheduler_time;
+                if (m_task_pool != nullptr && m_task_pool->try_help()) {
+                    LOG_TRACE(logger) << "Worker " << m_worker_id << " helped with intra-event work while idle" << LOG_END;
+                    useful_duration = jclock_t::now() - scheduler_time;
+                }
+                else {
+                    if (!m_scheduler->wait_for_work(m_worker_id)) {
+                        LOG_DEBUG(logger) << "Worker " << m_worker_id << " shutdown driven by topology pause" << LOG_END;
+                        m_run_state = RunState::Stopped;
+                        return;
+                    }
+                    LOG_TRACE(logger) << "Worker " << m_worker_id << " idled due to lack of assignments" << LOG_END;
+                    idle_duration = jclock_t::now() - scheduler_time;
+                }
             }
             else {
 
@@ -203,6 +259,10 @@ void JWorker::loop() {
                 auto backoff_tries = m_assignment->get_backoff_tries();
                 auto checkin_time = m_assignment->get_checkin_time();
 
+                // Only the adaptive strategy waits on the input signal. Not asking for it spares the upstream
+                // arrows from notifying it on every push.
+                auto input_signal = (backoff_strategy == JArrow::BackoffStrategy::Adaptive) ? m_assignment->get_input_signal() : nullptr;
+
                 uint32_t current_tries = 0;
                 auto backoff_duration = initial_backoff_time;
 
@@ -213,7 +273,10 @@ void JWorker::loop() {
 
                     LOG_TRACE(logger) << "Worker " << m_worker_id << " is executing "
                                       << m_assignment->get_name() << LOG_END;
+                    // Read the epoch _before_ executing, so that anything pushed after execute() saw an empty queue wakes us
+                    uint64_t input_epoch = (input_signal != nullptr) ? input_signal->get_epoch() : 0;
                     auto before_execute_time = jclock_t::now();
+                    auto message_count_before = m_arrow_metrics.get_total_message_count();
                     m_assignment->execute(m_arrow_metrics, m_location_id);
                     last_result = m_arrow_metrics.get_last_status();
                     useful_duration += (jclock_t::now() - before_execute_time);
@@ -222,12 +285,40 @@ void JWorker::loop() {
                     if (last_result == JArrowMetrics::Status::KeepGoing) {
                         LOG_DEBUG(logger) << "Worker " << m_worker_id << " succeeded at "
                                           << m_assignment->get_name() << LOG_END;
+                        m_scheduler->report_progress(m_assignment);
                         current_tries = 0;
                         backoff_duration = initial_backoff_time;
                     }
                     else {
+                        if (m_arrow_metrics.get_total_message_count() != message_count_before) {
+                            // E.g. the arrow drained its input and returned the events to the pool, which may be
+                            // what a parked source was waiting for
+                            m_scheduler->report_progress(m_assignment);
+                        }
                         current_tries++;
-                        if (backoff_tries > 0) {
+                        // Rather than backing off, spend the time on intra-event work if there is any. Sequential
+                        // arrows are excluded because nobody else can run them until we check back in.
+                        bool helped = false;
+                        if (m_task_pool != nullptr && m_assignment->is_parallel()) {
+                            auto before_help_time = jclock_t::now();
+                            helped = m_task_pool->try_help();
+                            if (helped) useful_duration += (jclock_t::now() - before_help_time);
+                        }
+                        if (helped) {
+                            LOG_TRACE(logger) << "Worker " << m_worker_id << " helped with intra-event work instead of backing off from "
+                                              << m_assignment->get_name() << LOG_END;
+                        }
+                        else if (backoff_tries > 0 && backoff_strategy == JArrow::BackoffStrategy::Adaptive) {
+                            LOG_TRACE(logger) << "Worker " << m_worker_id << " waiting adaptively on "
+                                              << m_assignment->get_name() << ", tries = " << current_tries
+                                              << LOG_END;
+                            backoff_duration *= 2;
+                            auto spin_before = spin_duration;
+                            auto park_before = park_duration;
+                            wait_adaptive(current_tries, input_signal, input_epoch, backoff_duration, spin_duration, park_duration);
+                            retry_duration += (spin_duration - spin_before) + (park_duration - park_before);
+                        }
+                        else if (backoff_tries > 0) {
                             if (backoff_strategy == JArrow::BackoffStrategy::Linear) {
                                 backoff_duration += initial_backoff_time;
                             }
@@ -244,7 +335,8 @@ void JWorker::loop() {
                     }
                 }
             }
-            m_worker_metrics.update(start_time, 1, useful_duration, retry_duration, scheduler_duration, idle_duration);
+            m_worker_metrics.update(start_time, 1, useful_duration, retry_duration, scheduler_duration, idle_duration,
+                                    spin_duration, park_duration);
             if (m_assignment != nullptr) {
                 JArrowMetrics latest_arrow_metrics;
                 latest_arrow_metrics.clear();
@@ -10,6 +10,7 @@
 #include <JANA/Engine/JScheduler.h>
 #include <JANA/Engine/JWorkerMetrics.h>
 #include <JANA/Engine/JArrowPerfSummary.h>
+#include <JANA/Services/JTaskPool.h>
 #include <atomic>
 
 
@@ -40,6 +41,17 @@ private:
     JWorkerMetrics m_worker_metrics;
     JArrowMetrics m_arrow_metrics;
     std::mutex m_assignment_mutex;
+    JTaskPool* m_task_pool = nullptr;   // Intra-event work we can pick up instead of sitting idle
+
+    /// Tuning for BackoffStrategy::Adaptive
+    static constexpr unsigned k_adaptive_spin_count = 256;
+    static constexpr unsigned k_adaptive_yield_count = 16;
+    static constexpr std::chrono::microseconds k_adaptive_max_park_time {1000};
+
+    void wait_adaptive(uint32_t current_tries, JWaitSignal* signal, uint64_t epoch,
+                       JWorkerMetrics::duration_t park_timeout,
+                       JWorkerMetrics::duration_t& spin_duration,
+                       JWorkerMetrics::duration_t& park_duration);
 
 public:
     JWorker(JScheduler* scheduler, unsigned worker_id, unsigned cpu_id, unsigned domain_id, bool pin_to_cpu);
@@ -54,6 +66,9 @@ public:
 
     RunState get_runstate() { return m_run_state; };
 
+    /// Must be called before start()
+    void set_task_pool(JTaskPool* task_pool) { m_task_pool = task_pool; }
+
     void start();
     void request_stop();
     void wait_for_stop();
@@ -37,6 +37,10 @@ private:
     duration_t m_last_retry_time;
     duration_t m_last_scheduler_time;
     duration_t m_last_idle_time;
+    duration_t m_total_spin_time;      // Subset of retry time spent spinning or yielding
+    duration_t m_total_park_time;      // Subset of retry time spent parked (or sleeping)
+    duration_t m_last_spin_time;
+    duration_t m_last_park_time;
 
 
 public:
@@ -53,6 +57,10 @@ public:
         m_last_retry_time = zero;
         m_last_scheduler_time = zero;
         m_last_idle_time = zero;
+        m_total_spin_time = zero;
+        m_total_park_time = zero;
+        m_last_spin_time = zero;
+        m_last_park_time = zero;
         m_mutex.unlock();
     }
 
@@ -69,6 +77,10 @@ public:
         m_last_retry_time = zero;
         m_last_scheduler_time = zero;
         m_last_idle_time = zero;
+        m_total_spin_time = zero;
+        m_total_park_time = zero;
+        m_last_spin_time = zero;
+        m_last_park_time = zero;
         m_mutex.unlock();
     }
 
@@ -87,6 +99,10 @@ public:
         m_last_retry_time = other.m_last_retry_time;
         m_last_scheduler_time = other.m_last_scheduler_time;
         m_last_idle_time = other.m_last_idle_time;
+        m_total_spin_time += other.m_total_spin_time;
+        m_total_park_time += other.m_total_park_time;
+        m_last_spin_time = other.m_last_spin_time;
+        m_last_park_time = other.m_last_park_time;
         other.m_mutex.unlock();
         m_mutex.unlock();
     }
@@ -98,7 +114,9 @@ public:
                 const duration_t& useful_time,
                 const duration_t& retry_time,
                 const duration_t& scheduler_time,
-                const duration_t& idle_time) {
+                const duration_t& idle_time,
+                const duration_t& spin_time = duration_t::zero(),
+                const duration_t& park_time = duration_t::zero()) {
 
         m_mutex.lock();
         m_scheduler_visit_count += scheduler_visit_count;
@@ -110,6 +128,10 @@ public:
         m_last_retry_time = retry_time;
         m_last_scheduler_time = scheduler_time;
         m_last_idle_time = idle_time;
+        m_total_spin_time += spin_time;
+        m_total_park_time += park_time;
+        m_last_spin_time = spin_time;
+        m_last_park_time = park_time;
         m_last_heartbeat = heartbeat;
         m_mutex.unlock();
     }
@@ -141,6 +163,20 @@ public:
         m_mutex.unlock();
     }
 
+    void get_wait_times(
+             duration_t& total_spin_time,
+             duration_t& total_park_time,
+             duration_t& last_spin_time,
+             duration_t& last_park_time) {
+
+        m_mutex.lock();
+        total_spin_time = m_total_spin_time;
+        total_park_time = m_total_park_time;
+        last_spin_time = m_last_spin_time;
+        last_park_time = m_last_park_time;
+        m_mutex.unlock();
+    }
+
 };
 
 
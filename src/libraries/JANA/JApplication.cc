@@ -13,6 +13,7 @@
 #include <JANA/Services/JPluginLoader.h>
 #include <JANA/Services/JComponentManager.h>
 #include <JANA/Services/JGlobalRootLock.h>
+#include <JANA/Services/JTaskPool.h>
 #include <JANA/Engine/JArrowProcessingController.h>
 #include <JANA/Engine/JDebugProcessingController.h>
 #include <JANA/Utils/JCpuInfo.h>
@@ -37,6 +38,7 @@ JApplication::JApplication(JParameterManager* params) {
     m_service_locator.provide(std::make_shared<JComponentManager>(this));
     m_service_locator.provide(std::make_shared<JGlobalRootLock>());
     m_service_locator.provide(std::make_shared<JTopologyBuilder>());
+    m_service_locator.provide(std::make_shared<JTaskPool>());
 
     m_plugin_loader = m_service_locator.get<JPluginLoader>();
     m_component_manager = m_service_locator.get<JComponentManager>();
@@ -84,6 +86,10 @@ void JApplication::Add(JEventProcessor* processor) {
     m_component_manager->add(processor);
 }
 
+void JApplication::Add(JSubeventProcessor* processor) {
+    m_component_manager->add(processor);
+}
+
 void JApplication::Add(std::string event_source_name) {
     m_component_manager->add(event_source_name);
 }
@@ -11,6 +11,7 @@
 
 class JApplication;
 class JEventProcessor;
+class JSubeventProcessor;
 class JEventSource;
 class JEventSourceGenerator;
 class JFactoryGenerator;
@@ -64,6 +65,7 @@ public:
     void Add(JFactoryGenerator* factory_generator);
     void Add(JEventSource* event_source);
     void Add(JEventProcessor* processor);
+    void Add(JSubeventProcessor* processor);
 
 
     // Controlling processing
@@ -9,6 +9,7 @@
 #include <JANA/JObject.h>
 #include <JANA/JException.h>
 #include <JANA/JFactoryT.h>
+#include <JANA/JValueFactoryT.h>
 #include <JANA/JFactorySet.h>
 #include <JANA/JLogger.h>
 
@@ -39,6 +40,10 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         virtual ~JEvent() {
             if (mFactorySet != nullptr) mFactorySet->Release();
             delete mFactorySet;
+            for (auto& pair : mInactiveFactorySets) {
+                pair.second->Release();
+                delete pair.second;
+            }
         }
 
         void SetFactorySet(JFactorySet* aFactorySet) {
@@ -66,6 +71,7 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         template<class T> const T* GetSingleStrict(const std::string& tag = "") const;
         template<class T> std::vector<const T*> Get(const std::string& tag = "") const;
         template<class T> typename JFactoryT<T>::PairType GetIterators(const std::string& aTag = "") const;
+        template<class T> const std::vector<T>& GetValues(const std::string& tag = "") const;
         template<class T> std::vector<const T*> GetAll() const;
         template<class T> std::map<std::pair<std::string,std::string>,std::vector<T*>> GetAllChildren() const;
 
@@ -84,6 +90,7 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         void SetDefaultTags(std::map<std::string, std::string> aDefaultTags){mDefaultTags=aDefaultTags; mUseDefaultTags = !mDefaultTags.empty();}
 
         void SetSequential(bool isSequential) {mIsBarrierEvent = isSequential;}
+        void SetSequenceNumber(uint64_t aSequenceNumber){mSequenceNumber = aSequenceNumber;}
 
         //GETTERS
         int32_t GetRunNumber() const {return mRunNumber;}
@@ -94,19 +101,24 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
         JInspector* GetJInspector() const {return &mInspector;}
         void Inspect() const { mInspector.Loop();} // TODO: Force this not to be inlined AND used so it is defined in libJANA.a
         bool GetSequential() const {return mIsBarrierEvent;}
+        uint64_t GetSequenceNumber() const {return mSequenceNumber;}
         friend class JEventPool;
 
     private:
         JApplication* mApplication = nullptr;
         int32_t mRunNumber = 0;
         uint64_t mEventNumber = 0;
+        uint64_t mSequenceNumber = 0;      // Position in its JEventSource's output, assigned from the slot it was read into. Consecutive, unlike event numbers.
         mutable JFactorySet* mFactorySet = nullptr;
         mutable JCallGraphRecorder mCallGraph;
         mutable JInspector mInspector;
         bool mUseDefaultTags = false;
         std::map<std::string, std::string> mDefaultTags;
         JEventSource* mEventSource = nullptr;
+        std::vector<std::pair<JEventSource*, JFactorySet*>> mInactiveFactorySets;  // Owned, see JEventPool::switch_source
         bool mIsBarrierEvent = false;
+        size_t mPoolLocation = 0;          // Which JEventPool location first touched this event's memory
+        bool mHasPoolLocation = false;
 };
 
 /// Insert() allows an EventSource to insert items directly into the JEvent,
@@ -116,12 +128,12 @@ class JEvent : public JResettable, public std::enable_shared_from_this<JEvent>
 template <class T>
 inline JFactoryT<T>* JEvent::Insert(T* item, const std::string& tag) const {
 
-    std::string resolved_tag = tag;
+    const std::string* resolved_tag = &tag;
     if (mUseDefaultTags) {
-        auto defaultTag = mDefaultTags.find(JTypeInfo::demangle<T>());
-        if (defaultTag != mDefaultTags.end()) resolved_tag = defaultTag->second;
+        auto defaultTag = mDefaultTags.find(JTypeInfo::demangle_cached<T>());
+        if (defaultTag != mDefaultTags.end()) resolved_tag = &defaultTag->second;
     }
-    auto factory = mFactorySet->GetFactory<T>(resolved_tag);
+    auto factory = mFactorySet->GetFactory<T>(*resolved_tag);
     if (factory == nullptr) {
         factory = new JFactoryT<T>;
         factory->SetTag(tag);
@@ -134,12 +146,12 @@ inline JFactoryT<T>* JEvent::Insert(T* item, const std::string& tag) const {
 template <class T>
 inline JFactoryT<T>* JEvent::Insert(const std::vector<T*>& items, const std::string& tag) const {
 
-    std::string resolved_tag = tag;
+    const std::string* resolved_tag = &tag;
     if (mUseDefaultTags) {
-        auto defaultTag = mDefaultTags.find(JTypeInfo::demangle<T>());
-        if (defaultTag != mDefaultTags.end()) resolved_tag = defaultTag->second;
+        auto defaultTag = mDefaultTags.find(JTypeInfo::demangle_cached<T>());
+        if (defaultTag != mDefaultTags.end()) resolved_tag = &defaultTag->second;
     }
-    auto factory = mFactorySet->GetFactory<T>(resolved_tag);
+    auto factory = mFactorySet->GetFactory<T>(*resolved_tag);
     if (factory == nullptr) {
         factory = new JFactoryT<T>;
         factory->SetTag(tag);
@@ -168,15 +180,15 @@ inline std::vector<JFactory*> JEvent::GetAllFactories() const {
 template<class T>
 inline JFactoryT<T>* JEvent::GetFactory(const std::string& tag, bool throw_on_missing) const
 {
-    std::string resolved_tag = tag;
+    const std::string* resolved_tag = &tag;
     if (mUseDefaultTags) {
-        auto defaultTag = mDefaultTags.find(JTypeInfo::demangle<T>());
-        if (defaultTag != mDefaultTags.end()) resolved_tag = defaultTag->second;
+        auto defaultTag = mDefaultTags.find(JTypeInfo::demangle_cached<T>());
+        if (defaultTag != mDefaultTags.end()) resolved_tag = &defaultTag->second;
     }
-    auto factory = mFactorySet->GetFactory<T>(resolved_tag);
+    auto factory = mFactorySet->GetFactory<T>(*resolved_tag);
     if (factory == nullptr) {
         if (throw_on_missing) {
-            throw JException("Could not find JFactoryT<" + JTypeInfo::demangle<T>() + "> with tag=" + tag);
+            throw JException("Could not find JFactoryT<" + JTypeInfo::demangle_cached<T>() + "> with tag=" + tag);
         }
     };
     return factory;
@@ -189,7 +201,7 @@ inline JMetadata<T> JEvent::GetMetadata(const std::string& tag) const {
 
     auto factory = GetFactory<T>(tag, true);
     // Make sure that JFactoryT::Process has already been called before returning the metadata
-    factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    factory->GetOrCreate(*this, mApplication, mRunNumber);
     return factory->GetMetadata();
 }
 
@@ -206,9 +218,9 @@ inline JMetadata<T> JEvent::GetMetadata(const std::string& tag) const {
 template<class T>
 JFactoryT<T>* JEvent::Get(const T** destination, const std::string& tag) const
 {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
     auto factory = GetFactory<T>(tag, true);
-    auto iterators = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    auto iterators = factory->GetOrCreate(*this, mApplication, mRunNumber);
     if (std::distance(iterators.first, iterators.second) == 0) {
         *destination = nullptr;
     }
@@ -223,9 +235,9 @@ JFactoryT<T>* JEvent::Get(const T** destination, const std::string& tag) const
 template<class T>
 JFactoryT<T>* JEvent::Get(std::vector<const T*>& destination, const std::string& tag) const
 {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
     auto factory = GetFactory<T>(tag, true);
-    auto iterators = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    auto iterators = factory->GetOrCreate(*this, mApplication, mRunNumber);
     for (auto it=iterators.first; it!=iterators.second; it++) {
         destination.push_back(*it);
     }
@@ -244,8 +256,8 @@ JFactoryT<T>* JEvent::Get(std::vector<const T*>& destination, const std::string&
 /// - If the factory contains more than one item, GetSingle returns the first item
 
 template<class T> const T* JEvent::GetSingle(const std::string& tag) const {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
+    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(*this, mApplication, mRunNumber);
     if (std::distance(iterators.first, iterators.second) == 0) {
         mCallGraph.FinishFactoryCall();
         return nullptr;
@@ -261,8 +273,8 @@ template<class T> const T* JEvent::GetSingle(const std::string& tag) const {
 /// - If the factory exists but contains no items, GetSingleStrict throws an exception
 /// - If the factory contains more than one item, GetSingleStrict throws an exception
 template<class T> const T* JEvent::GetSingleStrict(const std::string& tag) const {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
+    auto iterators = GetFactory<T>(tag, true)->GetOrCreate(*this, mApplication, mRunNumber);
     mCallGraph.FinishFactoryCall();
     if (std::distance(iterators.first, iterators.second) == 0) {
         throw JException("GetSingle failed due to missing %d", NAME_OF(T));
@@ -277,8 +289,8 @@ template<class T> const T* JEvent::GetSingleStrict(const std::string& tag) const
 template<class T>
 std::vector<const T*> JEvent::Get(const std::string& tag) const {
 
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iters = GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
+    auto iters = GetFactory<T>(tag, true)->GetOrCreate(*this, mApplication, mRunNumber);
     std::vector<const T*> vec;
     for (auto it=iters.first; it!=iters.second; ++it) {
         vec.push_back(*it);
@@ -295,7 +307,7 @@ inline std::vector<JFactoryT<T>*> JEvent::GetFactoryAll(bool throw_on_missing) c
     auto factories = mFactorySet->GetAllFactories<T>();
     if (factories.size() == 0) {
         if (throw_on_missing) {
-            throw JException("Could not find any JFactoryT<" + JTypeInfo::demangle<T>() + "> (from any tag)");
+            throw JException("Could not find any JFactoryT<" + JTypeInfo::demangle_cached<T>() + "> (from any tag)");
         }
     };
     return factories;
@@ -306,7 +318,7 @@ template<class T>
 void JEvent::GetAll(std::vector<const T*>& destination) const {
     auto factories = GetFactoryAll<T>(true);
     for (auto factory : factories) {
-        auto iterators = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+        auto iterators = factory->GetOrCreate(*this, mApplication, mRunNumber);
         for (auto it = iterators.first; it != iterators.second; it++) {
             destination.push_back(*it);
         }
@@ -320,7 +332,7 @@ std::vector<const T*> JEvent::GetAll() const {
     auto factories = GetFactoryAll<T>(true);
 
     for (auto factory : factories) {
-        auto iters = factory->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+        auto iters = factory->GetOrCreate(*this, mApplication, mRunNumber);
         std::vector<const T*> vec;
         for (auto it = iters.first; it != iters.second; ++it) {
             vec.push_back(*it);
@@ -351,13 +363,30 @@ std::map<std::pair<std::string, std::string>, std::vector<S*>> JEvent::GetAllChi
 
 template<class T>
 typename JFactoryT<T>::PairType JEvent::GetIterators(const std::string& tag) const {
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
-    auto iters =GetFactory<T>(tag, true)->GetOrCreate(this->shared_from_this(), mApplication, mRunNumber);
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
+    auto iters = GetFactory<T>(tag, true)->GetOrCreate(*this, mApplication, mRunNumber);
     mCallGraph.FinishFactoryCall();
     return iters;
 }
 
 
+/// GetValues returns the contiguous, by-value storage of a JValueFactoryT<T>, for loops which want to iterate
+/// a dense array instead of chasing T*'s. Throws if the factory for (T, tag) is not a JValueFactoryT.
+/// Objects which were Insert()ed into the factory as T* are not included; Get<T>() still sees everything.
+template<class T>
+const std::vector<T>& JEvent::GetValues(const std::string& tag) const {
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
+    auto factory = dynamic_cast<JValueFactoryT<T>*>(GetFactory<T>(tag, true));
+    if (factory == nullptr) {
+        mCallGraph.FinishFactoryCall();
+        throw JException("GetValues requires a JValueFactoryT<" + JTypeInfo::demangle_cached<T>() + "> with tag=" + tag);
+    }
+    factory->GetOrCreate(*this, mApplication, mRunNumber);
+    mCallGraph.FinishFactoryCall();
+    return factory->GetValues();
+}
+
+
 template<class T>
 JFactoryT<T>* JEvent::GetSingle(const T* &t, const char *tag, bool exception_if_not_one) const
 {
@@ -373,7 +402,7 @@ JFactoryT<T>* JEvent::GetSingle(const T* &t, const char *tag, bool exception_if_
     /// exception_if_not_one to false. In that case, you will have to check if t==NULL to
     /// know if the call succeeded.
 
-    mCallGraph.StartFactoryCall(JTypeInfo::demangle<T>(), tag);
+    mCallGraph.StartFactoryCall(JCallGraphRecorder::GetTypeNameId<T>(), tag);
     std::vector<const T*> v;
     JFactoryT<T> *fac = Get(v, tag);
     if(v.size()!=1){
@@ -61,22 +61,37 @@ public:
 
 
     // TODO: Improve this type signature
-    virtual void DoMap(const std::shared_ptr<const JEvent>& e) {
+    /// DoMap hands a single event to DoMapBatch(), so that every caller goes through the same path as
+    /// JEventProcessorArrow. It is deliberately not virtual: subclasses customize Process() or ProcessBatch().
+    void DoMap(const std::shared_ptr<const JEvent>& e) {
+        DoMapBatch({e});
+    }
+
+
+    /// DoMapBatch is the batched counterpart of DoMap. The batch is split wherever the run number changes,
+    /// so that EndRun/BeginRun still happen at the right points, and each piece is handed to ProcessBatch().
+    virtual void DoMapBatch(const std::vector<std::shared_ptr<const JEvent>>& events) {
         try {
-            std::call_once(m_init_flag, &JEventProcessor::DoInitialize, this);
-            auto run_number = e->GetRunNumber();
-            {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                if (m_last_run_number != run_number) {
-                    if (m_last_run_number != -1) {
-                        EndRun();
-                    }
-                    m_last_run_number = run_number;
-                    BeginRun(e);
+            std::call_once(m_map_init_flag, &JEventProcessor::DoInitialize, this);
+            std::vector<std::shared_ptr<const JEvent>> segment;
+            size_t begin = 0;
+            while (begin < events.size()) {
+                auto run_number = events[begin]->GetRunNumber();
+                size_t end = begin + 1;
+                while (end < events.size() && events[end]->GetRunNumber() == run_number) {
+                    end += 1;
                 }
+                ChangeRunIfNeeded(events[begin]);
+                if (begin == 0 && end == events.size()) {
+                    ProcessBatch(events);  // Common case: the whole batch belongs to one run
+                }
+                else {
+                    segment.assign(events.begin() + begin, events.begin() + end);
+                    ProcessBatch(segment);
+                }
+                m_event_count += (end - begin);
+                begin = end;
             }
-            Process(e);
-            m_event_count += 1;
         }
         catch (JException& ex) {
             ex.plugin_name = m_plugin_name;
@@ -84,7 +99,7 @@ public:
             throw ex;
         }
         catch (...) {
-            auto ex = JException("Unknown exception in JEventProcessor::DoMap()");
+            auto ex = JException("Unknown exception in JEventProcessor::DoMapBatch()");
             ex.nested_exception = std::current_exception();
             ex.plugin_name = m_plugin_name;
             ex.component_name = GetType();
@@ -134,6 +149,15 @@ public:
     virtual void Process(const std::shared_ptr<const JEvent>&) {
         throw JException("Not implemented yet!");
     }
+
+    /// ProcessBatch is an optional alternative to Process() which receives up to jana:event_processor_chunksize
+    /// events at once, all from the same run. Processors which lock a shared resource (e.g. a histogram or an
+    /// output file) can override it in order to take the lock once per batch. By default it calls Process().
+    virtual void ProcessBatch(const std::vector<std::shared_ptr<const JEvent>>& events) {
+        for (const auto& event : events) {
+            Process(event);
+        }
+    }
     virtual void EndRun() {}
 
     virtual void Finish() {}
@@ -169,9 +193,11 @@ protected:
     void SetResourceName(std::string resource_name) { m_resource_name = std::move(resource_name); }
 
     /// SetEventsOrdered allows the user to tell the parallelization engine that it needs to see
-    /// the event stream ordered by increasing event IDs. (Note that this requires all EventSources
-    /// emit event IDs which are consecutive.) Ordering by event ID makes for cleaner output, but comes
-    /// with a performance penalty, so it is best if this is enabled during debugging, and disabled otherwise.
+    /// the event stream in the order each JEventSource emitted it, which is by increasing event number unless
+    /// the source sets event numbers itself. (Events from different sources are interleaved.) Ordered
+    /// processors are run one event at a time, behind a reorder buffer; processors which don't request
+    /// ordering are unaffected. Ordering makes for cleaner output, but comes with a performance penalty.
+    /// Must be called before the processing topology is built, e.g. in the constructor.
 
     void SetEventsOrdered(bool receive_events_in_order) { m_receive_events_in_order = receive_events_in_order; }
 
@@ -184,12 +210,25 @@ private:
     std::string m_type_name;
     std::string m_resource_name;
     std::once_flag m_init_flag;
+    std::once_flag m_map_init_flag;  // Not m_init_flag, which DoInitialize() itself uses; nesting call_once on one flag deadlocks
     std::once_flag m_finish_flag;
     std::atomic_ullong m_event_count;
     int32_t m_last_run_number = -1;
     std::mutex m_mutex;
     bool m_receive_events_in_order = false;
 
+    void ChangeRunIfNeeded(const std::shared_ptr<const JEvent>& e) {
+        auto run_number = e->GetRunNumber();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_last_run_number != run_number) {
+            if (m_last_run_number != -1) {
+                EndRun();
+            }
+            m_last_run_number = run_number;
+            BeginRun(e);
+        }
+    }
+
     /// This is called by JApplication::Add(JEventProcessor*). There
     /// should be no need to call it from anywhere else.
     void SetJApplication(JApplication* app) { mApplication = app; }
@@ -5,6 +5,8 @@
 #include <mutex>
 
 #include <JANA/JEventProcessor.h>
+#include <JANA/JApplication.h>
+#include <JANA/Services/JTaskPool.h>
 
 /// This class can be used to safely implement sequential code while ensuring
 /// the factory algorithms are run in parallel.
@@ -104,7 +106,16 @@ public:
     void Finish() override {};
 
 	void Process(const std::shared_ptr<const JEvent>& event) override final{
-		for( auto p : mPrefetch ) p->Get(event);  // make sure all factories have been activated
+		// make sure all factories have been activated. With jana:intraevent_parallelism, independent
+		// prefetches are computed concurrently; JFactoryT serializes any upstream factories they share.
+		auto pool = GetTaskPool(event);
+		if( pool != nullptr && pool->is_enabled() && mPrefetch.size() > 1 ){
+			std::vector<std::function<void()>> tasks;
+			for( auto p : mPrefetch ) tasks.push_back([p, &event](){ p->Get(event); });
+			pool->run_all(tasks);
+		}else{
+			for( auto p : mPrefetch ) p->Get(event);
+		}
 		std::lock_guard<std::mutex> lck(mMutex);
 		for( auto p : mPrefetch ) p->Fill(event); // Copy object pointers into members
 		ProcessSequential( event );
@@ -115,6 +126,16 @@ private:
 
 	std::vector<Prefetch*> mPrefetch;
 	std::mutex mMutex;
+	std::once_flag mTaskPoolFlag;
+	JTaskPool* mTaskPool = nullptr;
+
+	JTaskPool* GetTaskPool(const std::shared_ptr<const JEvent>& event){
+		std::call_once(mTaskPoolFlag, [&](){
+			auto app = event->GetJApplication();
+			if( app != nullptr ) mTaskPool = app->GetService<JTaskPool>().get();
+		});
+		return mTaskPool;
+	}
 };
 
 
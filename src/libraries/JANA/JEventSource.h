@@ -14,6 +14,10 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <queue>
+#include <vector>
+#include <functional>
+#include <limits>
 
 class JFactoryGenerator;
 class JApplication;
@@ -152,72 +156,11 @@ public:
     }
 
     ReturnStatus DoNext(std::shared_ptr<JEvent> event) {
-
-        std::lock_guard<std::mutex> lock(m_mutex); // In general, DoNext must be synchronized.
-        auto first_evt_nr = m_nskip;
-        auto last_evt_nr = m_nevents + m_nskip;
-        try {
-            switch (m_status.load()) {
-
-                case SourceStatus::Unopened: DoInitialize(); // Fall-through to Opened afterwards
-
-                case SourceStatus::Opened:
-
-                    if (m_event_count < first_evt_nr) {
-                        event->SetEventNumber(m_event_count); // Default event number to event count
-                        GetEvent(event);
-                        m_event_count += 1;
-                        return ReturnStatus::TryAgain;  // Reject this event and recycle it
-                    }
-                    else if (m_nevents != 0 && (m_event_count == last_evt_nr)) {
-                        m_status = SourceStatus::Finished; // TODO: This isn't threadsafe at the moment
-                        return ReturnStatus::Finished;
-                    }
-                    else {
-                        event->SetEventNumber(m_event_count); // Default event number to event count
-                        GetEvent(event);
-                        m_event_count += 1;
-                        return ReturnStatus::Success; // Don't reject this event!
-                    }
-
-                default: //case SourceStatus::Finished:
-                    return ReturnStatus::Finished;
-            }
-        }
-        catch (RETURN_STATUS rs) {
-
-            if (rs == RETURN_STATUS::kNO_MORE_EVENTS) {
-                m_status = SourceStatus::Finished; // TODO: This isn't threadsafe at the moment
-                return ReturnStatus::Finished;
-            }
-            else if (rs == RETURN_STATUS::kTRY_AGAIN || rs == RETURN_STATUS::kBUSY) {
-                return ReturnStatus::TryAgain;
-            }
-            else if (rs == RETURN_STATUS::kERROR || rs == RETURN_STATUS::kUNKNOWN) {
-                JException ex ("JEventSource threw RETURN_STATUS::kERROR or kUNKNOWN");
-                ex.plugin_name = m_plugin_name;
-                ex.component_name = GetType();
-                throw ex;
-            }
-            else {
-                return ReturnStatus::Success;
-            }
-        }
-        catch (JException& ex) {
-            ex.plugin_name = m_plugin_name;
-            ex.component_name = GetType();
-            throw ex;
-        }
-        catch (std::runtime_error& e){
-            throw(JException(e.what()));
-        }
-        catch (...) {
-            auto ex = JException("Unknown exception in JEventSource::GetEvent()");
-            ex.nested_exception = std::current_exception();
-            ex.plugin_name = m_plugin_name;
-            ex.component_name = GetType();
-            throw ex;
+        if (m_enable_parallel_get_event) {
+            return DoNextUnsynchronized(event);  // GetEvent is reentrant, and the bookkeeping is lock-free
         }
+        std::lock_guard<std::mutex> lock(m_mutex); // In general, DoNext must be synchronized.
+        return DoNextUnsynchronized(event);
     }
 
     /// Calls the optional-and-discouraged user-provided FinishEvent virtual method, enforcing
@@ -229,6 +172,7 @@ public:
             std::lock_guard<std::mutex> lock(m_mutex);
             FinishEvent(event);
         }
+        m_events_in_flight -= 1;
     }
 
 
@@ -244,6 +188,9 @@ public:
 
     uint64_t GetEventCount() const { return m_event_count; };
 
+    /// Number of events this source has emitted which haven't been through DoFinish() yet
+    uint64_t GetEventsInFlight() const { return m_events_in_flight; }
+
     JApplication* GetApplication() const { return m_application; }
 
     virtual std::string GetType() const { return m_type_name; }
@@ -278,6 +225,15 @@ public:
     /// which will hurt performance. Conceptually, FinishEvent isn't great, and so should be avoided when possible.
     void EnableFinishEvent() { m_enable_free_event = true; }
 
+    // Meant to be called by user
+    /// EnableParallelGetEvent() is intended to be called by the user in the constructor in order to declare that
+    /// GetEvent is reentrant, e.g. because each call reads an independent record from a seekable file. JANA then lets
+    /// several workers call GetEvent at once instead of serializing them on the JEventSource mutex. Default event
+    /// numbers, nskip, and nevents are still handled exactly. FinishEvent, if enabled, remains serialized.
+    void EnableParallelGetEvent() { m_enable_parallel_get_event = true; }
+
+    bool IsParallelGetEventEnabled() const { return m_enable_parallel_get_event; }
+
     // Meant to be called by JANA
     void SetApplication(JApplication* app) { m_application = app; }
 
@@ -292,11 +248,137 @@ public:
 
 
 private:
+    ReturnStatus DoNextUnsynchronized(const std::shared_ptr<JEvent>& event) {
+
+        auto first_evt_nr = m_nskip;
+        auto last_evt_nr = m_nevents + m_nskip;
+        try {
+            switch (m_status.load()) {
+
+                case SourceStatus::Unopened: DoInitialize(); // Fall-through to Opened afterwards
+
+                case SourceStatus::Opened: {
+
+                    uint64_t slot = ClaimSlot();
+                    if ((m_nevents != 0 && slot >= last_evt_nr) || slot >= m_end_slot) {
+                        return ReleaseSlotPastEnd();
+                    }
+                    event->SetEventNumber(slot); // Default event number to event count
+                    // Every slot below the end is emitted exactly once, so the slot is this event's position in the
+                    // source's output even when parallel GetEvent calls finish out of order. See JEventReorderArrow
+                    if (slot >= first_evt_nr) event->SetSequenceNumber(slot - first_evt_nr);
+                    try {
+                        GetEvent(event);
+                    }
+                    catch (RETURN_STATUS rs) {
+                        if (rs == RETURN_STATUS::kNO_MORE_EVENTS) {
+                            // Other workers may still be reading earlier slots, so only lower the end for now
+                            unsigned long long end_slot = m_end_slot;
+                            while (slot < end_slot && !m_end_slot.compare_exchange_weak(end_slot, slot)) {}
+                            return ReleaseSlotPastEnd();
+                        }
+                        if (rs != RETURN_STATUS::kSUCCESS) {
+                            ReturnSlot(slot);  // Whoever calls GetEvent next gets this slot instead
+                            throw;
+                        }
+                    }
+                    catch (...) {
+                        ReturnSlot(slot);
+                        throw;
+                    }
+                    m_outstanding_slots -= 1;
+                    m_event_count += 1;
+                    if (slot < first_evt_nr) {
+                        return ReturnStatus::TryAgain;  // Reject this event and recycle it
+                    }
+                    m_events_in_flight += 1;
+                    return ReturnStatus::Success; // Don't reject this event!
+                }
+
+                default: //case SourceStatus::Finished:
+                    return ReturnStatus::Finished;
+            }
+        }
+        catch (RETURN_STATUS rs) {
+
+            if (rs == RETURN_STATUS::kNO_MORE_EVENTS) {
+                m_status = SourceStatus::Finished;
+                return ReturnStatus::Finished;
+            }
+            else if (rs == RETURN_STATUS::kTRY_AGAIN || rs == RETURN_STATUS::kBUSY) {
+                return ReturnStatus::TryAgain;
+            }
+            else if (rs == RETURN_STATUS::kERROR || rs == RETURN_STATUS::kUNKNOWN) {
+                JException ex ("JEventSource threw RETURN_STATUS::kERROR or kUNKNOWN");
+                ex.plugin_name = m_plugin_name;
+                ex.component_name = GetType();
+                throw ex;
+            }
+            else {
+                return ReturnStatus::Success;
+            }
+        }
+        catch (JException& ex) {
+            ex.plugin_name = m_plugin_name;
+            ex.component_name = GetType();
+            throw ex;
+        }
+        catch (std::runtime_error& e){
+            throw(JException(e.what()));
+        }
+        catch (...) {
+            auto ex = JException("Unknown exception in JEventSource::GetEvent()");
+            ex.nested_exception = std::current_exception();
+            ex.plugin_name = m_plugin_name;
+            ex.component_name = GetType();
+            throw ex;
+        }
+    }
+
+    /// Slots number the events in the order GetEvent() was called for them, and are what nskip and nevents count.
+    /// A slot whose GetEvent() failed is handed to the next caller, so that no event number is skipped or repeated.
+    /// m_outstanding_slots counts the slots which are being read or waiting to be read again. It is a single counter
+    /// so that the last worker to run past the end can tell that nobody could still produce an earlier event.
+    uint64_t ClaimSlot() {
+        if (m_returned_slot_count != 0) {
+            std::lock_guard<std::mutex> lock(m_returned_slots_mutex);
+            if (!m_returned_slots.empty()) {
+                auto slot = m_returned_slots.top();
+                m_returned_slots.pop();
+                m_returned_slot_count -= 1;
+                return slot;
+            }
+        }
+        m_outstanding_slots += 1;
+        return m_next_slot++;
+    }
+
+    void ReturnSlot(uint64_t slot) {
+        std::lock_guard<std::mutex> lock(m_returned_slots_mutex);
+        m_returned_slots.push(slot);
+        m_returned_slot_count += 1;
+    }
+
+    ReturnStatus ReleaseSlotPastEnd() {
+        if (m_outstanding_slots.fetch_sub(1) == 1) {
+            m_status = SourceStatus::Finished;
+            return ReturnStatus::Finished;
+        }
+        return ReturnStatus::TryAgain;
+    }
+
     std::string m_resource_name;
     JApplication* m_application = nullptr;
     JFactoryGenerator* m_factory_generator = nullptr;
     std::atomic<SourceStatus> m_status;
     std::atomic_ullong m_event_count {0};
+    std::atomic_ullong m_events_in_flight {0};
+    std::atomic_ullong m_next_slot {0};
+    std::atomic_ullong m_end_slot {std::numeric_limits<uint64_t>::max()};   // First slot GetEvent() had no event for
+    std::atomic_ullong m_outstanding_slots {0};
+    std::atomic_ullong m_returned_slot_count {0};
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_returned_slots;
+    std::mutex m_returned_slots_mutex;
     uint64_t m_nskip = 0;
     uint64_t m_nevents = 0;
     std::string m_plugin_name;
@@ -305,6 +387,7 @@ private:
     std::once_flag m_close_flag;
     std::mutex m_mutex;
     bool m_enable_free_event = false;
+    bool m_enable_parallel_get_event = false;
 };
 
 #endif // _JEventSource_h_
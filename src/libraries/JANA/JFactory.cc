@@ -0,0 +1,19 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "JFactory.h"
+#include "JEvent.h"
+
+
+void JFactory::BeginRun(const JEvent& event) {
+    BeginRun(event.shared_from_this());
+}
+
+void JFactory::ChangeRun(const JEvent& event) {
+    ChangeRun(event.shared_from_this());
+}
+
+void JFactory::Process(const JEvent& event) {
+    Process(event.shared_from_this());
+}
@@ -7,6 +7,7 @@
 
 #include <JANA/JException.h>
 #include <JANA/Utils/JAny.h>
+#include <JANA/Utils/JTypeSlot.h>
 
 #include <string>
 #include <typeindex>
@@ -22,6 +23,7 @@
 class JEvent;
 class JObject;
 class JApplication;
+class JFactorySet;
 
 class JFactory {
 public:
@@ -32,7 +34,8 @@ public:
         JFACTORY_NULL = 0x00,
         PERSISTENT = 0x01,
         WRITE_TO_OUTPUT = 0x02,
-        NOT_OBJECT_OWNER = 0x04
+        NOT_OBJECT_OWNER = 0x04,
+        USE_ARENA = 0x08        // JFactoryT::Construct() allocates from a per-factory JArena, see there
     };
 
     JFactory(std::string aName, std::string aTag = "")
@@ -84,6 +87,9 @@ public:
     // Overloaded by JFactoryT
     virtual std::type_index GetObjectType() const = 0;
 
+    // Overloaded by JFactoryT, which can answer without touching the JTypeSlot registry
+    virtual size_t GetObjectTypeSlot() const { return JTypeSlot::Get(GetObjectType()); }
+
     virtual void ClearData() = 0;
 
 
@@ -97,6 +103,13 @@ public:
     virtual void Process(const std::shared_ptr<const JEvent>&) {}
     virtual void Finish() {}
 
+    // Non-owning overloads, which are what JANA actually calls. By default they forward to the shared_ptr versions
+    // above, which costs a shared_from_this() and therefore two atomic refcount updates on the event. Factories
+    // which don't need to keep the event alive beyond the call should override these instead.
+    virtual void BeginRun(const JEvent& event);
+    virtual void ChangeRun(const JEvent& event);
+    virtual void Process(const JEvent& event);
+
     virtual std::size_t GetNumObjects() const {
         return 0;
     }
@@ -154,8 +167,33 @@ protected:
     CreationStatus mCreationStatus = CreationStatus::NotCreatedYet;
     mutable std::mutex mMutex;
 
+    // Set once mData is complete for the current event, so that readers can skip mMutex entirely.
+    // Only GetOrCreate publishes, and only ClearData retracts.
+    std::atomic<bool> mDataReady {false};
+
     // Used to make sure Init is called only once
     std::once_flag mInitFlag;
+
+    /// Called whenever this factory may have acquired data for the current event. The first call per event pushes
+    /// the factory onto its JFactorySet's dirty list, so that JFactorySet::Release() only has to clear the factories
+    /// an event actually touched. Several threads may mark different factories of the same event at once.
+    void MarkDirty() {
+        if (mDirtyList == nullptr || mDirty.exchange(true, std::memory_order_relaxed)) return;
+        JFactory* head = mDirtyList->load(std::memory_order_relaxed);
+        do {
+            mNextDirty = head;
+        } while (!mDirtyList->compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /// Set by subclasses which call MarkDirty() on every path that acquires data, as JFactoryT does. Factories which
+    /// don't can't be skipped, so JFactorySet::Release() clears them after every event.
+    bool mMarksDirty = false;
+
+private:
+    friend class JFactorySet;
+    std::atomic<JFactory*>* mDirtyList = nullptr;  // Head of the owning JFactorySet's dirty list, if any
+    JFactory* mNextDirty = nullptr;
+    std::atomic<bool> mDirty {false};               // Whether this factory is on the dirty list
 };
 
 // Because C++ doesn't support templated virtual functions, we implement our own dispatch table, mUpcastVTable.
@@ -83,11 +83,40 @@ bool JFactorySet::Add(JFactory* aFactory)
         // return false;
     }
 
-    mFactories[typed_key] = aFactory;
-    mFactoriesFromString[untyped_key] = aFactory;
+    Insert(aFactory);
     return true;
 }
 
+//---------------------------------
+// Insert
+//---------------------------------
+void JFactorySet::Insert(JFactory* aFactory)
+{
+    /// Records a factory in every index. The caller is responsible for checking for duplicates.
+
+    aFactory->mDirtyList = &mDirtyFactories;
+    if (!aFactory->mMarksDirty) {
+        mUntrackedFactories.push_back(aFactory);
+    }
+    else if (aFactory->mStatus != JFactory::Status::Uninitialized) {
+        aFactory->MarkDirty();  // It may already hold data, e.g. if it was filled before being added
+    }
+    mFactories[std::make_pair(aFactory->GetObjectType(), aFactory->GetTag())] = aFactory;
+    mFactoriesFromString[std::make_pair(aFactory->GetObjectName(), aFactory->GetTag())] = aFactory;
+
+    auto slot = aFactory->GetObjectTypeSlot();
+    if (slot >= mFactoriesBySlot.size()) {
+        mFactoriesBySlot.resize(slot + 1);
+    }
+    auto& entry = mFactoriesBySlot[slot];
+    if (aFactory->GetTag().empty()) {
+        entry.untagged = aFactory;
+    }
+    else {
+        entry.tagged.emplace_back(aFactory->GetTag(), aFactory);
+    }
+}
+
 //---------------------------------
 // GetFactory
 //---------------------------------
@@ -124,7 +153,11 @@ void JFactorySet::Merge(JFactorySet &aFactorySet)
     /// passed into this method upon return from it can be considered
     /// duplicates. It will be left to the caller to delete those.
 
-    JFactorySet tmpSet; // keep track of duplicates to copy back into aFactorySet
+    // Factories which already hold data have to stay on a dirty list, so take them off aFactorySet's for now
+    // and put them back onto whichever list they belong to afterwards.
+    JFactory* dirty = aFactorySet.mDirtyFactories.exchange(nullptr);
+
+    std::vector<JFactory*> duplicates; // keep track of duplicates to copy back into aFactorySet
     for( auto pair : aFactorySet.mFactories ){
         auto factory = pair.second;
 
@@ -136,17 +169,27 @@ void JFactorySet::Merge(JFactorySet &aFactorySet)
 
         if (typed_result != std::end(mFactories) || untyped_result != std::end(mFactoriesFromString)) {
             // Factory is duplicate. Return to caller just in case
-            tmpSet.mFactories[pair.first] = factory;
+            duplicates.push_back(factory);
         }
         else {
-            mFactories[typed_key] = factory;
-            mFactoriesFromString[untyped_key] = factory;
+            Insert(factory);
         }
     }
 
     // Copy duplicates back to aFactorySet
-    aFactorySet.mFactories.swap( tmpSet.mFactories );
-    tmpSet.mFactories.clear(); // prevent ~JFactorySet from deleting any factories
+    aFactorySet.mFactories.clear();
+    aFactorySet.mFactoriesFromString.clear();
+    aFactorySet.mFactoriesBySlot.clear();
+    aFactorySet.mUntrackedFactories.clear();
+    for (auto factory : duplicates) {
+        aFactorySet.Insert(factory);
+    }
+    while (dirty != nullptr) {
+        JFactory* next = dirty->mNextDirty;
+        dirty->mDirty = false;
+        dirty->MarkDirty();
+        dirty = next;
+    }
 }
 
 //---------------------------------
@@ -171,12 +214,21 @@ void JFactorySet::Print() const
     }
 }
 
-/// Release() loops over all contained factories, clearing their data
+/// Release() clears the data of every factory which has been marked dirty since the last Release(). Factories which
+/// the event never touched hold no data, so they are skipped, and the cost is proportional to the work done rather
+/// than to the number of factories. Events are recycled by a single thread, so nobody marks factories meanwhile.
+/// Factories which don't mark themselves dirty are always cleared.
 void JFactorySet::Release() {
 
-    for (const auto& sFactoryPair : mFactories) {
-        auto sFactory = sFactoryPair.second;
-        sFactory->ClearData();
+    JFactory* factory = mDirtyFactories.exchange(nullptr, std::memory_order_acquire);
+    while (factory != nullptr) {
+        JFactory* next = factory->mNextDirty;
+        factory->mDirty.store(false, std::memory_order_relaxed);
+        factory->ClearData();
+        factory = next;
+    }
+    for (auto untracked : mUntrackedFactories) {
+        untracked->ClearData();
     }
 }
 
@@ -5,9 +5,11 @@
 #ifndef _JFactorySet_h_
 #define _JFactorySet_h_
 
+#include <atomic>
 #include <string>
 #include <typeindex>
 #include <map>
+#include <vector>
 
 #include <JANA/JFactoryT.h>
 #include <JANA/Utils/JResettable.h>
@@ -38,36 +40,51 @@ class JFactorySet : public JResettable
         std::vector<JFactorySummary> Summarize() const;
 
     protected:
+        /// All factories for one object type, indexed by JTypeSlot. The untagged factory is by far
+        /// the most common lookup, so it gets its own field; the few tagged ones are scanned linearly.
+        struct TypeEntry {
+            JFactory* untagged = nullptr;
+            std::vector<std::pair<std::string, JFactory*>> tagged;
+        };
+
+        void Insert(JFactory* aFactory);
+        JFactory* FindBySlot(size_t slot, const std::string& tag) const;
+
         std::map<std::pair<std::type_index, std::string>, JFactory*> mFactories;        // {(typeid, tag) : factory}
         std::map<std::pair<std::string, std::string>, JFactory*> mFactoriesFromString;  // {(objname, tag) : factory}
+        std::vector<TypeEntry> mFactoriesBySlot;                                        // [slot] : {tag : factory}
+        std::atomic<JFactory*> mDirtyFactories {nullptr};                               // Intrusive list, see JFactory::MarkDirty
+        std::vector<JFactory*> mUntrackedFactories;                                     // Cleared by every Release(), see JFactory::mMarksDirty
 };
 
 
-template<typename T>
-JFactoryT<T>* JFactorySet::GetFactory(const std::string& tag) const {
-
-    auto typed_key = std::make_pair(std::type_index(typeid(T)), tag);
-    auto typed_iter = mFactories.find(typed_key);
-    if (typed_iter != std::end(mFactories)) {
-        return static_cast<JFactoryT<T>*>(typed_iter->second);
-    }
-
-    auto untyped_key = std::make_pair(JTypeInfo::demangle<T>(), tag);
-    auto untyped_iter = mFactoriesFromString.find(untyped_key);
-    if (untyped_iter != std::end(mFactoriesFromString)) {
-        return static_cast<JFactoryT<T>*>(untyped_iter->second);
+inline JFactory* JFactorySet::FindBySlot(size_t slot, const std::string& tag) const {
+    if (slot >= mFactoriesBySlot.size()) return nullptr;
+    const auto& entry = mFactoriesBySlot[slot];
+    if (tag.empty()) return entry.untagged;
+    for (const auto& pair : entry.tagged) {
+        if (pair.first == tag) return pair.second;
     }
     return nullptr;
 }
 
+
+template<typename T>
+JFactoryT<T>* JFactorySet::GetFactory(const std::string& tag) const {
+    return static_cast<JFactoryT<T>*>(FindBySlot(JTypeSlot::Get<T>(), tag));
+}
+
 template<typename T>
 std::vector<JFactoryT<T>*> JFactorySet::GetAllFactories() const {
-    auto sKey = std::type_index(typeid(T));
     std::vector<JFactoryT<T>*> data;
-    for (auto it=std::begin(mFactories);it!=std::end(mFactories);it++){
-        if (it->first.first==sKey){
-            data.push_back(static_cast<JFactoryT<T>*>(it->second));
-        }
+    auto slot = JTypeSlot::Get<T>();
+    if (slot >= mFactoriesBySlot.size()) return data;
+    const auto& entry = mFactoriesBySlot[slot];
+    if (entry.untagged != nullptr) {
+        data.push_back(static_cast<JFactoryT<T>*>(entry.untagged));
+    }
+    for (const auto& pair : entry.tagged) {
+        data.push_back(static_cast<JFactoryT<T>*>(pair.second));
     }
     return data;
 }
@@ -9,6 +9,7 @@
 #include <JANA/JFactory.h>
 #include <JANA/JObject.h>
 #include <JANA/Utils/JTypeInfo.h>
+#include <JANA/Utils/JArena.h>
 
 #ifdef HAVE_ROOT
 #include <TObject.h>
@@ -33,6 +34,7 @@ public:
     /// JFactoryT constructor requires a name and a tag.
     /// Name should always be JTypeInfo::demangle<T>(), tag is usually "".
     JFactoryT(const std::string& aName, const std::string& aTag) __attribute__ ((deprecated)) : JFactory(aName, aTag) {
+        mMarksDirty = true;
         EnableGetAs<T>();
         EnableGetAs<JObject>( std::is_convertible<T,JObject>() ); // Automatically add JObject if this can be converted to it
 #ifdef HAVE_ROOT
@@ -41,6 +43,7 @@ public:
     }
 
     JFactoryT(const std::string& aName) __attribute__ ((deprecated))  : JFactory(aName, "") {
+        mMarksDirty = true;
         EnableGetAs<T>();
         EnableGetAs<JObject>( std::is_convertible<T,JObject>() ); // Automatically add JObject if this can be converted to it
 #ifdef HAVE_ROOT
@@ -48,7 +51,8 @@ public:
 #endif
     }
 
-    JFactoryT() : JFactory(JTypeInfo::demangle<T>(), ""){
+    JFactoryT() : JFactory(JTypeInfo::demangle_cached<T>(), ""){
+        mMarksDirty = true;
         EnableGetAs<T>();
         EnableGetAs<JObject>( std::is_convertible<T,JObject>() ); // Automatically add JObject if this can be converted to it
 #ifdef HAVE_ROOT
@@ -64,11 +68,20 @@ public:
     void EndRun() override {}
     void Process(const std::shared_ptr<const JEvent>&) override {}
 
+    // Keep the non-owning overloads visible, see JFactory
+    using JFactory::BeginRun;
+    using JFactory::ChangeRun;
+    using JFactory::Process;
+
 
     std::type_index GetObjectType(void) const override {
         return std::type_index(typeid(T));
     }
 
+    size_t GetObjectTypeSlot(void) const override {
+        return JTypeSlot::Get<T>();
+    }
+
     std::size_t GetNumObjects(void) const override {
         return mData.size();
     }
@@ -77,9 +90,35 @@ public:
     /// ChangeRun(), and Process() methods. These include making sure the JFactory JApplication is set, Init() is called
     /// exactly once, exceptions are tagged with the originating plugin and eventsource, ChangeRun() is
     /// called if and only if the run number changes, etc.
+    /// The event is taken by reference, so that the (common) case where the data already exists doesn't touch the
+    /// event's refcount at all.
+    PairType GetOrCreate(const JEvent& event, JApplication* app, int32_t run_number) {
+        return GetOrCreateImpl(&event, app, run_number);
+    }
+
+    /// Kept for compatibility, please pass the event by reference instead
     PairType GetOrCreate(const std::shared_ptr<const JEvent>& event, JApplication* app, int32_t run_number) {
+        return GetOrCreateImpl(event.get(), app, run_number);
+    }
 
-        //std::lock_guard<std::mutex> lock(mMutex);
+    size_t Create(const std::shared_ptr<const JEvent>& event, JApplication* app, uint64_t run_number) final {
+        auto result = GetOrCreateImpl(event.get(), app, run_number);
+        return std::distance(result.first, result.second);
+    }
+
+private:
+    /// The event may only be null when it came in through the shared_ptr shim. The shared_ptr hooks then get
+    /// a null shared_ptr, as they always did.
+    PairType GetOrCreateImpl(const JEvent* event, JApplication* app, int32_t run_number) {
+
+        // With intra-event parallelism (see JTaskPool), several threads may ask for this factory's data at once.
+        // Once the data has been published, reading it costs a single acquire load. Until then, whoever takes
+        // the lock first computes it; everybody else waits for them and then reuses the result.
+        if (mDataReady.load(std::memory_order_acquire)) {
+            return std::make_pair(mData.cbegin(), mData.cend());
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        MarkDirty();
         if (mApp == nullptr) {
             mApp = app;
         }
@@ -103,37 +142,48 @@ public:
             case Status::Unprocessed:
                 if (mPreviousRunNumber == -1) {
                     // This is the very first run
-                    ChangeRun(event);
-                    BeginRun(event);
+                    CallChangeRun(event);
+                    CallBeginRun(event);
                     mPreviousRunNumber = run_number;
                 }
                 else if (mPreviousRunNumber != run_number) {
                     // This is a later run, and it has changed
                     EndRun();
-                    ChangeRun(event);
-                    BeginRun(event);
+                    CallChangeRun(event);
+                    CallBeginRun(event);
                     mPreviousRunNumber = run_number;
                 }
-                Process(event);
+                CallProcess(event);
                 mStatus = Status::Processed;
                 mCreationStatus = CreationStatus::Created;
             case Status::Processed:
             case Status::Inserted:
+                mDataReady.store(true, std::memory_order_release);
                 return std::make_pair(mData.cbegin(), mData.cend());
             default:
                 throw JException("Enum is set to a garbage value somehow");
         }
     }
 
-    size_t Create(const std::shared_ptr<const JEvent>& event, JApplication* app, uint64_t run_number) final {
-        auto result = GetOrCreate(event, app, run_number);
-        return std::distance(result.first, result.second);
+    void CallChangeRun(const JEvent* event) {
+        if (event != nullptr) ChangeRun(*event); else ChangeRun(std::shared_ptr<const JEvent>());
+    }
+    void CallBeginRun(const JEvent* event) {
+        if (event != nullptr) BeginRun(*event); else BeginRun(std::shared_ptr<const JEvent>());
+    }
+    void CallProcess(const JEvent* event) {
+        if (event != nullptr) Process(*event); else Process(std::shared_ptr<const JEvent>());
     }
 
+public:
+
 
     /// Please use the typed setters instead whenever possible
     void Set(const std::vector<JObject*>& aData) override {
+        mKeepArena = true;  // The new data may already live in the arena
         ClearData();
+        mKeepArena = false;
+        MarkDirty();
         for (auto jobj : aData) {
             T* casted = dynamic_cast<T*>(jobj);
             assert(casted != nullptr);
@@ -145,6 +195,7 @@ public:
     void Insert(JObject* aDatum) override {
         T* casted = dynamic_cast<T*>(aDatum);
         assert(casted != nullptr);
+        MarkDirty();
         mData.push_back(casted);
         mStatus = Status::Inserted;
         mCreationStatus = CreationStatus::Inserted;
@@ -152,25 +203,50 @@ public:
     }
 
     void Set(const std::vector<T*>& aData) {
+        mKeepArena = true;  // The new data may already live in the arena
         ClearData();
+        mKeepArena = false;
+        MarkDirty();
         mData = aData;
         mStatus = Status::Inserted;
         mCreationStatus = CreationStatus::Inserted;
     }
 
     void Set(std::vector<T*>&& aData) {
+        mKeepArena = true;  // The new data may already live in the arena
         ClearData();
+        mKeepArena = false;
+        MarkDirty();
         mData = std::move(aData);
         mStatus = Status::Inserted;
         mCreationStatus = CreationStatus::Inserted;
     }
 
     void Insert(T* aDatum) {
+        MarkDirty();
         mData.push_back(aDatum);
         mStatus = Status::Inserted;
         mCreationStatus = CreationStatus::Inserted;
     }
 
+    /// Construct creates a T which this factory will own once it is Insert()ed or Set(). Use it instead of `new T`.
+    /// If the USE_ARENA flag is set, the object lives in a per-factory arena. ClearData() then only runs destructors
+    /// and rewinds the arena, so a factory which produces many objects per event stops calling malloc/free after
+    /// the first few events. Without USE_ARENA, or if NOT_OBJECT_OWNER is set, this is plain `new T`.
+    template <typename... Args>
+    T* Construct(Args&&... args) {
+        if (!TestFactoryFlag(JFactory_Flags_t::USE_ARENA) || TestFactoryFlag(JFactory_Flags_t::NOT_OBJECT_OWNER)) {
+            return new T(std::forward<Args>(args)...);
+        }
+        if (mArena == nullptr) {
+            mArena.reset(new JArena);
+        }
+        return mArena->template Create<T>(std::forward<Args>(args)...);
+    }
+
+    /// Only meaningful when USE_ARENA is set. Returns nullptr if nothing has been Construct()ed yet.
+    const JArena* GetArena() const { return mArena.get(); }
+
 
     /// EnableGetAs generates a vtable entry so that users may extract the
     /// contents of this JFactoryT from the type-erased JFactory. The user has to manually specify which upcasts
@@ -197,9 +273,21 @@ public:
 
         // Assuming we _are_ the object owner, delete the underlying jobjects
         if (!TestFactoryFlag(JFactory_Flags_t::NOT_OBJECT_OWNER)) {
-            for (auto p : mData) delete p;
+            bool use_arena = (mArena != nullptr && !mArena->IsEmpty());
+            for (auto p : mData) {
+                if (use_arena && mArena->Owns(p)) {
+                    p->~T();
+                }
+                else {
+                    delete p;
+                }
+            }
+            if (use_arena && !mKeepArena) {
+                mArena->Reset();
+            }
         }
         mData.clear();
+        mDataReady.store(false, std::memory_order_relaxed);  // Events are recycled by a single thread
         mStatus = Status::Unprocessed;
         mCreationStatus = CreationStatus::NotCreatedYet;
     }
@@ -217,6 +305,8 @@ public:
 protected:
     std::vector<T*> mData;
     JMetadata<T> mMetadata;
+    std::unique_ptr<JArena> mArena;
+    bool mKeepArena = false;
 };
 
 template<typename T>
@@ -0,0 +1,51 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef _JSubeventProcessor_h_
+#define _JSubeventProcessor_h_
+
+#include <string>
+#include <vector>
+
+class JEvent;
+class JObject;
+
+/// JSubeventProcessor offers sub-event-level parallelism, for events which are made up of many independent
+/// pieces (e.g. thousands of hit clusters) and would otherwise pin a single core for a long time.
+///
+/// split() breaks a parent event into independent subevents. Each subevent is an arbitrary JObject created with
+/// `new`. The subevents are then handed out to as many workers as are free, which call process() on each of them.
+/// Once every subevent belonging to a parent has been processed, merge() receives them all at once, in the order
+/// split() produced them, and is expected to fold the results back into the parent, e.g. via JEvent::Insert().
+/// JANA deletes the subevent objects after merge() returns.
+///
+/// Bookkeeping travels with each subevent (see JSubevent), so the pipeline never blocks waiting for a particular
+/// event: subevents from different events interleave freely, and events are merged in whatever order they complete.
+///
+/// split() and process() are called concurrently from different threads, so they must not touch any shared state.
+/// merge() is only ever called from one thread at a time.
+///
+/// Register with JApplication::Add(). Multiple subevent processors run one after another, in the order they were
+/// added, before the event reaches the JEventProcessors.
+class JSubeventProcessor {
+
+public:
+    virtual ~JSubeventProcessor() = default;
+
+    virtual void split(JEvent& parent, std::vector<JObject*>& subevents) = 0;
+
+    virtual void process(JObject& subevent) = 0;
+
+    virtual void merge(JEvent& parent, std::vector<JObject*>& subevents) = 0;
+
+    std::string GetTypeName() const { return m_type_name; }
+
+    void SetTypeName(std::string type_name) { m_type_name = std::move(type_name); }
+
+private:
+    std::string m_type_name = "JSubeventProcessor";
+};
+
+
+#endif // _JSubeventProcessor_h_
@@ -0,0 +1,118 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef _JValueFactoryT_h_
+#define _JValueFactoryT_h_
+
+#include <JANA/JFactoryT.h>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/// JValueFactoryT<T> is a JFactoryT<T> which stores its objects by value, contiguously in a std::vector<T>,
+/// instead of as individually allocated T*'s. This is meant for plain data like ADC hits, where the per-object
+/// allocation and the pointer chase when iterating cost more than the work done on each object.
+///
+/// Consumers don't need to know the difference: JEvent::Get<T>() and friends still see a T* for every object.
+/// Hot loops can instead use JEvent::GetValues<T>() to iterate the dense array directly, or GetColumn() to
+/// gather a single member into a structure-of-arrays column.
+///
+/// Objects should be added using Emplace() or PushBack(). Objects which are Insert()ed as T* still work;
+/// they are owned the same way as in a plain JFactoryT, but they are not part of GetValues().
+template <typename T>
+class JValueFactoryT : public JFactoryT<T> {
+public:
+
+    JValueFactoryT() = default;
+    ~JValueFactoryT() override = default;
+
+    template <typename... Args>
+    T& Emplace(Args&&... args) {
+        const T* old_begin = mValues.data();
+        size_t old_size = mValues.size();
+        this->MarkDirty();
+        bool will_reallocate = (mValues.size() == mValues.capacity());
+        mValues.emplace_back(std::forward<Args>(args)...);
+        if (will_reallocate) {
+            Relocate(old_begin, old_size);
+        }
+        this->mData.push_back(&mValues.back());
+        this->mStatus = JFactory::Status::Inserted;
+        this->mCreationStatus = JFactory::CreationStatus::Inserted;
+        return mValues.back();
+    }
+
+    T& PushBack(const T& value) { return Emplace(value); }
+    T& PushBack(T&& value) { return Emplace(std::move(value)); }
+
+    /// Reserving up front (e.g. in Init()) avoids moving the objects around while the first events grow the storage.
+    void Reserve(size_t count) {
+        if (count <= mValues.capacity()) return;
+        const T* old_begin = mValues.data();
+        size_t old_size = mValues.size();
+        mValues.reserve(count);
+        Relocate(old_begin, old_size);
+    }
+
+    /// The dense array of by-value objects, in insertion order. Only valid once the factory has been processed.
+    const std::vector<T>& GetValues() const { return mValues; }
+
+    /// Gathers one member of every by-value object into a contiguous column, e.g. GetColumn(&Hit::adc, adcs).
+    /// The output vector is overwritten rather than reallocated, so reusing it across events is cheap.
+    template <typename F>
+    void GetColumn(F T::* member, std::vector<F>& column) const {
+        column.resize(mValues.size());
+        for (size_t i=0; i<mValues.size(); ++i) {
+            column[i] = mValues[i].*member;
+        }
+    }
+
+    template <typename F>
+    std::vector<F> GetColumn(F T::* member) const {
+        std::vector<F> column;
+        GetColumn(member, column);
+        return column;
+    }
+
+    void ClearData() override {
+
+        // Same preconditions as JFactoryT::ClearData(). Persistent data has to stay where it is.
+        if (this->mStatus == JFactory::Status::Uninitialized) {
+            return;
+        }
+        if (this->TestFactoryFlag(JFactory::PERSISTENT)) {
+            return;
+        }
+
+        // By-value objects are always ours. Anything else gets disposed of by JFactoryT as usual.
+        auto& data = this->mData;
+        data.erase(std::remove_if(data.begin(), data.end(), [this](const T* p){ return IsStoredByValue(p); }), data.end());
+        JFactoryT<T>::ClearData();
+        mValues.clear();  // Keeps the capacity, so steady-state events don't allocate
+    }
+
+protected:
+    std::vector<T> mValues;
+
+    /// mValues just reallocated, so every pointer we handed to mData has to move along with it
+    void Relocate(const T* old_begin, size_t old_size) {
+        std::less<const T*> before;
+        for (auto& p : this->mData) {
+            if (!before(p, old_begin) && before(p, old_begin + old_size)) {
+                p = mValues.data() + (p - old_begin);
+            }
+        }
+    }
+
+    bool IsStoredByValue(const T* p) const {
+        std::less<const T*> before;
+        const T* begin = mValues.data();
+        return !before(p, begin) && before(p, begin + mValues.size());
+    }
+};
+
+
+#endif // _JValueFactoryT_h_
@@ -5,6 +5,7 @@
 
 #include "JComponentManager.h"
 #include <JANA/JEventProcessor.h>
+#include <JANA/JSubeventProcessor.h>
 #include <JANA/JFactoryGenerator.h>
 
 JComponentManager::JComponentManager(JApplication* app) : m_app(app) {
@@ -18,6 +19,9 @@ JComponentManager::~JComponentManager() {
     for (auto* proc : m_evt_procs) {
         delete proc;
     }
+    for (auto* proc : m_subevt_procs) {
+        delete proc;
+    }
     for (auto* fac_gen : m_fac_gens) {
         delete fac_gen;
     }
@@ -64,6 +68,10 @@ void JComponentManager::add(JEventProcessor *processor) {
     m_evt_procs.push_back(processor);
 }
 
+void JComponentManager::add(JSubeventProcessor *processor) {
+    m_subevt_procs.push_back(processor);
+}
+
 void JComponentManager::configure_event(JEvent& event) {
     auto factory_set = new JFactorySet(m_fac_gens);
     event.SetFactorySet(factory_set);
@@ -177,6 +185,10 @@ std::vector<JEventProcessor*>& JComponentManager::get_evt_procs() {
     return m_evt_procs;
 }
 
+std::vector<JSubeventProcessor*>& JComponentManager::get_subevt_procs() {
+    return m_subevt_procs;
+}
+
 std::vector<JFactoryGenerator*>& JComponentManager::get_fac_gens() {
     return m_fac_gens;
 }
@@ -13,6 +13,7 @@
 #include <vector>
 
 class JEventProcessor;
+class JSubeventProcessor;
 
 class JComponentManager : public JService {
 public:
@@ -27,6 +28,7 @@ public:
     void add(JFactoryGenerator* factory_generator);
     void add(JEventSource* event_source);
     void add(JEventProcessor* processor);
+    void add(JSubeventProcessor* processor);
 
     void initialize();
     void resolve_event_sources();
@@ -39,6 +41,7 @@ public:
     std::vector<JEventSourceGenerator*>& get_evt_src_gens();
     std::vector<JEventSource*>& get_evt_srces();
     std::vector<JEventProcessor*>& get_evt_procs();
+    std::vector<JSubeventProcessor*>& get_subevt_procs();
     std::vector<JFactoryGenerator*>& get_fac_gens();
 
     void configure_event(JEvent& event);
@@ -56,6 +59,7 @@ private:
     std::vector<JFactoryGenerator*> m_fac_gens;
     std::vector<JEventSource*> m_evt_srces;
     std::vector<JEventProcessor*> m_evt_procs;
+    std::vector<JSubeventProcessor*> m_subevt_procs;
 
     std::map<std::string, std::string> m_default_tags;
     bool m_enable_call_graph_recording = false;
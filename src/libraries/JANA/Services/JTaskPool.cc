@@ -0,0 +1,133 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "JTaskPool.h"
+
+#include <JANA/Services/JParameterManager.h>
+
+#include <algorithm>
+
+
+JTaskPool::JTaskPool(bool enabled, size_t helper_thread_count)
+    : m_enabled(enabled)
+    , m_helper_thread_count(helper_thread_count) {
+}
+
+
+JTaskPool::~JTaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& thread : m_helper_threads) {
+        thread.join();
+    }
+}
+
+
+void JTaskPool::acquire_services(JServiceLocator* sl) {
+    auto params = sl->get<JParameterManager>();
+    params->SetDefaultParameter("jana:intraevent_parallelism", m_enabled,
+                                "Run independent work on the same event (e.g. prefetches, processors) concurrently");
+    params->SetDefaultParameter("jana:intraevent_threads", m_helper_thread_count,
+                                "Dedicated helper threads for intra-event parallelism, in addition to idle workers");
+
+    if (m_enabled) {
+        for (size_t i=0; i<m_helper_thread_count; ++i) {
+            m_helper_threads.emplace_back(&JTaskPool::helper_loop, this);
+        }
+    }
+}
+
+
+std::shared_ptr<JTaskPool::Group> JTaskPool::claim(size_t& index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_groups.empty()) {
+        auto group = m_groups.front();
+        index = group->next++;
+        if (index + 1 >= group->count) {
+            // Either we took the last task or there was none left. Either way, nobody else needs to look at this group.
+            m_groups.pop_front();
+        }
+        if (index < group->count) {
+            return group;
+        }
+    }
+    return nullptr;
+}
+
+
+void JTaskPool::run_task(Group& group, size_t index) {
+    try {
+        (*group.tasks)[index]();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        if (!group.error) group.error = std::current_exception();
+    }
+    if (--group.remaining == 0) {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        group.done_cv.notify_all();
+    }
+}
+
+
+bool JTaskPool::try_help() {
+    if (!m_enabled) return false;
+    size_t index;
+    auto group = claim(index);
+    if (group == nullptr) return false;
+    run_task(*group, index);
+    return true;
+}
+
+
+void JTaskPool::helper_loop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work_cv.wait(lock, [this](){ return m_stopping || !m_groups.empty(); });
+            if (m_stopping) return;
+        }
+        try_help();
+    }
+}
+
+
+void JTaskPool::run_all(const std::vector<std::function<void()>>& tasks) {
+
+    if (!m_enabled || tasks.size() < 2) {
+        for (auto& task : tasks) task();
+        return;
+    }
+
+    auto group = std::make_shared<Group>(&tasks);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_groups.push_back(group);
+    }
+    m_work_cv.notify_all();
+
+    // Work through our own tasks. We deliberately don't help other groups here: we might be inside a factory
+    // which another group's task is waiting on, and helping it from here would deadlock.
+    while (true) {
+        size_t index = group->next++;
+        if (index >= group->count) break;
+        run_task(*group, index);
+    }
+    {
+        // If we claimed the last task ourselves, our group is still queued. Nobody may look at it once we return.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find(m_groups.begin(), m_groups.end(), group);
+        if (it != m_groups.end()) m_groups.erase(it);
+    }
+    {
+        std::unique_lock<std::mutex> lock(group->mutex);
+        group->done_cv.wait(lock, [&](){ return group->remaining == 0; });
+    }
+    if (group->error) {
+        std::rethrow_exception(group->error);
+    }
+}
@@ -0,0 +1,79 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JTASKPOOL_H
+#define JANA2_JTASKPOOL_H
+
+#include <JANA/Services/JServiceLocator.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// JTaskPool provides intra-event parallelism: running several independent pieces of work on the _same_ event
+/// concurrently, e.g. JEventProcessorSequential's prefetches, or the processors attached to one JEventProcessorArrow.
+/// This only pays off when there are fewer events in flight than threads, e.g. large-event, low-rate calibration passes.
+///
+/// The thread calling run_all() always works through its own tasks, so run_all() never waits for a helper to
+/// become free. Helpers are JWorkers which are idle or backing off, plus `jana:intraevent_threads` dedicated threads.
+///
+/// There is no precomputed dependency graph. When two tasks need the same upstream factory, JFactoryT::GetOrCreate
+/// serializes them on that factory's mutex: one computes it, the other waits and then reuses the result.
+///
+/// Parameters:
+///   jana:intraevent_parallelism  Enables run_all() to hand out tasks at all. Default false, i.e. everything runs serially.
+///   jana:intraevent_threads      Number of dedicated helper threads, in addition to idle JWorkers. Default 0.
+class JTaskPool : public JService {
+
+private:
+    struct Group {
+        const std::vector<std::function<void()>>* tasks;  // Only valid while run_all() is on the stack
+        size_t count;
+        std::atomic<size_t> next {0};        // Index of the next unclaimed task
+        std::atomic<size_t> remaining;       // Number of tasks which haven't finished yet
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        std::exception_ptr error;
+
+        explicit Group(const std::vector<std::function<void()>>* tasks)
+            : tasks(tasks), count(tasks->size()), remaining(tasks->size()) {}
+    };
+
+    bool m_enabled = false;
+    size_t m_helper_thread_count = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::deque<std::shared_ptr<Group>> m_groups;   // Groups which still have unclaimed tasks
+    std::vector<std::thread> m_helper_threads;
+    bool m_stopping = false;
+
+    std::shared_ptr<Group> claim(size_t& index);
+    static void run_task(Group& group, size_t index);
+    void helper_loop();
+
+public:
+    explicit JTaskPool(bool enabled=false, size_t helper_thread_count=0);
+    ~JTaskPool() override;
+
+    void acquire_services(JServiceLocator* sl) override;
+
+    bool is_enabled() const { return m_enabled; }
+
+    /// Runs every task and returns once all of them have finished. If any task throws, the first exception is
+    /// rethrown here, after the remaining tasks have finished. When disabled, the tasks simply run in order.
+    void run_all(const std::vector<std::function<void()>>& tasks);
+
+    /// Runs one pending task from some other thread's run_all(), if there is one. Returns whether it did.
+    bool try_help();
+};
+
+
+#endif //JANA2_JTASKPOOL_H
@@ -0,0 +1,117 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JARENA_H
+#define JANA2_JARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/// JArena is a bump allocator for objects which all die at the same time, e.g. everything one JFactoryT
+/// produces for one event. Allocating is a pointer increment; freeing is Reset(), which rewinds to the
+/// start of the first chunk without returning any memory to the heap. Once an arena has grown to fit a
+/// typical event, it stops calling malloc altogether.
+///
+/// JArena never runs destructors. Whoever creates objects in it is responsible for destroying them
+/// before calling Reset(). JArena is not thread safe.
+class JArena {
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Chunk> m_chunks;
+    size_t m_current = 0;                  // Index of the chunk we are currently filling
+    size_t m_offset = 0;                   // Bytes used in the current chunk
+    size_t m_min_chunk_size;
+    size_t m_chunk_allocation_count = 0;
+
+    void* try_allocate_from_current(size_t size, size_t alignment) {
+        auto& chunk = m_chunks[m_current];
+        auto base = reinterpret_cast<uintptr_t>(chunk.data.get());
+        auto aligned = (base + m_offset + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        size_t new_offset = (aligned - base) + size;
+        if (new_offset > chunk.size) return nullptr;
+        m_offset = new_offset;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+public:
+    explicit JArena(size_t min_chunk_size = 64 * 1024) : m_min_chunk_size(min_chunk_size) {}
+
+    JArena(const JArena&) = delete;
+    JArena& operator=(const JArena&) = delete;
+
+    /// Returns uninitialized memory. alignment must be a power of two.
+    void* Allocate(size_t size, size_t alignment) {
+        while (m_current < m_chunks.size()) {
+            void* result = try_allocate_from_current(size, alignment);
+            if (result != nullptr) return result;
+            m_current += 1;
+            m_offset = 0;
+        }
+        // Chunks grow geometrically, so that an arena settles down after a handful of events
+        size_t chunk_size = std::max(m_min_chunk_size, size + alignment);
+        if (!m_chunks.empty()) chunk_size = std::max(chunk_size, 2 * m_chunks.back().size);
+        m_chunks.push_back({std::unique_ptr<char[]>(new char[chunk_size]), chunk_size});
+        m_chunk_allocation_count += 1;
+        m_current = m_chunks.size() - 1;
+        m_offset = 0;
+        return try_allocate_from_current(size, alignment);
+    }
+
+    template <typename T, typename... Args>
+    T* Create(Args&&... args) {
+        void* memory = Allocate(sizeof(T), alignof(T));
+        return ::new (memory) T(std::forward<Args>(args)...);
+    }
+
+    /// Makes all memory available again. Any objects still living in the arena must already be destroyed.
+    /// If the arena has grown past one chunk, its chunks are replaced by a single one which holds them all, so that
+    /// an arena which has settled down allocates from one chunk and Owns() is a single range check.
+    void Reset() {
+        if (m_chunks.size() > 1) {
+            size_t capacity = GetCapacity();
+            m_chunks.clear();
+            m_chunks.push_back({std::unique_ptr<char[]>(new char[capacity]), capacity});
+            m_chunk_allocation_count += 1;
+        }
+        m_current = 0;
+        m_offset = 0;
+    }
+
+    bool IsEmpty() const {
+        return m_current == 0 && m_offset == 0;
+    }
+
+    /// Only the chunks in use since the last Reset() are checked, which after the first few events is just one
+    bool Owns(const void* ptr) const {
+        auto p = reinterpret_cast<uintptr_t>(ptr);
+        for (size_t i=0; i<m_chunks.size() && i<=m_current; ++i) {
+            auto base = reinterpret_cast<uintptr_t>(m_chunks[i].data.get());
+            if (p >= base && p < base + m_chunks[i].size) return true;
+        }
+        return false;
+    }
+
+    /// Number of times this arena has gone to the heap for more memory
+    size_t GetChunkAllocationCount() const { return m_chunk_allocation_count; }
+
+    size_t GetCapacity() const {
+        size_t capacity = 0;
+        for (const auto& chunk : m_chunks) capacity += chunk.size;
+        return capacity;
+    }
+};
+
+
+#endif //JANA2_JARENA_H
@@ -8,16 +8,69 @@
 
 #include <sstream>
 #include <JANA/Compatibility/JStreamLog.h>
+#include <JANA/JException.h>
 #include <queue>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 using std::vector;
 using std::string;
 using std::endl;
 
+namespace {
+struct JInternedNames {
+    // Names live in fixed-size chunks which are never moved or freed, so that references handed out by
+    // GetInternedName stay valid, and so that GetInternedName can read them without taking the mutex.
+    // The mutex only serializes InternName, which runs once per factory type (see GetTypeNameId).
+    static constexpr size_t kChunkSize = 256;
+    static constexpr size_t kMaxChunks = 1024;
+    std::mutex mutex;
+    std::atomic<std::string*> chunks[kMaxChunks] = {};
+    size_t count = 0;
+    std::unordered_map<std::string, JCallGraphRecorder::NameId> ids;
+};
+
+JInternedNames& GetInternedNames() {
+    // Function-local so that it is safe to use from other static initializers
+    static JInternedNames interned_names;
+    return interned_names;
+}
+}
+
+JCallGraphRecorder::NameId JCallGraphRecorder::InternName(const std::string& name) {
+    auto& interned = GetInternedNames();
+    std::lock_guard<std::mutex> lock(interned.mutex);
+    auto it = interned.ids.find(name);
+    if (it != interned.ids.end()) return it->second;
+    size_t chunk_index = interned.count / JInternedNames::kChunkSize;
+    if (chunk_index >= JInternedNames::kMaxChunks) {
+        throw JException("JCallGraphRecorder: Too many interned names (limit=%zu)", JInternedNames::kChunkSize * JInternedNames::kMaxChunks);
+    }
+    std::string* chunk = interned.chunks[chunk_index].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new std::string[JInternedNames::kChunkSize];
+    }
+    auto id = static_cast<NameId>(interned.count);
+    chunk[interned.count % JInternedNames::kChunkSize] = name;
+    // Publishing the chunk after the name is written means any reader which sees the pointer also sees the name
+    interned.chunks[chunk_index].store(chunk, std::memory_order_release);
+    interned.count += 1;
+    interned.ids.emplace(name, id);
+    return id;
+}
+
+const std::string& JCallGraphRecorder::GetInternedName(NameId id) {
+    auto& interned = GetInternedNames();
+    std::string* chunk = interned.chunks[id / JInternedNames::kChunkSize].load(std::memory_order_acquire);
+    assert(chunk != nullptr);
+    return chunk[id % JInternedNames::kChunkSize];
+}
+
 void JCallGraphRecorder::Reset() {
     m_call_graph.clear();
-    m_call_stack.clear();
+    m_call_stacks.clear();
     m_error_call_stack.clear();
 }
 
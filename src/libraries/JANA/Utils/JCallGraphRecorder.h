@@ -8,8 +8,14 @@
 #include <vector>
 #include <string>
 #include <cassert>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <sys/time.h>
 
+#include <JANA/Utils/JTypeInfo.h>
+
 class JCallGraphRecorder {
 public:
     enum JDataSource {
@@ -32,8 +38,11 @@ public:
 	: caller_name(caller_name), caller_tag(caller_tag), callee_name(callee_name), callee_tag(callee_tag) {}
     };
 
+    /// Factory names are interned once per process, so that the call stack doesn't need to copy them around.
+    using NameId = uint32_t;
+
     struct JCallStackFrame {
-        std::string factory_name;
+        NameId factory_name_id = 0;
         std::string factory_tag;
         double start_time = 0;
     };
@@ -47,27 +56,39 @@ public:
 
 private:
     bool m_enabled = false;
-    std::vector<JCallStackFrame> m_call_stack;
+    std::mutex m_mutex;  // Only taken while recording. Factories may run on several threads at once, see JTaskPool
+    std::map<std::thread::id, std::vector<JCallStackFrame>> m_call_stacks;
     std::vector<JErrorCallStack> m_error_call_stack;
     std::vector<JCallGraphNode> m_call_graph;
 
 public:
     inline bool IsEnabled() const { return m_enabled; }
     inline void SetEnabled(bool recordingEnabled=true){ m_enabled = recordingEnabled; }
+    inline void StartFactoryCall(NameId callee_name_id, const std::string& callee_tag);
     inline void StartFactoryCall(const std::string& callee_name, const std::string& callee_tag);
     inline void FinishFactoryCall(JDataSource data_source=JDataSource::DATA_FROM_FACTORY);
     inline std::vector<JCallGraphNode> GetCallGraph() {return m_call_graph;} ///< Get the current factory call stack
-    inline void AddToCallGraph(const JCallGraphNode &cs) {if(m_enabled) m_call_graph.push_back(cs);} ///< Add specified item to call stack record but only if record_call_stack is true
+    inline void AddToCallGraph(const JCallGraphNode &cs) {if(m_enabled) {std::lock_guard<std::mutex> lock(m_mutex); m_call_graph.push_back(cs);}} ///< Add specified item to call stack record but only if record_call_stack is true
     inline void AddToErrorCallStack(const JErrorCallStack &cs) {if (m_enabled) m_error_call_stack.push_back(cs);} ///< Add layer to the factory call stack
     inline std::vector<JErrorCallStack> GetErrorCallStack(){return m_error_call_stack;} ///< Get the current factory error call stack
     void PrintErrorCallStack(); ///< Print the current factory call stack
     void Reset();
     std::vector<std::pair<std::string, std::string>> TopologicalSort() const;
+
+    static NameId InternName(const std::string& name); ///< Look up (or assign) the id for a factory name. Takes a lock.
+    static const std::string& GetInternedName(NameId id); ///< Returned reference stays valid forever. Lock-free.
+
+    /// Id of the demangled name of T. This is looked up once per type, so it is cheap enough to call on every Get().
+    template <typename T>
+    static NameId GetTypeNameId() {
+        static const NameId id = InternName(JTypeInfo::demangle_cached<T>());
+        return id;
+    }
 };
 
 
 
-void JCallGraphRecorder::StartFactoryCall(const std::string& callee_name, const std::string& callee_tag) {
+void JCallGraphRecorder::StartFactoryCall(NameId callee_name_id, const std::string& callee_tag) {
 
     /// This is used to fill initial info into a call_stack_t stucture
     /// for recording the call stack. It should be matched with a call
@@ -80,10 +101,20 @@ void JCallGraphRecorder::StartFactoryCall(const std::string& callee_name, const
     getitimer(ITIMER_PROF, &tmr);
     double start_time = tmr.it_value.tv_sec + tmr.it_value.tv_usec / 1.0E6;
     JCallStackFrame frame;
-    frame.factory_name = callee_name;
+    frame.factory_name_id = callee_name_id;
     frame.factory_tag = callee_tag;
     frame.start_time = start_time;
-    m_call_stack.push_back(frame);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_call_stacks[std::this_thread::get_id()].push_back(frame);
+}
+
+
+void JCallGraphRecorder::StartFactoryCall(const std::string& callee_name, const std::string& callee_tag) {
+
+    /// Variant for callers which only have the factory name as a string. Prefer the NameId version on hot paths.
+
+    if (!m_enabled) return;
+    StartFactoryCall(InternName(callee_name), callee_tag);
 }
 
 
@@ -94,26 +125,28 @@ void JCallGraphRecorder::FinishFactoryCall(JCallGraphRecorder::JDataSource data_
     /// used to fill the cs structure.
 
     if (!m_enabled) return;
-    assert(!m_call_stack.empty());
 
     struct itimerval tmr;
     getitimer(ITIMER_PROF, &tmr);
     double end_time = tmr.it_value.tv_sec + tmr.it_value.tv_usec/1.0E6;
 
-    JCallStackFrame& callee_frame = m_call_stack.back();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& call_stack = m_call_stacks[std::this_thread::get_id()];
+    assert(!call_stack.empty());
+    JCallStackFrame& callee_frame = call_stack.back();
 
     JCallGraphNode node;
-    node.callee_name = callee_frame.factory_name;
+    node.callee_name = GetInternedName(callee_frame.factory_name_id);
     node.callee_tag = callee_frame.factory_tag;
     node.start_time = callee_frame.start_time;
     node.end_time = end_time;
     node.data_source = data_source;
 
-    m_call_stack.pop_back();
+    call_stack.pop_back();
 
-    if (!m_call_stack.empty()) {
-        JCallStackFrame& caller_frame = m_call_stack.back();
-        node.caller_name = caller_frame.factory_name;
+    if (!call_stack.empty()) {
+        JCallStackFrame& caller_frame = call_stack.back();
+        node.caller_name = GetInternedName(caller_frame.factory_name_id);
         node.caller_tag = caller_frame.factory_tag;
         m_call_graph.push_back(node);
     }
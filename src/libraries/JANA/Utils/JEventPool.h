@@ -9,6 +9,17 @@
 #include <JANA/JEvent.h>
 #include <JANA/JFactoryGenerator.h>
 #include <JANA/Services/JComponentManager.h>
+#include <JANA/Utils/JProcessorMapping.h>
+#include <JANA/Utils/JCpuInfo.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <numeric>
+#include <thread>
 
 class JEventPool {
 private:
@@ -16,37 +27,105 @@ private:
     struct alignas(64) LocalPool {
         std::mutex mutex;
         std::vector<std::shared_ptr<JEvent>> events;
+        size_t capacity = 0;
+
+        /// Before C++17, new[] ignores the cache line alignment, so the array gets aligned storage like JRingBuffer
+        static void* operator new[](size_t size) {
+            void* ptr = nullptr;
+            if (posix_memalign(&ptr, alignof(LocalPool), size) != 0) {
+                throw std::bad_alloc();
+            }
+            return ptr;
+        }
+
+        static void operator delete[](void* ptr) {
+            free(ptr);
+        }
     };
 
     std::shared_ptr<JComponentManager> m_component_manager;
-    size_t m_pool_size;
+    size_t m_pool_size;  // Summed over all locations
     size_t m_location_count;
     bool m_limit_total_events_in_flight;
     std::unique_ptr<LocalPool[]> m_pools;
+    std::atomic<size_t> m_available_count {0};  // Events sitting in any location's pool
+    std::atomic<size_t> m_factory_set_build_count {0};
+
+    inline std::shared_ptr<JEvent> create_event(size_t location) {
+        auto event = std::make_shared<JEvent>();
+        m_component_manager->configure_event(*event);
+        event->mPoolLocation = location % m_location_count;
+        event->mHasPoolLocation = true;
+        return event;
+    }
+
+    inline void fill_location(size_t location) {
+        for (size_t i=0; i<m_pools[location].capacity; ++i) {
+            auto event = create_event(location);
+            put(event, location);
+        }
+    }
 
 public:
+
+    /// pool_size is the number of events per location
     inline JEventPool(std::shared_ptr<JComponentManager> component_manager,
                       size_t pool_size,
                       size_t location_count,
-                      bool limit_total_events_in_flight)
+                      bool limit_total_events_in_flight,
+                      const JProcessorMapping* mapping = nullptr)
+        : JEventPool(component_manager, std::vector<size_t>(location_count, pool_size), limit_total_events_in_flight, mapping) {}
+
+    /// Each location may hold a different number of events, e.g. when the total doesn't divide evenly.
+    /// If a mapping is provided and there is more than one location, each location's events are
+    /// constructed and configured on a temporary thread pinned to a cpu belonging to that location.
+    /// This way the first touch of each event (and its JFactorySet) happens on the right NUMA domain.
+    inline JEventPool(std::shared_ptr<JComponentManager> component_manager,
+                      const std::vector<size_t>& location_pool_sizes,
+                      bool limit_total_events_in_flight,
+                      const JProcessorMapping* mapping = nullptr)
         : m_component_manager(component_manager)
-        , m_pool_size(pool_size)
-        , m_location_count(location_count)
+        , m_pool_size(std::accumulate(location_pool_sizes.begin(), location_pool_sizes.end(), size_t(0)))
+        , m_location_count(location_pool_sizes.size())
         , m_limit_total_events_in_flight(limit_total_events_in_flight)
     {
         assert(m_location_count >= 1);
-        m_pools = std::unique_ptr<LocalPool[]>(new LocalPool[location_count]());
+        m_pools = std::unique_ptr<LocalPool[]>(new LocalPool[m_location_count]());
+        for (size_t j=0; j<m_location_count; ++j) {
+            m_pools[j].capacity = location_pool_sizes[j];
+        }
+
+        bool pin = (mapping != nullptr && mapping->is_initialized() && m_location_count > 1);
 
         for (size_t j=0; j<m_location_count; ++j) {
-            for (size_t i=0; i<m_pool_size; ++i) {
-                auto event = std::make_shared<JEvent>();
-                m_component_manager->configure_event(*event);
-                put(event, j);
+            if (!pin) {
+                fill_location(j);
+                continue;
             }
+            // Locations are filled one at a time, because user-provided factory generators
+            // are not required to be thread safe. The worker thread waits until it has been pinned
+            // before it allocates anything.
+            std::promise<void> pinned;
+            std::shared_future<void> ready = pinned.get_future().share();
+            std::exception_ptr error;
+            std::thread filler([this, j, ready, &error](){
+                ready.wait();
+                try {
+                    fill_location(j);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            });
+            JCpuInfo::PinThreadToCpu(&filler, mapping->get_loc_cpu_id(j));
+            pinned.set_value();
+            filler.join();
+            if (error) std::rethrow_exception(error);
         }
     }
 
-    inline std::shared_ptr<JEvent> get(size_t location) {
+    /// If recycle_time is given, the time spent clearing a reused event's factories and bookkeeping is added to it.
+    inline std::shared_ptr<JEvent> get(size_t location, std::chrono::steady_clock::duration* recycle_time = nullptr) {
 
         LocalPool& pool = m_pools[location % m_location_count];
         std::lock_guard<std::mutex> lock(pool.mutex);
@@ -56,32 +135,117 @@ public:
                 return nullptr;
             }
             else {
-                auto event = std::make_shared<JEvent>();
-                m_component_manager->configure_event(*event);
-                return event;
+                return create_event(location);
             }
         }
         else {
             auto event = std::move(pool.events.back());
             pool.events.pop_back();
+            m_available_count -= 1;
+            auto start_time = (recycle_time != nullptr) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
             event->mFactorySet->Release();
             event->mInspector.Reset();
             event->GetJCallGraphRecorder()->Reset();
+            if (recycle_time != nullptr) {
+                *recycle_time += std::chrono::steady_clock::now() - start_time;
+            }
             return event;
         }
     }
 
+    /// put() always returns an event to the location it was created on, so that events stay local to
+    /// their NUMA domain even when a worker on a different location (e.g. via work stealing) finishes them.
+    /// The location argument only matters for events which did not originate from this pool.
     inline void put(std::shared_ptr<JEvent>& event, size_t location) {
 
+        if (event->mHasPoolLocation) {
+            location = event->mPoolLocation;
+        }
         LocalPool& pool = m_pools[location % m_location_count];
         std::lock_guard<std::mutex> lock(pool.mutex);
 
-        if (pool.events.size() < m_pool_size) {
+        if (pool.events.size() < pool.capacity) {
             pool.events.push_back(std::move(event));
+            m_available_count += 1;
         }
     }
 
+    /// Whether get() could hand out an event right now, on some location. This is only a snapshot, meant for
+    /// telling the scheduler that a source has nothing to fill until somebody put()s an event back.
+    inline bool has_available_events() const {
+        return !m_limit_total_events_in_flight || m_available_count != 0;
+    }
+
+    /// Gives the event the factory set that belongs to source, i.e. the source's own factories on top of the default
+    /// ones. An event keeps one factory set per source it has come from, so only the first event from each source
+    /// builds one, and after that, switching sources just swaps pointers. Sets which belong to sources that have
+    /// finished are freed. The event must have been released already.
+    inline void switch_source(JEvent& event, JEventSource* source) {
+
+        if (event.mEventSource == source) return;
+        auto& inactive = event.mInactiveFactorySets;
+
+        // A finished source won't emit any more events, so the sets cached for it are dropped instead of piling up
+        // when many sources are opened one after another over the course of a run
+        inactive.erase(std::remove_if(inactive.begin(), inactive.end(), [](const std::pair<JEventSource*, JFactorySet*>& p){
+            if (p.first->GetStatus() != JEventSource::SourceStatus::Finished) return false;
+            p.second->Release();
+            delete p.second;
+            return true;
+        }), inactive.end());
+
+        auto cached = std::find_if(inactive.begin(), inactive.end(), [source](const std::pair<JEventSource*, JFactorySet*>& p){
+            return p.first == source;
+        });
+        auto source_gen = source->GetFactoryGenerator();
+
+        if (cached != inactive.end()) {
+            std::swap(cached->first, event.mEventSource);
+            std::swap(cached->second, event.mFactorySet);
+            if (cached->first->GetStatus() == JEventSource::SourceStatus::Finished) {
+                cached->second->Release();
+                delete cached->second;
+                inactive.erase(cached);
+            }
+        }
+        else if (event.mEventSource == nullptr && source_gen == nullptr) {
+            // The factory set from configure_event() is exactly what this source needs
+            event.mEventSource = source;
+        }
+        else {
+            auto factory_set = new JFactorySet();
+            if (source_gen != nullptr) {
+                source_gen->GenerateFactories(factory_set);
+            }
+            if (event.mEventSource == nullptr) {
+                // Nobody has claimed the factory set from configure_event() yet, so we can take its factories
+                factory_set->Merge(*event.mFactorySet);
+                delete event.mFactorySet;  // Only the factories which the source overrides are left in it
+            }
+            else {
+                JFactorySet defaults(m_component_manager->get_fac_gens());
+                factory_set->Merge(defaults);
+                if (event.mEventSource->GetStatus() == JEventSource::SourceStatus::Finished) {
+                    event.mFactorySet->Release();
+                    delete event.mFactorySet;
+                }
+                else {
+                    inactive.emplace_back(event.mEventSource, event.mFactorySet);
+                }
+            }
+            event.mFactorySet = factory_set;
+            event.mEventSource = source;
+            m_factory_set_build_count += 1;
+        }
+    }
+
+    /// How many factory sets switch_source() had to build. This should stop growing once every event has been
+    /// emitted by every source.
+    inline size_t get_factory_set_build_count() const { return m_factory_set_build_count; }
+
     inline size_t size() { return m_pool_size; }
+
+    inline size_t get_location_count() { return m_location_count; }
 };
 
 
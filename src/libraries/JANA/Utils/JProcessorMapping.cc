@@ -102,6 +102,57 @@ void JProcessorMapping::initialize(AffinityStrategy affinity, LocalityStrategy l
     m_initialized = true;
 }
 
+size_t JProcessorMapping::get_loc_cpu_id(size_t loc_id) const {
+    for (const Row& row : m_mapping) {
+        if (row.location_id == loc_id) return row.cpu_id;
+    }
+    return 0;
+}
+
+std::vector<std::vector<size_t>> JProcessorMapping::get_neighbor_tiers(size_t loc_id) const {
+
+    std::vector<std::vector<size_t>> tiers(4);
+    if (!m_initialized) {
+        // Without topology information, all locations are equally far apart
+        for (size_t other=0; other<m_loc_count; ++other) {
+            if (other != loc_id) tiers[3].push_back(other);
+        }
+    }
+    else {
+        // Each location is represented by the first cpu we find belonging to it
+        std::vector<const Row*> representatives(m_loc_count, nullptr);
+        for (const Row& row : m_mapping) {
+            if (representatives[row.location_id] == nullptr) {
+                representatives[row.location_id] = &row;
+            }
+        }
+        const Row* self = (loc_id < m_loc_count) ? representatives[loc_id] : nullptr;
+        for (size_t other=0; other<m_loc_count; ++other) {
+            const Row* rep = representatives[other];
+            if (other == loc_id || rep == nullptr) continue;
+            if (self == nullptr) {
+                tiers[3].push_back(other);
+            }
+            else if (rep->core_id == self->core_id && rep->socket_id == self->socket_id) {
+                tiers[0].push_back(other);
+            }
+            else if (rep->numa_domain_id == self->numa_domain_id) {
+                tiers[1].push_back(other);
+            }
+            else if (rep->socket_id == self->socket_id) {
+                tiers[2].push_back(other);
+            }
+            else {
+                tiers[3].push_back(other);
+            }
+        }
+    }
+    tiers.erase(std::remove_if(tiers.begin(), tiers.end(),
+                               [](const std::vector<size_t>& tier) { return tier.empty(); }),
+                tiers.end());
+    return tiers;
+}
+
 std::ostream& operator<<(std::ostream& os, const JProcessorMapping::AffinityStrategy& s) {
     switch (s) {
         case JProcessorMapping::AffinityStrategy::ComputeBound: os << "compute-bound (favor fewer hyperthreads)"; break;
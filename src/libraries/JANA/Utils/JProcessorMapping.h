@@ -30,6 +30,19 @@ public:
         return (m_initialized) ? m_mapping[worker_id % m_mapping.size()].location_id : 0;
     }
 
+    inline bool is_initialized() const {
+        return m_initialized;
+    }
+
+    /// get_loc_cpu_id() returns some cpu belonging to loc_id, so that a thread pinned to it will first-touch
+    /// memory on that location's NUMA domain. Only meaningful if is_initialized().
+    size_t get_loc_cpu_id(size_t loc_id) const;
+
+    /// get_neighbor_tiers() lists the other locations grouped by distance from loc_id, nearest first:
+    /// those sharing a core, then those sharing a NUMA domain, then those sharing a socket, then everything else.
+    /// Empty tiers are omitted. This is meant for configuring work stealing between JMailbox locations.
+    std::vector<std::vector<size_t>> get_neighbor_tiers(size_t loc_id) const;
+
     inline AffinityStrategy get_affinity() const {
         return m_affinity_strategy;
     }
@@ -0,0 +1,211 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JREADAHEAD_H
+#define JANA2_JREADAHEAD_H
+
+#include <JANA/Services/JParameterManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// JReadAhead reads raw records on a background thread, so that a JEventSource doesn't have to wait on its disk or
+/// network inside GetEvent(). Up to `depth` filled records (and optionally no more than `max_bytes_in_flight` bytes)
+/// are kept ready. Buffers are handed back via Recycle() and reused, so that steady-state reading doesn't allocate.
+///
+/// A JEventSource owns one JReadAhead per input. It calls Start() from Open() and Stop() from Close(), _before_
+/// closing the file, since the reader callback may still be using it until then. GetEvent() looks like this:
+///
+///     std::unique_ptr<Record> record;
+///     switch (m_readahead.TryPop(record)) {
+///         case JReadAhead<Record>::Status::NotReady: throw RETURN_STATUS::kBUSY;
+///         case JReadAhead<Record>::Status::Finished: throw RETURN_STATUS::kNO_MORE_EVENTS;
+///         case JReadAhead<Record>::Status::Ready: break;
+///     }
+///     event->Insert(...);  // Copy out whatever the event needs
+///     m_readahead.Recycle(std::move(record));
+///
+/// Records come out in the order they were read. TryPop() is thread-safe, so this also works with
+/// EnableParallelGetEvent(). An exception thrown by the reader is rethrown from TryPop().
+template <typename RecordT>
+class JReadAhead {
+
+public:
+    enum class Status { Ready, NotReady, Finished };
+
+    /// Fills the record (which may be a recycled one) and returns true, or returns false once the input is exhausted
+    using Reader = std::function<bool(RecordT&)>;
+
+    /// Returns the size of a filled record in bytes, for bounding the bytes in flight
+    using Sizer = std::function<size_t(const RecordT&)>;
+
+    struct Metrics {
+        size_t records_read = 0;
+        size_t bytes_read = 0;
+        size_t records_in_flight = 0;      // Filled, but not popped yet
+        size_t bytes_in_flight = 0;
+        size_t max_records_in_flight = 0;
+        size_t max_bytes_in_flight = 0;
+        size_t buffers_allocated = 0;
+        size_t consumer_stalls = 0;        // TryPop() found nothing ready: the input can't keep up
+        size_t reader_stalls = 0;          // The reader found no room: processing can't keep up
+        double read_time_s = 0;            // Time spent inside the reader
+    };
+
+private:
+    Reader m_reader;
+    Sizer m_sizer;
+    size_t m_depth = 8;
+    size_t m_max_bytes_in_flight = 0;      // 0 means unbounded
+
+    std::mutex m_mutex;
+    std::condition_variable m_reader_cv;
+    std::deque<std::pair<std::unique_ptr<RecordT>, size_t>> m_filled;
+    std::vector<std::unique_ptr<RecordT>> m_free;
+    bool m_stop_requested = false;
+    bool m_exhausted = false;
+    std::exception_ptr m_error;
+    Metrics m_metrics;
+    std::thread m_thread;
+
+public:
+    explicit JReadAhead(Reader reader, Sizer sizer = nullptr)
+        : m_reader(std::move(reader)), m_sizer(std::move(sizer)) {}
+
+    ~JReadAhead() { Stop(); }
+
+    JReadAhead(const JReadAhead&) = delete;
+    JReadAhead& operator=(const JReadAhead&) = delete;
+
+    void SetDepth(size_t depth) { m_depth = (depth == 0) ? 1 : depth; }
+    void SetMaxBytesInFlight(size_t max_bytes) { m_max_bytes_in_flight = max_bytes; }
+
+    /// Registers the `<prefix>:readahead_depth` and `<prefix>:readahead_max_bytes` parameters, e.g. from Open()
+    void Configure(JParameterManager* params, const std::string& prefix) {
+        params->SetDefaultParameter(prefix + ":readahead_depth", m_depth,
+                                    "Number of records to read ahead on a background thread");
+        params->SetDefaultParameter(prefix + ":readahead_max_bytes", m_max_bytes_in_flight,
+                                    "Max bytes of records read ahead but not yet consumed. 0 means unbounded");
+        SetDepth(m_depth);
+    }
+
+    void Start() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_thread.joinable()) return;
+        m_stop_requested = false;
+        m_thread = std::thread(&JReadAhead::Run, this);
+    }
+
+    /// Waits for the reader to return from its current record. Unconsumed records are kept.
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop_requested = true;
+        }
+        m_reader_cv.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    Status TryPop(std::unique_ptr<RecordT>& record) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_filled.empty()) {
+            record = std::move(m_filled.front().first);
+            m_metrics.bytes_in_flight -= m_filled.front().second;
+            m_filled.pop_front();
+            m_metrics.records_in_flight = m_filled.size();
+            lock.unlock();
+            m_reader_cv.notify_one();
+            return Status::Ready;
+        }
+        if (m_error != nullptr) {
+            std::rethrow_exception(m_error);
+        }
+        if (m_exhausted) {
+            return Status::Finished;
+        }
+        m_metrics.consumer_stalls += 1;
+        return Status::NotReady;
+    }
+
+    void Recycle(std::unique_ptr<RecordT> record) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.size() < m_depth) {
+            m_free.push_back(std::move(record));
+        }
+    }
+
+    Metrics GetMetrics() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_metrics;
+    }
+
+private:
+    bool HasRoom() const {
+        return m_filled.size() < m_depth &&
+               (m_max_bytes_in_flight == 0 || m_metrics.bytes_in_flight < m_max_bytes_in_flight);
+    }
+
+    void Run() {
+        while (true) {
+            std::unique_ptr<RecordT> record;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (!m_stop_requested && !HasRoom()) {
+                    m_metrics.reader_stalls += 1;
+                    m_reader_cv.wait(lock, [&](){ return m_stop_requested || HasRoom(); });
+                }
+                if (m_stop_requested || m_exhausted) return;
+                if (!m_free.empty()) {
+                    record = std::move(m_free.back());
+                    m_free.pop_back();
+                }
+            }
+            if (record == nullptr) {
+                record.reset(new RecordT());
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_metrics.buffers_allocated += 1;
+            }
+
+            auto start_time = std::chrono::steady_clock::now();
+            bool success = false;
+            size_t size = 0;
+            std::exception_ptr error;
+            try {
+                success = m_reader(*record);
+                if (success && m_sizer) size = m_sizer(*record);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            auto read_time = std::chrono::steady_clock::now() - start_time;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_metrics.read_time_s += std::chrono::duration<double>(read_time).count();
+            if (!success) {
+                m_error = error;
+                m_exhausted = true;
+                m_free.push_back(std::move(record));
+                return;
+            }
+            m_filled.emplace_back(std::move(record), size);
+            m_metrics.records_read += 1;
+            m_metrics.bytes_read += size;
+            m_metrics.bytes_in_flight += size;
+            m_metrics.records_in_flight = m_filled.size();
+            m_metrics.max_records_in_flight = std::max(m_metrics.max_records_in_flight, m_filled.size());
+            m_metrics.max_bytes_in_flight = std::max(m_metrics.max_bytes_in_flight, m_metrics.bytes_in_flight);
+        }
+    }
+};
+
+#endif //JANA2_JREADAHEAD_H
@@ -40,11 +40,6 @@
  *
  **********************************************************************************************************************/
 
-// Apple compiler does not currently support alignas. Make this an empty definition if it is not already defined.
-#ifndef alignas
-#define alignas(A)
-#endif
-
 template <typename DType> class JResourcePool
 {
     //TYPE TRAIT REQUIREMENTS
@@ -0,0 +1,133 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JRINGBUFFER_H
+#define JANA2_JRINGBUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+
+#ifndef CACHE_LINE_BYTES
+#define CACHE_LINE_BYTES 64
+#endif
+
+/// JRingBuffer is a bounded, lock-free, multi-producer multi-consumer queue.
+/// It is the storage behind JMailbox's LockFree backend, but is usable on its own.
+///
+/// Each slot carries a sequence number which tells producers and consumers whose turn it is:
+///   - sequence == pos       => slot is empty and may be written by the producer who claims pos
+///   - sequence == pos + 1   => slot is full and may be read by the consumer who claims pos
+/// Producers and consumers claim positions by CAS on m_tail and m_head respectively. These two
+/// counters live on separate cache lines so that producers and consumers don't false-share.
+///
+/// try_push() and try_pop() never block. They return false when the buffer is full or empty.
+///
+/// \tparam T must be default-constructible and moveable. Usually this is shared_ptr<JEvent>.
+template <typename T>
+class JRingBuffer {
+
+private:
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_tail;    // Next position to push to
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_head;    // Next position to pop from
+    alignas(CACHE_LINE_BYTES) size_t m_capacity;
+    size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+public:
+
+    /// capacity is rounded up to the next power of two, so that wrapping around is a bitmask
+    explicit JRingBuffer(size_t capacity) : m_tail(0), m_head(0) {
+        m_capacity = 2;
+        while (m_capacity < capacity) m_capacity <<= 1;
+        m_mask = m_capacity - 1;
+        m_slots = std::unique_ptr<Slot[]>(new Slot[m_capacity]);
+        for (size_t i=0; i<m_capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    JRingBuffer(const JRingBuffer&) = delete;
+    JRingBuffer& operator=(const JRingBuffer&) = delete;
+
+    /// Before C++17, a plain new-expression ignores the cache line alignment of m_tail and m_head,
+    /// which would let them false-share after all. So heap-allocated JRingBuffers get aligned storage.
+    static void* operator new(size_t size) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, alignof(JRingBuffer), size) != 0) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    static void operator delete(void* ptr) {
+        free(ptr);
+    }
+
+    bool try_push(T& item) {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[pos & m_mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.item = std::move(item);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+                // CAS failure reloads pos, so we simply retry
+            }
+            else if (diff < 0) {
+                return false;  // Buffer is full
+            }
+            else {
+                pos = m_tail.load(std::memory_order_relaxed);  // Somebody beat us to it
+            }
+        }
+    }
+
+    bool try_pop(T& item) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[pos & m_mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(slot.item);
+                    slot.item = T();  // Don't keep a stale copy alive (matters for shared_ptr)
+                    slot.sequence.store(pos + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;  // Buffer is empty
+            }
+            else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// size() is only a snapshot. It is exact when no pushes or pops are in flight.
+    size_t size() const {
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        return (tail > head) ? (tail - head) : 0;
+    }
+
+    size_t capacity() const { return m_capacity; }
+};
+
+
+#endif //JANA2_JRINGBUFFER_H
@@ -25,6 +25,15 @@ std::string demangle(void) {
     return type;
 }
 
+template<typename T>
+const std::string& demangle_cached(void) {
+
+    /// Same as demangle<T>(), but computed once per type and cached for the lifetime of the process.
+    /// Prefer this on hot paths, since __cxa_demangle allocates on every call.
+    static const std::string type = demangle<T>();
+    return type;
+}
+
 
 /// Macro for conveniently turning a variable name into a string. This is used by JObject::Summarize
 /// in order to play nicely with refactoring tools. Because the symbol is picked up by the
@@ -0,0 +1,20 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "JTypeSlot.h"
+
+#include <mutex>
+#include <unordered_map>
+
+size_t JTypeSlot::Get(const std::type_index& type) {
+    static std::mutex mutex;
+    static std::unordered_map<std::type_index, size_t> slots;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = slots.find(type);
+    if (it != slots.end()) return it->second;
+    size_t slot = slots.size();
+    slots.emplace(type, slot);
+    return slot;
+}
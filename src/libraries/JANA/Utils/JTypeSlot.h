@@ -0,0 +1,30 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#ifndef JANA2_JTYPESLOT_H
+#define JANA2_JTYPESLOT_H
+
+#include <cstddef>
+#include <typeindex>
+
+/// JTypeSlot hands out a small, dense integer for each type, so that per-type tables can be flat vectors
+/// instead of maps keyed on std::type_index. Slots are assigned on first use and never change for the
+/// lifetime of the process. The registry is keyed on std::type_index, so a type reached from different plugins
+/// only gets the same slot if its std::type_info compares equal across those shared objects. That requires the
+/// type's RTTI to be exported (default visibility, as JANA and its plugins are built); otherwise each plugin
+/// gets a slot of its own for the type.
+class JTypeSlot {
+public:
+    /// Looks up (or assigns) the slot for a runtime type. This takes a lock, so avoid it on hot paths.
+    static size_t Get(const std::type_index& type);
+
+    /// Compile-time variant. After the first call for a given T, this is a single static load.
+    template <typename T>
+    static size_t Get() {
+        static const size_t slot = Get(std::type_index(typeid(T)));
+        return slot;
+    }
+};
+
+#endif //JANA2_JTYPESLOT_H
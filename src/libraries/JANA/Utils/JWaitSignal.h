@@ -0,0 +1,80 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef JANA2_JWAITSIGNAL_H
+#define JANA2_JWAITSIGNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/// Tells the cpu that we are in a spin-wait loop, so that it can back off the pipeline
+/// (and let a hyperthread sibling run) without giving up the core.
+inline void JCpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+
+/// JWaitSignal lets a thread wait for 'something happened', e.g. an item was pushed to a JMailbox.
+///
+/// The waiter reads get_epoch() _before_ checking whatever condition it is waiting on, and then passes
+/// that epoch to wait_for(). Any notify() which happens after the epoch was read makes wait_for() return
+/// immediately, so no notification can get lost in between.
+///
+/// notify() is cheap when nobody is waiting: one atomic increment and one atomic load, no mutex.
+class JWaitSignal {
+
+private:
+    std::atomic<uint64_t> m_epoch {0};
+    std::atomic<size_t> m_waiter_count {0};
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+public:
+
+    uint64_t get_epoch() const { return m_epoch.load(); }
+
+    bool has_changed(uint64_t seen_epoch) const { return m_epoch.load() != seen_epoch; }
+
+    void notify(bool all=true) {
+        m_epoch += 1;
+        if (m_waiter_count.load() == 0) return;
+        {
+            // Ensures that a waiter who already checked the epoch is now inside wait_for(), so that it sees us
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        if (all) {
+            m_cv.notify_all();
+        }
+        else {
+            m_cv.notify_one();
+        }
+    }
+
+    /// Returns true if the signal was notified since seen_epoch, false if we timed out.
+    template <typename Rep, typename Period>
+    bool wait_for(uint64_t seen_epoch, const std::chrono::duration<Rep, Period>& timeout) {
+        m_waiter_count += 1;
+        bool notified;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            notified = m_cv.wait_for(lock, timeout, [&](){ return m_epoch.load() != seen_epoch; });
+        }
+        m_waiter_count -= 1;
+        return notified;
+    }
+};
+
+
+#endif //JANA2_JWAITSIGNAL_H
@@ -19,6 +19,7 @@ class JTestDisentangler : public JFactoryT<JTestEventData> {
     size_t m_write_bytes = 500000;
     double m_cputime_spread = 0.25;
     double m_write_spread = 0.25;
+    bool m_use_arena = false;
 
     std::shared_ptr<JTestCalibrationService> m_calibration_service;
 
@@ -31,6 +32,8 @@ public:
         app->GetParameter("jtest:disentangler_ms", m_cputime_ms);
         app->GetParameter("jtest:disentangler_bytes_spread", m_write_spread);
         app->GetParameter("jtest:disentangler_spread", m_cputime_spread);
+        app->GetParameter("jtest:use_arena", m_use_arena);
+        if (m_use_arena) SetFactoryFlag(USE_ARENA);
 
         // Retrieve calibration service from JApp
         m_calibration_service = app->GetService<JTestCalibrationService>();
@@ -49,7 +52,7 @@ public:
         consume_cpu_ms(m_cputime_ms, m_cputime_spread);
 
         // Write (large) event data
-        auto ed = new JTestEventData;
+        auto ed = Construct();
         write_memory(ed->buffer, m_write_bytes, m_write_spread);
         Insert(ed);
     }
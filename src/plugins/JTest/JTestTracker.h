@@ -17,6 +17,8 @@ class JTestTracker : public JFactoryT<JTestTrackData> {
     size_t m_write_bytes = 1000;
     double m_cputime_spread = 0.25;
     double m_write_spread = 0.25;
+    size_t m_object_count = 1;
+    bool m_use_arena = false;
 
 public:
 
@@ -28,6 +30,10 @@ public:
         app->GetParameter("jtest:tracker_ms", m_cputime_ms);
         app->GetParameter("jtest:tracker_bytes_spread", m_write_spread);
         app->GetParameter("jtest:tracker_spread", m_cputime_spread);
+        app->GetParameter("jtest:tracker_objects", m_object_count);
+        if (m_object_count == 0) m_object_count = 1;
+        app->GetParameter("jtest:use_arena", m_use_arena);
+        if (m_use_arena) SetFactoryFlag(USE_ARENA);
     }
 
     void Process(const std::shared_ptr<const JEvent> &aEvent) override {
@@ -39,10 +45,12 @@ public:
         // Do lots of computation
         consume_cpu_ms(m_cputime_ms, m_cputime_spread);
 
-        // Write (small) track data
-        auto td = new JTestTrackData;
-        write_memory(td->buffer, m_write_bytes, m_write_spread);
-        Insert(td);
+        // Write (small) track data, split over m_object_count objects
+        for (size_t i=0; i<m_object_count; ++i) {
+            auto td = Construct();
+            write_memory(td->buffer, m_write_bytes / m_object_count, m_write_spread);
+            Insert(td);
+        }
     }
 };
 
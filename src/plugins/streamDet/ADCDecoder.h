@@ -0,0 +1,145 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef _ADCDecoder_h_
+#define _ADCDecoder_h_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define STREAMDET_X86_DECODERS 1
+#endif
+
+/// Decoders for the DAS payload: a run of fixed-width 5-byte records, each of which is four ASCII digits and a
+/// separator. Every decoder writes one uint16_t per record into `adc_values`, in payload order (sample-major,
+/// channel-minor), and leaves it to the caller to validate the digits, like the original loop did.
+///
+/// The SIMD decoders gather the four digits of each record into one 32-bit lane with a byte shuffle, and then do
+/// the whole `d0*1000 + d1*100 + d2*10 + d3` with two multiply-adds. A 16-byte load only holds three whole records,
+/// so the fourth record of each group comes from a second load shifted by four bytes. Loads never go past the last
+/// record that is being decoded, and the leftover records go through the scalar decoder.
+namespace adcdecoder {
+
+enum class Isa { Scalar, SSSE3, AVX2 };
+
+inline const char* to_string(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSSE3: return "ssse3";
+        case Isa::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+constexpr size_t kRecordBytes = 5;
+
+inline void decode_scalar(const char* payload, size_t record_count, uint16_t* adc_values) {
+    for (size_t i = 0; i < record_count; ++i) {
+        adc_values[i] = (payload[0]-48) * 1000 + (payload[1]-48) * 100 + (payload[2]-48) * 10 + (payload[3]-48);
+        payload += kRecordBytes;
+    }
+}
+
+#ifdef STREAMDET_X86_DECODERS
+
+// Shuffle masks which move the digits of records 0,1,2 (from a load at the start of the group) and of record 3
+// (from a load at byte 4) into 32-bit lanes 0..3. A mask byte of -1 zeroes the destination.
+#define STREAMDET_FIRST3  0, 1, 2, 3,  5, 6, 7, 8,  10, 11, 12, 13,  -1, -1, -1, -1
+#define STREAMDET_FOURTH  -1, -1, -1, -1,  -1, -1, -1, -1,  -1, -1, -1, -1,  11, 12, 13, 14
+
+/// Decodes the 4 records (20 bytes) starting at `group` into four 32-bit lanes
+__attribute__((target("ssse3")))
+inline __m128i decode_group_ssse3(const char* group) {
+    const __m128i first3 = _mm_setr_epi8(STREAMDET_FIRST3);
+    const __m128i fourth = _mm_setr_epi8(STREAMDET_FOURTH);
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group + 4));
+    __m128i digits = _mm_or_si128(_mm_shuffle_epi8(a, first3), _mm_shuffle_epi8(b, fourth));
+    digits = _mm_sub_epi8(digits, _mm_set1_epi8('0'));
+    __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    return _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+}
+
+__attribute__((target("ssse3")))
+inline void decode_ssse3(const char* payload, size_t record_count, uint16_t* adc_values) {
+    size_t i = 0;
+    for (; i + 8 <= record_count; i += 8) {
+        __m128i lo = decode_group_ssse3(payload);
+        __m128i hi = decode_group_ssse3(payload + 4*kRecordBytes);
+        // Values are at most 9999, so the signed saturating pack is exact
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(adc_values + i), _mm_packs_epi32(lo, hi));
+        payload += 8*kRecordBytes;
+    }
+    decode_scalar(payload, record_count - i, adc_values + i);
+}
+
+/// Decodes the 8 records (40 bytes) starting at `group` into eight 32-bit lanes, in order
+__attribute__((target("avx2")))
+inline __m256i decode_group_avx2(const char* group) {
+    const __m256i first3 = _mm256_setr_epi8(STREAMDET_FIRST3, STREAMDET_FIRST3);
+    const __m256i fourth = _mm256_setr_epi8(STREAMDET_FOURTH, STREAMDET_FOURTH);
+    auto load = [](const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+    // vpshufb doesn't cross 128-bit lanes, so the low lane gets records 0..3 and the high lane records 4..7
+    __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(load(group)), load(group + 20), 1);
+    __m256i b = _mm256_inserti128_si256(_mm256_castsi128_si256(load(group + 4)), load(group + 24), 1);
+    __m256i digits = _mm256_or_si256(_mm256_shuffle_epi8(a, first3), _mm256_shuffle_epi8(b, fourth));
+    digits = _mm256_sub_epi8(digits, _mm256_set1_epi8('0'));
+    __m256i pairs = _mm256_maddubs_epi16(digits, _mm256_set1_epi16(0x010A));  // Bytes 10, 1
+    return _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00010064));           // Words 100, 1
+}
+
+__attribute__((target("avx2")))
+inline void decode_avx2(const char* payload, size_t record_count, uint16_t* adc_values) {
+    size_t i = 0;
+    for (; i + 16 <= record_count; i += 16) {
+        __m256i lo = decode_group_avx2(payload);
+        __m256i hi = decode_group_avx2(payload + 8*kRecordBytes);
+        // The pack interleaves 128-bit lanes (0-3, 8-11, 4-7, 12-15), so put the 64-bit quarters back in order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(adc_values + i), packed);
+        payload += 16*kRecordBytes;
+    }
+    decode_ssse3(payload, record_count - i, adc_values + i);
+}
+
+#undef STREAMDET_FIRST3
+#undef STREAMDET_FOURTH
+
+#endif // STREAMDET_X86_DECODERS
+
+/// The fastest decoder this CPU supports
+inline Isa best_isa() {
+#ifdef STREAMDET_X86_DECODERS
+    static const Isa best = __builtin_cpu_supports("avx2") ? Isa::AVX2
+                          : __builtin_cpu_supports("ssse3") ? Isa::SSSE3
+                          : Isa::Scalar;
+    return best;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+/// Decodes with the given instruction set, falling back to scalar if it isn't available on this CPU or build
+inline void decode(const char* payload, size_t record_count, uint16_t* adc_values, Isa isa = best_isa()) {
+#ifdef STREAMDET_X86_DECODERS
+    if (isa == Isa::AVX2 && best_isa() == Isa::AVX2) {
+        decode_avx2(payload, record_count, adc_values);
+        return;
+    }
+    if (isa != Isa::Scalar && best_isa() != Isa::Scalar) {
+        decode_ssse3(payload, record_count, adc_values);
+        return;
+    }
+#else
+    (void) isa;
+#endif
+    decode_scalar(payload, record_count, adc_values);
+}
+
+} // namespace adcdecoder
+
+#endif  // _ADCDecoder_h_
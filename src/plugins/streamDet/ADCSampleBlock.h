@@ -0,0 +1,31 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef _ADCSampleBlock_h_
+#define _ADCSampleBlock_h_
+
+#include <JANA/JObject.h>
+
+#include <vector>
+
+/// All ADC samples of one readout window, as a structure of arrays. The sample and channel of each value are implied
+/// by its position, so that code which only looks at the ADC values can stream through them contiguously.
+struct ADCSampleBlock : public JObject {
+
+    uint32_t source_id = 0;             // 32-bit identifier governed by the INDRA message format
+    size_t sample_count = 0;
+    size_t channel_count = 0;
+    std::vector<uint16_t> adc_values;   // sample_count*channel_count values, sample-major
+
+    uint16_t get_adc_value(size_t sample, size_t channel) const { return adc_values[sample*channel_count + channel]; }
+
+    void Summarize(JObjectSummary& summary) const override {
+        summary.add(source_id,     NAME_OF(source_id),     "%d");
+        summary.add(sample_count,  NAME_OF(sample_count),  "%d");
+        summary.add(channel_count, NAME_OF(channel_count), "%d");
+    }
+};
+
+#endif  // _ADCSampleBlock_h_
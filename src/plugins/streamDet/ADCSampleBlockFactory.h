@@ -0,0 +1,51 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+
+#ifndef _ADCSampleBlockFactory_h_
+#define _ADCSampleBlockFactory_h_
+
+#include <JANA/JFactoryT.h>
+
+#include "ADCDecoder.h"
+#include "ADCSampleBlock.h"
+#include "INDRAMessage.h"
+
+#include <cassert>
+
+class ADCSampleBlockFactory : public JFactoryT<ADCSampleBlock> {
+
+    // We reuse one block rather than reallocating its values for every event
+    ADCSampleBlock m_block;
+
+public:
+
+    void Init() override {
+        SetFactoryFlag(JFactory_Flags_t::NOT_OBJECT_OWNER);
+    }
+
+    void Process(const std::shared_ptr<const JEvent> &event) override {
+
+        // acquire the DASEventMessage via zmq
+        // each DASEventMessage corresponds to one hardware event (readout window)
+        auto message = event->GetSingle<DASEventMessage>();
+
+        const char* payload_buffer;
+        size_t payload_buffer_size;
+        message->as_payload(&payload_buffer, &payload_buffer_size);
+
+        m_block.source_id     = message->as_indra_message()->source_id;
+        m_block.sample_count  = message->get_sample_count();
+        m_block.channel_count = message->get_channel_count();
+
+        size_t record_count = m_block.sample_count * m_block.channel_count;
+        assert(record_count * adcdecoder::kRecordBytes <= payload_buffer_size);
+        m_block.adc_values.resize(record_count);
+        adcdecoder::decode(payload_buffer, record_count, m_block.adc_values.data());
+
+        Insert(&m_block);
+    }
+};
+
+#endif  // _ADCSampleBlockFactory_h_
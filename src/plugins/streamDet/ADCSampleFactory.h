@@ -10,7 +10,7 @@
 #include <JANA/Utils/JPerfUtils.h>
 
 #include "ADCSample.h"
-#include "INDRAMessage.h"
+#include "ADCSampleBlock.h"
 
 #include <fstream>
 
@@ -37,18 +37,11 @@ public:
 
     void Process(const std::shared_ptr<const JEvent> &event) override {
 
-        // acquire the DASEventMessage via zmq
-        // each DASEventMessage corresponds to one hardware event (readout window)
-        // for now we pretend that hardware events = physics events
-        auto message   = event->GetSingle<DASEventMessage>();
-        auto source_id = message->as_indra_message()->source_id;
-
-        // obtain a view into our DASEventMessage payload and assign variables
-        const char* payload_buffer;
-        size_t payload_buffer_size;
-        message->as_payload(&payload_buffer, &payload_buffer_size);
-        size_t max_samples  = message->get_sample_count();
-        size_t max_channels = message->get_channel_count();
+        // The payload is decoded once, into a structure of arrays, by ADCSampleBlockFactory.
+        // Here we only fan it out into one ADCSample per channel and sample.
+        auto block = event->GetSingle<ADCSampleBlock>();
+        size_t max_samples  = block->sample_count;
+        size_t max_channels = block->channel_count;
 
         if (m_samples.size() != max_channels*max_samples) {
             // If size actually changes (hopefully not often), create or destroy new ADCSamples as needed
@@ -63,20 +56,16 @@ public:
         }
 
         size_t i = 0;
-        // decode the message and populate the associated jobject (hit) for the event
+        const uint16_t* adc_values = block->adc_values.data();
         for (uint16_t sample = 0; sample < max_samples; ++sample) {
             for (uint16_t channel = 0; channel < max_channels; ++channel) {
-
-                // Parse in the simplest way possible
-                uint16_t current_value = (payload_buffer[0]-48) * 1000 + (payload_buffer[1]-48) * 100 + (payload_buffer[2]-48) * 10 + (payload_buffer[3]-48);
-                assert(current_value >= 0);
-                assert(current_value <= 1024);
-                payload_buffer += 5;
-                ADCSample& hit = m_samples[i++];
-                hit.source_id  = source_id;
+                assert(adc_values[i] <= 1024);
+                ADCSample& hit = m_samples[i];
+                hit.source_id  = block->source_id;
                 hit.sample_id  = sample;
                 hit.channel_id = channel;
-                hit.adc_value  = current_value;
+                hit.adc_value  = adc_values[i];
+                ++i;
             }
         }
         Set(m_sample_ptrs); // Copy all of the pointers into m_samples over in one go
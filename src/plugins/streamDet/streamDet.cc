@@ -11,6 +11,7 @@
 #include "MonitoringProcessor.h"
 #include "JFactoryGenerator_streamDet.h"
 #include "DecodeDASSource.h"
+#include "ADCSampleBlockFactory.h"
 #include "ADCSampleFactory.h"
 #include "INDRAMessage.h"
 #include "ZmqTransport.h"
@@ -115,6 +116,7 @@ void InitPlugin(JApplication* app) {
     app->Add(new RootProcessor());
     app->Add(new MonitoringProcessor());
     //app->Add(new JCsvWriter<ADCSample>());
+    app->Add(new JFactoryGeneratorT<ADCSampleBlockFactory>());
     app->Add(new JFactoryGeneratorT<ADCSampleFactory>());
 
 }
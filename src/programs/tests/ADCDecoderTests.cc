@@ -0,0 +1,132 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+
+// The decoder has no ROOT or ZeroMQ dependencies, so it is tested here even when the streamDet plugin isn't built
+#include "../../plugins/streamDet/ADCDecoder.h"
+#include "../../plugins/streamDet/ADCSample.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace adcdecodertests {
+
+/// Builds a DAS payload the way streamDetSource.py writes it: four digits and a separator per record
+std::string make_payload(size_t record_count, unsigned seed=22) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, 1024);
+    std::string payload;
+    payload.reserve(record_count * adcdecoder::kRecordBytes);
+    char record[8];
+    for (size_t i = 0; i < record_count; ++i) {
+        snprintf(record, sizeof(record), "%04d,", dist(rng));
+        payload.append(record, adcdecoder::kRecordBytes);
+    }
+    return payload;
+}
+
+/// The loop ADCSampleFactory used before the decoder, which parses and fills one ADCSample at a time
+void decode_into_samples(const char* payload_buffer, size_t max_samples, size_t max_channels, std::vector<ADCSample>& samples) {
+    size_t i = 0;
+    for (uint16_t sample = 0; sample < max_samples; ++sample) {
+        for (uint16_t channel = 0; channel < max_channels; ++channel) {
+            uint16_t current_value = (payload_buffer[0]-48) * 1000 + (payload_buffer[1]-48) * 100 + (payload_buffer[2]-48) * 10 + (payload_buffer[3]-48);
+            payload_buffer += 5;
+            ADCSample& hit = samples[i++];
+            hit.source_id  = 0;
+            hit.sample_id  = sample;
+            hit.channel_id = channel;
+            hit.adc_value  = current_value;
+        }
+    }
+}
+
+} // namespace adcdecodertests
+
+
+TEST_CASE("ADCDecoderTests") {
+    using namespace adcdecodertests;
+    using adcdecoder::Isa;
+
+    auto isa = GENERATE(Isa::Scalar, Isa::SSSE3, Isa::AVX2);
+
+    SECTION("Every record count, including the leftovers after the last full vector") {
+        for (size_t record_count = 0; record_count <= 70; ++record_count) {
+            auto payload = make_payload(record_count);
+            std::vector<uint16_t> expected(record_count), actual(record_count + 1, 0xBEEF);
+            adcdecoder::decode_scalar(payload.data(), record_count, expected.data());
+            adcdecoder::decode(payload.data(), record_count, actual.data(), isa);
+            REQUIRE(std::equal(expected.begin(), expected.end(), actual.begin()));
+            REQUIRE(actual[record_count] == 0xBEEF);  // Nothing written past the end
+        }
+    }
+
+    SECTION("The full range of four digits") {
+        std::string payload;
+        for (int value = 0; value <= 9999; ++value) {
+            char record[8];
+            snprintf(record, sizeof(record), "%04d ", value);
+            payload.append(record, adcdecoder::kRecordBytes);
+        }
+        std::vector<uint16_t> actual(10000);
+        adcdecoder::decode(payload.data(), actual.size(), actual.data(), isa);
+        for (int value = 0; value <= 9999; ++value) REQUIRE(actual[value] == value);
+    }
+
+    SECTION("Same values as the per-sample loop") {
+        const size_t max_samples = 17;
+        const size_t max_channels = 80;
+        auto payload = make_payload(max_samples * max_channels);
+        std::vector<ADCSample> samples(max_samples * max_channels);
+        decode_into_samples(payload.data(), max_samples, max_channels, samples);
+        std::vector<uint16_t> adc_values(max_samples * max_channels);
+        adcdecoder::decode(payload.data(), adc_values.size(), adc_values.data(), isa);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            REQUIRE(samples[i].adc_value == adc_values[i]);
+            REQUIRE(samples[i].sample_id * max_channels + samples[i].channel_id == i);
+        }
+    }
+}
+
+
+TEST_CASE("ADCDecoderBenchmark", "[.][performance]") {
+    using namespace adcdecodertests;
+    using adcdecoder::Isa;
+
+    std::cout << "Best available decoder: " << adcdecoder::to_string(adcdecoder::best_isa()) << std::endl;
+    std::cout << "  samples x channels        loop        scalar        ssse3        avx2   [ns/record]" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (size_t max_samples : {64, 1024}) {
+        for (size_t max_channels : {16, 80, 256}) {
+            size_t record_count = max_samples * max_channels;
+            auto payload = make_payload(record_count);
+            std::vector<ADCSample> samples(record_count);
+            std::vector<uint16_t> adc_values(record_count);
+            size_t repetitions = std::max<size_t>(1, 20000000 / record_count);
+
+            auto measure_ns = [&](const std::function<void()>& decode) {
+                decode();  // Warm up
+                auto start = std::chrono::steady_clock::now();
+                for (size_t r = 0; r < repetitions; ++r) decode();
+                auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                return elapsed / (repetitions * record_count);
+            };
+
+            double loop_ns = measure_ns([&]{ decode_into_samples(payload.data(), max_samples, max_channels, samples); });
+            std::cout << std::setw(10) << max_samples << " x " << std::setw(4) << max_channels << "   " << std::setw(12) << loop_ns;
+            for (auto isa : {Isa::Scalar, Isa::SSSE3, Isa::AVX2}) {
+                double ns = measure_ns([&]{ adcdecoder::decode(payload.data(), record_count, adc_values.data(), isa); });
+                std::cout << std::setw(13) << ns;
+            }
+            std::cout << std::endl;
+        }
+    }
+}
@@ -5,15 +5,150 @@
 #include "BarrierEventTests.h"
 #include "catch.hpp"
 
+#include <chrono>
+#include <iomanip>
+
 TEST_CASE("BarrierEventTests") {
 	SECTION("Basic Barrier") {
+		auto scheduler = GENERATE(as<std::string>{}, "roundrobin", "eventdriven");
+		auto processor_chunksize = GENERATE(1, 5);
+		global_resource = 0;
 		JApplication app;
-		app.Add(new BarrierProcessor(&app));
+		auto proc = new BarrierProcessor(&app);
+		app.Add(proc);
 		app.Add(new BarrierSource("dummy", &app));
 		app.SetParameterValue("nthreads", 4);
+		app.SetParameterValue("jana:scheduler", scheduler);
         app.SetParameterValue("jana:event_source_chunksize", 1);
-        app.SetParameterValue("jana:event_processor_chunksize", 1);
+        app.SetParameterValue("jana:event_processor_chunksize", processor_chunksize);
 		app.Run(true);
+
+		REQUIRE(proc->finished_count == 99);
+		REQUIRE(global_resource == 9);
+		REQUIRE(proc->violation_count == 0);
 	}
 };
 
+
+namespace barriereventtests {
+
+/// Checks that nothing at all, from any source, runs alongside a barrier
+struct ExclusiveBarrierProcessor : public JEventProcessor {
+    std::atomic_int concurrent_count {0};
+    std::atomic_int finished_count {0};
+    std::atomic_int violation_count {0};
+    std::atomic_bool barrier_running {false};
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        int concurrent = ++concurrent_count;
+        if (event->GetSequential()) {
+            if (concurrent != 1) violation_count++;
+            barrier_running = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            barrier_running = false;
+        }
+        else {
+            if (barrier_running) violation_count++;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            if (barrier_running) violation_count++;
+        }
+        --concurrent_count;
+        ++finished_count;
+    }
+};
+
+struct PlainSource : public JEventSource {
+    int event_count = 0;
+    PlainSource() : JEventSource("PlainSource", nullptr) {}
+    void GetEvent(std::shared_ptr<JEvent> event) override {
+        if (++event_count > 200) throw RETURN_STATUS::kNO_MORE_EVENTS;
+        event->SetEventNumber(event_count);
+    }
+};
+
+} // namespace barriereventtests
+
+TEST_CASE("BarrierEventTests: Barriers hold back every source") {
+    auto scheduler = GENERATE(as<std::string>{}, "roundrobin", "eventdriven");
+    JApplication app;
+    auto proc = new barriereventtests::ExclusiveBarrierProcessor;
+    app.Add(proc);
+    app.Add(new BarrierSource("with_barriers", &app));
+    app.Add(new barriereventtests::PlainSource);
+    app.SetParameterValue("nthreads", 4);
+    app.SetParameterValue("jana:scheduler", scheduler);
+    app.SetParameterValue("jana:event_source_chunksize", 1);
+    app.SetParameterValue("log:global", "OFF");
+    app.Run(true);
+
+    REQUIRE(proc->finished_count == 99 + 200);
+    REQUIRE(proc->violation_count == 0);
+}
+
+
+namespace barriereventtests {
+
+/// Emits event_count events, every barrier_interval'th of which is a barrier (0 means none at all)
+struct ThroughputSource : public JEventSource {
+    size_t event_count;
+    size_t barrier_interval;
+    size_t emitted = 0;
+
+    ThroughputSource(size_t event_count, size_t barrier_interval)
+        : JEventSource("ThroughputSource", nullptr), event_count(event_count), barrier_interval(barrier_interval) {
+        SetTypeName("ThroughputSource");
+    }
+
+    void GetEvent(std::shared_ptr<JEvent> event) override {
+        if (emitted == event_count) throw RETURN_STATUS::kNO_MORE_EVENTS;
+        emitted += 1;
+        if (barrier_interval != 0 && emitted % barrier_interval == 0) {
+            event->SetSequential(true);
+        }
+    }
+};
+
+struct ThroughputProcessor : public JEventProcessor {
+    std::chrono::microseconds latency;
+    explicit ThroughputProcessor(std::chrono::microseconds latency) : latency(latency) {}
+    void Process(const std::shared_ptr<const JEvent>&) override {
+        std::this_thread::sleep_for(latency);
+    }
+};
+
+double measure_seconds(size_t nthreads, size_t event_count, size_t barrier_interval) {
+    JApplication app;
+    app.Add(new ThroughputSource(event_count, barrier_interval));
+    app.Add(new ThroughputProcessor(std::chrono::microseconds(200)));
+    app.SetParameterValue("nthreads", nthreads);
+    app.SetParameterValue("jana:event_source_chunksize", 1);
+    app.SetParameterValue("log:global", "OFF");
+    auto start = std::chrono::steady_clock::now();
+    app.Run(true);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace barriereventtests
+
+
+TEST_CASE("BarrierEventThroughputBenchmark", "[.][performance]") {
+
+    const size_t event_count = 5000;
+    std::cout << " threads | barrier every | events/sec | cost per barrier [ms]" << std::endl;
+    std::cout << "---------+---------------+------------+----------------------" << std::endl;
+    for (size_t nthreads : {1, 4, 8}) {
+        double baseline = barriereventtests::measure_seconds(nthreads, event_count, 0);
+        for (size_t interval : {0, 1000, 100, 10}) {
+            double elapsed = (interval == 0) ? baseline : barriereventtests::measure_seconds(nthreads, event_count, interval);
+            std::cout << std::setw(8) << nthreads << " | "
+                      << std::setw(13) << ((interval == 0) ? std::string("never") : std::to_string(interval)) << " | "
+                      << std::setw(10) << std::fixed << std::setprecision(0) << event_count / elapsed << " | ";
+            if (interval == 0) {
+                std::cout << std::setw(20) << "-" << std::endl;
+            }
+            else {
+                double cost_ms = 1000.0 * (elapsed - baseline) / (event_count / interval);
+                std::cout << std::setw(20) << std::setprecision(3) << cost_ms << std::endl;
+            }
+        }
+    }
+}
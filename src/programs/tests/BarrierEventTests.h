@@ -52,17 +52,28 @@ public:
 struct BarrierProcessor : public JEventProcessor {
 
 public:
+    std::atomic_int concurrent_count {0};
+    std::atomic_int finished_count {0};
+    std::atomic_int violation_count {0};
+
     explicit BarrierProcessor(JApplication* app) : JEventProcessor(app) {}
 
     void Process(const std::shared_ptr<const JEvent>& event) override {
 
+        int concurrent = ++concurrent_count;
         if (event->GetSequential()) {
+            // Every event before this one has finished, and nothing else is running alongside it
+            if (concurrent != 1 || finished_count != (int) event->GetEventNumber() - 1) violation_count++;
             global_resource += 1;
             LOG << "Barrier event = " << event->GetEventNumber() << ", writing global var = " << global_resource << LOG_END;
         }
         else {
+            // Events only ever see the barriers which came before them
+            if (global_resource != (int) event->GetEventNumber() / 10) violation_count++;
             LOG << "Processing non-barrier event = " << event->GetEventNumber() << ", reading global var = " << global_resource << LOG_END;
         }
+        --concurrent_count;
+        ++finished_count;
     }
 };
 
@@ -0,0 +1,131 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <catch.hpp>
+#include <JANA/Engine/JAutotuner.h>
+#include <JANA/CLI/JBenchmarker.h>
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <unistd.h>
+
+#include "ScaleTests.h"
+
+namespace jautotunertests {
+
+/// Runs the tuner against a synthetic throughput model, checking the invariants along the way
+template <typename ModelT>
+JAutotuner::Settings tune(JAutotuner& tuner, const JArrowPerfSummary& perf, ModelT model, size_t intervals=200) {
+    auto settings = tuner.get_settings();
+    for (size_t i=0; i<intervals; ++i) {
+        settings = tuner.update(i, model(settings), perf);
+        REQUIRE(settings.event_source_chunksize <= settings.event_queue_threshold);
+        REQUIRE(settings.nthreads >= 1);
+        REQUIRE(settings.nthreads <= 8);
+    }
+    return tuner.get_best_settings();
+}
+
+JArrowPerfSummary make_perf(double seq_bottleneck_hz, double par_bottleneck_hz) {
+    JArrowPerfSummary perf;
+    perf.avg_seq_bottleneck_hz = seq_bottleneck_hz;
+    perf.avg_par_bottleneck_hz = par_bottleneck_hz;
+    return perf;
+}
+
+} // namespace jautotunertests
+
+
+TEST_CASE("JAutotunerTests") {
+
+    JAutotuner::Limits limits;
+    limits.max_threads = 8;
+
+    SECTION("Adds threads only while they pay for themselves") {
+        // Throughput scales perfectly up to 4 threads and then stays flat, e.g. because the node only has 4 cores
+        JAutotuner tuner({1, 1, 1}, limits);
+        auto perf = jautotunertests::make_perf(std::numeric_limits<double>::infinity(), 100);
+        auto result = jautotunertests::tune(tuner, perf, [](const JAutotuner::Settings& s) {
+            return 100.0 * std::min<size_t>(s.nthreads, 4);
+        });
+        REQUIRE(result.nthreads == 4);
+    }
+
+    SECTION("Gives back threads when a sequential arrow is the bottleneck") {
+        // Nothing beyond 3 threads helps, because the sequential stage tops out at 300 Hz
+        JAutotuner tuner({8, 1, 1}, limits);
+        auto perf = jautotunertests::make_perf(300, 800);
+        auto result = jautotunertests::tune(tuner, perf, [](const JAutotuner::Settings& s) {
+            return 100.0 * std::min<size_t>(s.nthreads, 3);
+        });
+        REQUIRE(result.nthreads == 3);
+    }
+
+    SECTION("Shrinks chunks and queues until it starts to hurt") {
+        // Chunks smaller than 10 halve the throughput; the queue threshold doesn't matter
+        JAutotuner tuner({2, 40, 80}, limits);
+        auto perf = jautotunertests::make_perf(std::numeric_limits<double>::infinity(), 200);
+        auto result = jautotunertests::tune(tuner, perf, [](const JAutotuner::Settings& s) {
+            return 100.0 * std::min<size_t>(s.nthreads, 2) * ((s.event_source_chunksize >= 10) ? 1 : 0.5);
+        });
+        REQUIRE(result.event_source_chunksize == 10);
+        REQUIRE(result.event_queue_threshold == 10);
+    }
+
+    SECTION("Decisions are recorded and exportable") {
+        JAutotuner tuner({1, 1, 1}, limits);
+        auto perf = jautotunertests::make_perf(std::numeric_limits<double>::infinity(), 100);
+        jautotunertests::tune(tuner, perf, [](const JAutotuner::Settings& s) { return 100.0 * s.nthreads; }, 10);
+
+        auto& decisions = tuner.get_decisions();
+        REQUIRE(!decisions.empty());
+        REQUIRE(decisions[0].knob == JAutotuner::Knob::NThreads);
+        REQUIRE(decisions[0].old_value == 1);
+        REQUIRE(decisions[0].new_value == 2);
+        REQUIRE(decisions[0].accepted);
+
+        std::ostringstream os;
+        tuner.write_decisions(os);
+        std::string line;
+        std::istringstream is(os.str());
+        size_t line_count = 0;
+        while (std::getline(is, line)) line_count++;
+        REQUIRE(line_count == decisions.size() + 1);  // Plus the header
+        REQUIRE(os.str().find("nthreads") != std::string::npos);
+    }
+
+    SECTION("Waits for a baseline before trying anything") {
+        JAutotuner tuner({1, 1, 1}, limits);
+        auto perf = jautotunertests::make_perf(std::numeric_limits<double>::infinity(), 100);
+        auto settings = tuner.update(0, 0, perf);
+        REQUIRE(settings.nthreads == 1);
+        REQUIRE(tuner.get_decisions().empty());
+    }
+}
+
+
+TEST_CASE("JBenchmarkerAutotuneRunsToCompletion") {
+    JApplication app;
+    auto processor = new scaletest::CountingProcessor(1);
+    app.Add(new scaletest::CountingSource(&app));
+    app.Add(processor);
+    app.SetTicker(false);
+    app.SetParameterValue("jana:nevents", 2000);
+    app.SetParameterValue("benchmark:autotune", true);
+    app.SetParameterValue("benchmark:autotune_interval_ms", 20);
+    app.SetParameterValue("benchmark:maxthreads", 4);
+    app.SetParameterValue("benchmark:resultsdir", "JANA_Autotune_Test_Results");
+
+    JBenchmarker benchmarker(&app);
+    benchmarker.RunUntilFinished();
+
+    // Every event gets processed while the knobs are being turned, and the decisions end up on disk
+    REQUIRE(processor->processed_count == 2000);
+    std::ifstream ifs("JANA_Autotune_Test_Results/autotune.dat");
+    REQUIRE(ifs.good());
+    ifs.close();
+    std::remove("JANA_Autotune_Test_Results/autotune.dat");
+    rmdir("JANA_Autotune_Test_Results");
+}
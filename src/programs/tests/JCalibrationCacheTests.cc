@@ -0,0 +1,198 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+
+#include <JANA/Calibrations/JCalibrationFile.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jcalibrationcachetests {
+
+/// A calibration directory which cleans up after itself
+struct CalibDir {
+    std::string path;
+    std::vector<std::string> files;
+
+    CalibDir() {
+        char tmpl[] = "JCalibrationCacheTest_XXXXXX";
+        path = std::string(mkdtemp(tmpl)) + "/";
+    }
+
+    ~CalibDir() {
+        std::remove((path + JCalibrationCache::DEFAULT_FILENAME).c_str());
+        for (auto& file : files) std::remove((path + file).c_str());
+        rmdir((path + "CDC").c_str());
+        rmdir(path.c_str());
+    }
+
+    void Write(const std::string& namepath, const std::string& contents) {
+        if (namepath.find('/') != std::string::npos) mkdir((path + namepath.substr(0, namepath.find('/'))).c_str(), 0755);
+        std::ofstream f(path + namepath);
+        f << contents;
+        if (std::find(files.begin(), files.end(), namepath) == files.end()) files.push_back(namepath);
+    }
+
+    std::string URL() const { return "file://" + path; }
+};
+
+template <typename T>
+void RequireSameConstants(JCalibration& text, JCalibration& cached, const std::string& namepath, bool tables=true) {
+    std::map<std::string,T> text_map, cached_map;
+    REQUIRE(text.Get(namepath, text_map) == cached.Get(namepath, cached_map));
+    REQUIRE(text_map == cached_map);
+
+    std::vector<T> text_vector, cached_vector;
+    REQUIRE(text.Get(namepath, text_vector) == cached.Get(namepath, cached_vector));
+    REQUIRE(text_vector == cached_vector);
+
+    if (!tables) return;
+    std::vector<std::map<std::string,T>> text_maps, cached_maps;
+    REQUIRE(text.Get(namepath, text_maps) == cached.Get(namepath, cached_maps));
+    REQUIRE(text_maps == cached_maps);
+
+    std::vector<std::vector<T>> text_rows, cached_rows;
+    REQUIRE(text.Get(namepath, text_rows) == cached.Get(namepath, cached_rows));
+    REQUIRE(text_rows == cached_rows);
+}
+
+} // namespace jcalibrationcachetests
+
+
+TEST_CASE("JCalibrationCacheTests") {
+    using namespace jcalibrationcachetests;
+
+    CalibDir dir;
+    dir.Write("CDC/gains", "a 1.5\nb 2\nc -3\n");
+    dir.Write("CDC/table", "# Run range: 1 - 10\n#% amp mean sigma\n4.71 8.9 0.234\n5.20 9.1 0.377\n4.89 8.8 0.314\n");
+    dir.Write("values", "1\n2.5\nabc\n0x10\n3000000000\n-7\n1e3\n.5\n\n# comment\n255\n");
+    dir.Write("ragged", "1 2 3\n4 5\n");
+    dir.Write("comments_only", "# nothing here\n");
+
+    JCalibrationFile text(dir.URL(), 5);
+    REQUIRE(!text.HasCache());
+    JCalibrationFile compiler(dir.URL(), 5);
+    REQUIRE(compiler.CompileCache() == 4);  // Everything except the file without any data
+    JCalibrationFile cached(dir.URL(), 5);
+    REQUIRE(cached.HasCache());
+
+    SECTION("Cached constants are identical to the text") {
+        for (std::string namepath : {"CDC/gains", "CDC/table", "values", "ragged"}) {
+            RequireSameConstants<std::string>(text, cached, namepath);
+            RequireSameConstants<double>(text, cached, namepath);
+            RequireSameConstants<float>(text, cached, namepath);
+            RequireSameConstants<int>(text, cached, namepath);
+            RequireSameConstants<unsigned int>(text, cached, namepath);
+            RequireSameConstants<long>(text, cached, namepath);
+            RequireSameConstants<short>(text, cached, namepath);
+            RequireSameConstants<char>(text, cached, namepath);
+        }
+        RequireSameConstants<double>(text, cached, "comments_only", false);
+    }
+
+    SECTION("Tables can be used in place") {
+        JCalibrationCache cache(dir.path + JCalibrationCache::DEFAULT_FILENAME);
+        auto entry = cache.Find("CDC/table", 5);
+        REQUIRE(entry != nullptr);
+        REQUIRE(entry->GetRowCount() == 3);
+        REQUIRE(entry->GetColumnCount() == 3);
+        REQUIRE(entry->GetColumnName(2) == "sigma");
+        REQUIRE(entry->GetTableDoubles()[0] == 4.71);
+        REQUIRE(entry->GetTableDoubles()[8] == 0.314);
+
+        // Ragged tables can't be represented, so they are only available as key/value pairs
+        auto ragged = cache.Find("ragged", 5);
+        REQUIRE(ragged != nullptr);
+        REQUIRE(ragged->HasKeyValues());
+        REQUIRE(!ragged->HasTable());
+    }
+
+    SECTION("Lookups respect the run range") {
+        JCalibrationCache cache(dir.path + JCalibrationCache::DEFAULT_FILENAME);
+        REQUIRE(cache.Find("CDC/table", 1) != nullptr);
+        REQUIRE(cache.Find("CDC/table", 11) == nullptr);
+        REQUIRE(cache.Find("CDC/gains", 11) != nullptr);
+        REQUIRE(cache.Find("CDC/missing", 5) == nullptr);
+
+        // Outside the run range, JCalibrationFile goes back to the text, as it always did
+        JCalibrationFile text_run20(dir.URL(), 20);
+        JCalibrationFile cached_run20(dir.URL(), 20);
+        RequireSameConstants<double>(text_run20, cached_run20, "CDC/table");
+    }
+
+    SECTION("Changed text files are read from text") {
+        dir.Write("CDC/gains", "a 1.5\nb 2\nc -3\nd 4\n");
+        JCalibrationFile recached(dir.URL(), 5);
+        REQUIRE(recached.HasCache());
+        std::map<std::string,double> gains;
+        REQUIRE(!recached.Get("CDC/gains", gains));
+        REQUIRE(gains.size() == 4);
+        REQUIRE(gains["d"] == 4);
+    }
+
+    SECTION("Broken caches are ignored") {
+        std::ofstream((dir.path + JCalibrationCache::DEFAULT_FILENAME).c_str()) << "not a cache at all, but long enough to have a header";
+        JCalibrationFile broken(dir.URL(), 5);
+        REQUIRE(!broken.HasCache());
+        RequireSameConstants<double>(text, broken, "CDC/table");
+    }
+
+    SECTION("The cache file is not a namepath") {
+        std::vector<std::string> namepaths;
+        cached.GetListOfNamepaths(namepaths);
+        REQUIRE(namepaths.size() == 5);
+    }
+}
+
+
+TEST_CASE("JCalibrationCacheBenchmark", "[.][performance]") {
+    using namespace jcalibrationcachetests;
+
+    // Looks like a BeginRun: many factories, each fetching a few tables
+    const size_t table_count = 100;
+    const size_t rows = 100;
+    const size_t cols = 6;
+    CalibDir dir;
+    for (size_t t=0; t<table_count; ++t) {
+        std::ostringstream os;
+        os << "#% c0 c1 c2 c3 c4 c5\n";
+        for (size_t r=0; r<rows; ++r) {
+            for (size_t c=0; c<cols; ++c) os << (r*0.731 + c*1.17 + t) << " ";
+            os << "\n";
+        }
+        dir.Write("table_" + std::to_string(t), os.str());
+    }
+
+    auto measure_us = [&](JCalibration& calib) {
+        std::vector<std::vector<double>> vals;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t=0; t<table_count; ++t) calib.Get("table_" + std::to_string(t), vals);
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / table_count;
+    };
+
+    JCalibrationFile text(dir.URL(), 1);
+    double text_us = measure_us(text);
+
+    JCalibrationFile compiler(dir.URL(), 1);
+    auto compile_start = std::chrono::steady_clock::now();
+    compiler.CompileCache();
+    double compile_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compile_start).count();
+
+    JCalibrationFile cached(dir.URL(), 1);
+    double cached_us = measure_us(cached);
+
+    std::cout << "Get<vector<vector<double>>> on a " << rows << "x" << cols << " table, averaged over " << table_count << " tables" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  text:     " << std::setw(8) << text_us << " us" << std::endl;
+    std::cout << "  cached:   " << std::setw(8) << cached_us << " us" << std::endl;
+    std::cout << "  speedup:  " << std::setw(8) << text_us / cached_us << "x" << std::endl;
+    std::cout << "  compile:  " << std::setw(8) << compile_ms << " ms" << std::endl;
+}
@@ -0,0 +1,150 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+
+#include <JANA/JApplication.h>
+#include <JANA/Calibrations/JCalibrationManager.h>
+
+#include <thread>
+
+namespace jcalibrationmanagertests {
+
+/// Counts the JCalibrations it makes, and how many of them are still alive
+struct CountingCalibration : public JCalibration {
+    static std::atomic_int created;
+    static std::atomic_int alive;
+
+    CountingCalibration(std::string url, int32_t run, std::string context) : JCalibration(url, run, context) {
+        created++;
+        alive++;
+    }
+    ~CountingCalibration() override { alive--; }
+
+    bool GetCalib(string, map<string, string> &svals, uint64_t) override {
+        svals["run"] = std::to_string(GetRun());
+        return false;
+    }
+    bool GetCalib(string, vector<string> &svals, uint64_t) override {
+        svals = {std::to_string(GetRun())};
+        return false;
+    }
+    bool GetCalib(string, vector< map<string, string> > &, uint64_t) override { return true; }
+    bool GetCalib(string, vector< vector<string> > &, uint64_t) override { return true; }
+    void GetListOfNamepaths(vector<string> &) override {}
+};
+std::atomic_int CountingCalibration::created {0};
+std::atomic_int CountingCalibration::alive {0};
+
+struct CountingGenerator : public JCalibrationGenerator {
+    const char* Description() override { return "CountingGenerator"; }
+    double CheckOpenable(string, int32_t, string) override { return 1.0; }
+    JCalibration* MakeJCalibration(string url, int32_t run, string context) override {
+        return new CountingCalibration(url, run, context);
+    }
+};
+
+std::shared_ptr<JCalibrationManager> make_manager(JApplication& app, CountingGenerator& generator, size_t snapshot_runs) {
+    app.SetParameterValue("jana:calib_snapshot_runs", snapshot_runs);
+    app.SetParameterValue("log:global", "OFF");
+    app.ProvideService(std::make_shared<JCalibrationManager>());
+    auto manager = app.GetService<JCalibrationManager>();
+    manager->AddCalibrationGenerator(&generator);
+    return manager;
+}
+
+} // namespace jcalibrationmanagertests
+
+
+TEST_CASE("JCalibrationManagerSnapshotTests") {
+    using namespace jcalibrationmanagertests;
+    CountingCalibration::created = 0;
+    CountingCalibration::alive = 0;
+    CountingGenerator generator;
+    JApplication app;
+
+    SECTION("Each run gets exactly one snapshot") {
+        auto manager = make_manager(app, generator, 4);
+        auto first = manager->GetSnapshot(7);
+        REQUIRE(first != nullptr);
+        REQUIRE(first->GetRun() == 7);
+        REQUIRE(manager->GetSnapshot(7) == first);
+        REQUIRE(manager->GetSnapshot(8) != first);
+
+        std::vector<int> vals;
+        REQUIRE(!first->Get("any/namepath", vals));
+        REQUIRE(vals == std::vector<int>{7});
+        REQUIRE(CountingCalibration::created == 2);
+    }
+
+    SECTION("Concurrent BeginRuns share one snapshot per run") {
+        auto manager = make_manager(app, generator, 4);
+        std::vector<std::thread> threads;
+        std::vector<const JCalibrationSnapshot*> seen(64 * 3);
+        for (size_t t=0; t<64; ++t) {
+            threads.emplace_back([&, t](){
+                for (int run=1; run<=3; ++run) {
+                    auto snapshot = manager->GetSnapshot(run);
+                    seen[t*3 + run - 1] = snapshot.get();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        REQUIRE(CountingCalibration::created == 3);
+        for (size_t t=1; t<64; ++t) {
+            for (size_t run=0; run<3; ++run) REQUIRE(seen[t*3 + run] == seen[run]);
+        }
+    }
+
+    SECTION("Old runs are freed once nobody holds them") {
+        auto manager = make_manager(app, generator, 2);
+        std::weak_ptr<const JCalibrationSnapshot> run1 = manager->GetSnapshot(1);
+        auto run2 = manager->GetSnapshot(2);
+        REQUIRE(!run1.expired());  // Still published
+
+        manager->GetSnapshot(3);
+        manager->GetSnapshot(4);
+        REQUIRE(run1.expired());
+        REQUIRE(CountingCalibration::alive == 3);  // Runs 3 and 4 are published, and run 2 is held
+
+        // A run which is still held is handed out again instead of being recreated
+        REQUIRE(manager->GetSnapshot(2) == run2);
+        REQUIRE(CountingCalibration::created == 4);
+    }
+
+    SECTION("JCalibrations handed out as raw pointers are never freed") {
+        auto manager = make_manager(app, generator, 1);
+        JCalibration* calib = manager->GetJCalibration(1);
+        REQUIRE(calib != nullptr);
+        manager->GetSnapshot(2);
+        manager->GetSnapshot(3);
+        REQUIRE(manager->GetJCalibration(1) == calib);
+        REQUIRE(manager->GetSnapshot(1)->GetJCalibration() == calib);
+
+        vector<JCalibration*> calibs;
+        manager->GetJCalibrations(calibs);
+        REQUIRE(calibs == vector<JCalibration*>{calib});  // Runs 2 and 3 were freed once run 1 was published again
+    }
+
+    SECTION("Every calibration is listed, however it was created") {
+        auto manager = make_manager(app, generator, 4);
+        std::vector<int> vals;
+        REQUIRE(!manager->GetCalib(1, 0, "any/namepath", vals));
+        auto run2 = manager->GetSnapshot(2)->GetJCalibration();
+        auto run3 = manager->GetJCalibration(3);
+
+        vector<JCalibration*> calibs;
+        manager->GetJCalibrations(calibs);
+        REQUIRE(calibs.size() == 3);
+        REQUIRE(calibs[0]->GetRun() == 1);
+        REQUIRE(calibs[1] == run2);
+        REQUIRE(calibs[2] == run3);
+
+        // Listed calibrations are pinned, so they outlive being pushed out of the snapshot table
+        for (int run=4; run<=8; ++run) manager->GetSnapshot(run);
+        REQUIRE(manager->GetSnapshot(1)->GetJCalibration() == calibs[0]);
+        REQUIRE(manager->GetSnapshot(2)->GetJCalibration() == run2);
+        REQUIRE(CountingCalibration::created == 8);
+    }
+}
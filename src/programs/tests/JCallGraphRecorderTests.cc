@@ -4,6 +4,8 @@
 
 #include <catch.hpp>
 #include <JANA/Utils/JCallGraphRecorder.h>
+#include <atomic>
+#include <thread>
 #include "JANA/JEvent.h"
 
 TEST_CASE("Test topological sort algorithm in isolation") {
@@ -33,6 +35,42 @@ TEST_CASE("Test topological sort algorithm in isolation") {
     REQUIRE(result[3].first == "DName");
 }
 
+TEST_CASE("Factory names are interned once per process") {
+    auto id = JCallGraphRecorder::InternName("InternedName");
+    REQUIRE(JCallGraphRecorder::InternName("InternedName") == id);
+    REQUIRE(JCallGraphRecorder::InternName("OtherInternedName") != id);
+    REQUIRE(JCallGraphRecorder::GetInternedName(id) == "InternedName");
+
+    struct InternedType {};
+    auto type_id = JCallGraphRecorder::GetTypeNameId<InternedType>();
+    REQUIRE(JCallGraphRecorder::GetTypeNameId<InternedType>() == type_id);
+    REQUIRE(JCallGraphRecorder::GetInternedName(type_id) == JTypeInfo::demangle<InternedType>());
+}
+
+TEST_CASE("Interned names can be read while other names are being interned") {
+    auto first_id = JCallGraphRecorder::InternName("FirstOfManyNames");
+    const std::string* first_name = &JCallGraphRecorder::GetInternedName(first_id);
+
+    std::atomic_bool done {false};
+    std::thread reader([&]{
+        while (!done) {
+            REQUIRE(JCallGraphRecorder::GetInternedName(first_id) == "FirstOfManyNames");
+        }
+    });
+    std::vector<JCallGraphRecorder::NameId> ids;
+    for (int i=0; i<1000; ++i) {
+        ids.push_back(JCallGraphRecorder::InternName("ManyNames" + std::to_string(i)));
+    }
+    done = true;
+    reader.join();
+
+    // Interning enough names to need new storage doesn't move the ones handed out already
+    REQUIRE(&JCallGraphRecorder::GetInternedName(first_id) == first_name);
+    for (int i=0; i<1000; ++i) {
+        REQUIRE(JCallGraphRecorder::GetInternedName(ids[i]) == "ManyNames" + std::to_string(i));
+    }
+}
+
 
 struct ObjA {};
 struct ObjB {};
@@ -0,0 +1,99 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <catch.hpp>
+#include <JANA/JApplication.h>
+#include <JANA/JEventSource.h>
+#include <JANA/JEventProcessor.h>
+
+#include <random>
+#include <thread>
+
+namespace jeventorderingtests {
+
+struct CountingSource : public JEventSource {
+    bool slow_reads = false;  // Takes a random amount of time per event, so that parallel reads finish out of order
+
+    CountingSource() : JEventSource("CountingSource", nullptr) {
+        SetTypeName("CountingSource");
+    }
+    void GetEvent(std::shared_ptr<JEvent> event) override {
+        if (slow_reads) {
+            std::mt19937 rng(event->GetEventNumber() + 2);
+            std::this_thread::sleep_for(std::chrono::microseconds(rng() % 1000));
+        }
+    }
+};
+
+/// Takes a random amount of time per event, so that events overtake each other
+struct ScramblingProcessor : public JEventProcessor {
+    std::atomic_int processed_count {0};
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        std::mt19937 rng(event->GetEventNumber());
+        std::this_thread::sleep_for(std::chrono::microseconds(rng() % 2000));
+        processed_count++;
+    }
+};
+
+struct OrderedProcessor : public JEventProcessor {
+    std::vector<uint64_t> event_numbers;  // Ordered processors are only ever called by one thread at a time
+
+    OrderedProcessor() {
+        SetTypeName("OrderedProcessor");
+        SetEventsOrdered(true);
+    }
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        std::mt19937 rng(event->GetEventNumber() + 1);
+        std::this_thread::sleep_for(std::chrono::microseconds(rng() % 200));
+        event_numbers.push_back(event->GetEventNumber());
+    }
+};
+
+TEST_CASE("JEventOrderingTests") {
+
+    JApplication app;
+    auto source = new CountingSource;
+    app.Add(source);
+    app.SetParameterValue("nthreads", 4);
+    app.SetParameterValue("jana:nevents", 100);
+    app.SetParameterValue("jana:event_source_chunksize", 1);
+    auto ordered_proc = new OrderedProcessor;
+    app.Add(ordered_proc);
+
+    std::vector<uint64_t> expected;
+
+    SECTION("Ordered processors see events in order, even when other processors scramble them") {
+        auto scrambling_proc = new ScramblingProcessor;
+        app.Add(scrambling_proc);
+        app.Run(true);
+        REQUIRE(scrambling_proc->processed_count == 100);
+        for (uint64_t i=0; i<100; ++i) expected.push_back(i);
+    }
+
+    SECTION("Ordered processors work on their own") {
+        app.Run(true);
+        for (uint64_t i=0; i<100; ++i) expected.push_back(i);
+    }
+
+    SECTION("Ordering starts from the first event which wasn't skipped") {
+        app.SetParameterValue("jana:nskip", 10);
+        app.Add(new ScramblingProcessor);
+        app.Run(true);
+        for (uint64_t i=10; i<110; ++i) expected.push_back(i);
+    }
+
+    SECTION("Events read in parallel are ordered by the slot they were read into, not by when the read finished") {
+        source->EnableParallelGetEvent();
+        source->slow_reads = true;
+        app.SetParameterValue("jana:nskip", 10);
+        app.Run(true);
+        for (uint64_t i=10; i<110; ++i) expected.push_back(i);
+    }
+
+    REQUIRE(ordered_proc->event_numbers == expected);
+    REQUIRE(app.GetNEventsProcessed() == 100);
+}
+
+} // namespace jeventorderingtests
@@ -0,0 +1,219 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+
+#include <JANA/JApplication.h>
+#include <JANA/Utils/JEventPool.h>
+#include <JANA/Engine/JEventSourceArrow.h>
+
+TEST_CASE("JEventPool: Events return to their home location") {
+
+    JApplication app;
+    app.Initialize();
+    auto jcm = app.GetService<JComponentManager>();
+
+    JEventPool pool(jcm, 1, 2, true);
+
+    auto home0 = pool.get(0);
+    REQUIRE(home0 != nullptr);
+    REQUIRE(pool.get(0) == nullptr);
+
+    auto* raw0 = home0.get();
+
+    // A worker on location 1 finishes the event, e.g. after stealing it
+    pool.put(home0, 1);
+
+    auto again0 = pool.get(0);
+    REQUIRE(again0.get() == raw0);
+
+    auto home1 = pool.get(1);
+    REQUIRE(home1 != nullptr);
+    REQUIRE(home1.get() != raw0);
+    REQUIRE(pool.get(1) == nullptr);
+}
+
+TEST_CASE("JEventPool: Locations may hold uneven shares of the pool") {
+
+    JApplication app;
+    app.Initialize();
+    auto jcm = app.GetService<JComponentManager>();
+    JEventPool pool(jcm, std::vector<size_t>{2, 1}, true);
+    REQUIRE(pool.size() == 3);
+    REQUIRE(pool.get_location_count() == 2);
+
+    auto first = pool.get(0);
+    auto second = pool.get(0);
+    auto third = pool.get(1);
+    REQUIRE(first != nullptr);
+    REQUIRE(second != nullptr);
+    REQUIRE(third != nullptr);
+    REQUIRE(pool.get(0) == nullptr);
+    REQUIRE(pool.get(1) == nullptr);
+}
+
+TEST_CASE("JEventPool: Pinned construction with a processor mapping") {
+
+    JApplication app;
+    app.Initialize();
+    auto jcm = app.GetService<JComponentManager>();
+
+    JProcessorMapping mapping;
+    mapping.initialize(JProcessorMapping::AffinityStrategy::MemoryBound, JProcessorMapping::LocalityStrategy::CpuLocal);
+
+    // If lscpu is unavailable the mapping stays uninitialized and the pool is filled from this thread instead
+    size_t location_count = mapping.get_loc_count();
+    JEventPool pool(jcm, 2, location_count, true, &mapping);
+    REQUIRE(pool.get_location_count() == location_count);
+
+    for (size_t loc=0; loc<location_count; ++loc) {
+        auto first = pool.get(loc);
+        auto second = pool.get(loc);
+        REQUIRE(first != nullptr);
+        REQUIRE(second != nullptr);
+        REQUIRE(pool.get(loc) == nullptr);
+        pool.put(first, loc);
+        pool.put(second, loc);
+    }
+}
+
+namespace jeventpooltests {
+
+struct SourceAObject {};
+struct SourceBObject {};
+struct InsertedObject {};
+
+struct PlainSource : public JEventSource {
+    PlainSource() : JEventSource("PlainSource") {}
+    void GetEvent(std::shared_ptr<JEvent>) override {}
+};
+
+} // namespace jeventpooltests
+
+TEST_CASE("JEventPool: Switching sources reuses each event's factory sets") {
+    using namespace jeventpooltests;
+
+    JApplication app;
+    app.Initialize();
+    auto jcm = app.GetService<JComponentManager>();
+    JEventPool pool(jcm, 2, 1, true);
+
+    PlainSource source_a, source_b, source_without_factories;
+    JFactoryGeneratorT<JFactoryT<SourceAObject>> gen_a;
+    JFactoryGeneratorT<JFactoryT<SourceBObject>> gen_b;
+    source_a.SetFactoryGenerator(&gen_a);
+    source_b.SetFactoryGenerator(&gen_b);
+
+    // Events ping-pong between the sources, as when reading several files at once
+    for (size_t i=0; i<100; ++i) {
+        auto first = pool.get(0);
+        auto second = pool.get(0);
+        REQUIRE(second != nullptr);
+        if (first.get() > second.get()) std::swap(first, second);  // Same order every time, whatever the pool's order
+        pool.switch_source(*first, (i % 2 == 0) ? &source_a : &source_b);
+        pool.switch_source(*second, (i % 2 == 0) ? &source_b : &source_a);
+        for (auto event : {first, second}) {
+            bool is_a = (event->GetJEventSource() == &source_a);
+            REQUIRE((event->GetFactory<SourceAObject>() != nullptr) == is_a);
+            REQUIRE((event->GetFactory<SourceBObject>() != nullptr) == !is_a);
+            auto inserted = event->GetFactory<InsertedObject>();
+            REQUIRE((inserted == nullptr || inserted->GetNumObjects() == 0));
+            event->Insert(new InsertedObject);  // Must be gone when the event comes back
+        }
+        pool.put(first, 0);
+        pool.put(second, 0);
+    }
+    REQUIRE(pool.get_factory_set_build_count() == 4);  // One per event and source
+
+    auto event = pool.get(0);
+    pool.switch_source(*event, &source_without_factories);
+    REQUIRE(pool.get_factory_set_build_count() == 5);  // A source without factories still needs its own set here
+    REQUIRE(event->GetFactory<InsertedObject>() == nullptr);
+
+    SECTION("Fresh events don't need a new factory set for sources without factories") {
+        JEventPool fresh_pool(jcm, 1, 1, true);
+        auto fresh = fresh_pool.get(0);
+        auto factory_set = fresh->GetFactorySet();
+        fresh_pool.switch_source(*fresh, &source_without_factories);
+        REQUIRE(fresh->GetFactorySet() == factory_set);
+        REQUIRE(fresh_pool.get_factory_set_build_count() == 0);
+    }
+}
+
+TEST_CASE("JEventPool: An exhausted pool backpressures the source") {
+
+    JApplication app;
+    app.Initialize();
+    auto jcm = app.GetService<JComponentManager>();
+    auto pool = std::make_shared<JEventPool>(jcm, 1, 2, true);
+    jeventpooltests::PlainSource source;
+    EventQueue queue(100);
+    JEventSourceArrow arrow("exhausted_pool", &source, &queue, pool);
+
+    REQUIRE(pool->has_available_events());
+    REQUIRE(!arrow.is_backpressured());
+
+    auto first = pool->get(0);
+    REQUIRE(pool->has_available_events());  // Location 1 still has one
+    REQUIRE(!arrow.is_backpressured());
+
+    auto second = pool->get(1);
+    REQUIRE(!pool->has_available_events());
+    REQUIRE(arrow.is_backpressured());  // So the scheduler lets workers park instead of visiting the source
+
+    pool->put(first, 0);
+    REQUIRE(pool->has_available_events());
+    REQUIRE(!arrow.is_backpressured());
+    pool->put(second, 1);
+
+    SECTION("A pool which may grow is never exhausted") {
+        JEventPool growing_pool(jcm, 1, 1, false);
+        auto event = growing_pool.get(0);
+        REQUIRE(growing_pool.has_available_events());
+        REQUIRE(growing_pool.get(0) != nullptr);
+    }
+}
+
+namespace jeventpooltests {
+
+struct SourceObject {};
+
+/// Keeps track of how many of these factories exist, across every factory set
+struct CountedFactory : public JFactoryT<SourceObject> {
+    static int alive;
+    CountedFactory() { alive++; }
+    ~CountedFactory() override { alive--; }
+};
+int CountedFactory::alive = 0;
+
+} // namespace jeventpooltests
+
+TEST_CASE("JEventPool: Factory sets of finished sources are freed") {
+    using namespace jeventpooltests;
+
+    JApplication app;
+    app.Initialize();
+    auto jcm = app.GetService<JComponentManager>();
+    JEventPool pool(jcm, 1, 1, true);
+    JFactoryGeneratorT<CountedFactory> generator;
+
+    // Files are read one after another, and at most two sources are open at any time
+    std::vector<std::unique_ptr<PlainSource>> sources;
+    for (size_t i=0; i<20; ++i) {
+        sources.emplace_back(new PlainSource);
+        sources.back()->SetFactoryGenerator(&generator);
+    }
+    for (size_t i=0; i<20; ++i) {
+        for (size_t j : {i, i+1}) {
+            if (j == 20) continue;
+            auto event = pool.get(0);
+            pool.switch_source(*event, sources[j].get());
+            REQUIRE(event->GetFactory<SourceObject>() != nullptr);
+            pool.put(event, 0);
+        }
+        sources[i]->DoFinalize();
+        REQUIRE(CountedFactory::alive <= 2);  // One set for each source which is still open
+    }
+    REQUIRE(pool.get_factory_set_build_count() == 20);
+}
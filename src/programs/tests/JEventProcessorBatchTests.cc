@@ -0,0 +1,112 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <catch.hpp>
+#include <JANA/JApplication.h>
+#include <JANA/JEventSource.h>
+#include <JANA/JEventProcessor.h>
+
+namespace jeventprocessorbatchtests {
+
+struct RunChangingSource : public JEventSource {
+    size_t event_count = 0;
+
+    RunChangingSource() : JEventSource("RunChangingSource", nullptr) {
+        SetTypeName("RunChangingSource");
+    }
+
+    // Emits 7 events per run
+    void GetEvent(std::shared_ptr<JEvent> event) override {
+        event->SetRunNumber(1 + event_count / 7);
+        event_count += 1;
+    }
+};
+
+struct BatchProcessor : public JEventProcessor {
+    std::mutex mutex;
+    size_t batch_count = 0;
+    size_t largest_batch = 0;
+    size_t processed_count = 0;
+    size_t begin_run_count = 0;
+    bool runs_are_uniform = true;
+
+    void BeginRun(const std::shared_ptr<const JEvent>&) override {
+        begin_run_count += 1;  // Already serialized by JEventProcessor
+    }
+
+    void ProcessBatch(const std::vector<std::shared_ptr<const JEvent>>& events) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch_count += 1;
+        largest_batch = std::max(largest_batch, events.size());
+        for (const auto& event : events) {
+            if (event->GetRunNumber() != events.front()->GetRunNumber()) runs_are_uniform = false;
+        }
+        processed_count += events.size();
+    }
+};
+
+struct PlainProcessor : public JEventProcessor {
+    std::atomic_int processed_count {0};
+    void Process(const std::shared_ptr<const JEvent>&) override {
+        processed_count += 1;
+    }
+};
+
+TEST_CASE("JEventProcessorArrow honors event_processor_chunksize") {
+
+    JApplication app;
+    app.Add(new RunChangingSource);
+    auto batch_proc = new BatchProcessor;
+    auto plain_proc = new PlainProcessor;
+    app.Add(batch_proc);
+    app.Add(plain_proc);
+    app.SetParameterValue("nthreads", 1);
+    app.SetParameterValue("jana:nevents", 70);
+    app.SetParameterValue("jana:event_pool_size", 20);
+    app.SetParameterValue("jana:event_source_chunksize", 10);
+    app.SetParameterValue("jana:event_processor_chunksize", 5);
+    app.Run(true);
+
+    // Every event is seen exactly once, by both the batched and the per-event API
+    REQUIRE(batch_proc->processed_count == 70);
+    REQUIRE(plain_proc->processed_count == 70);
+    REQUIRE(batch_proc->GetEventCount() == 70);
+
+    // Batches never exceed the chunksize and never straddle a run boundary
+    REQUIRE(batch_proc->largest_batch <= 5);
+    REQUIRE(batch_proc->largest_batch > 1);
+    REQUIRE(batch_proc->runs_are_uniform);
+    REQUIRE(batch_proc->begin_run_count == 10);
+}
+
+TEST_CASE("JEventProcessor::DoMapBatch splits batches by run number") {
+
+    BatchProcessor proc;
+    std::vector<std::shared_ptr<const JEvent>> events;
+    for (int i=0; i<6; ++i) {
+        auto event = std::make_shared<JEvent>();
+        event->SetRunNumber(i < 4 ? 22 : 23);
+        events.push_back(event);
+    }
+    proc.DoInitialize();  // The arrow always does this first
+    proc.DoMapBatch(events);
+    REQUIRE(proc.batch_count == 2);
+    REQUIRE(proc.largest_batch == 4);
+    REQUIRE(proc.begin_run_count == 2);
+    REQUIRE(proc.GetEventCount() == 6);
+    REQUIRE(proc.runs_are_uniform);
+}
+
+TEST_CASE("JEventProcessor::DoMap goes through ProcessBatch like the arrow does") {
+
+    BatchProcessor proc;
+    auto event = std::make_shared<JEvent>();
+    event->SetRunNumber(22);
+    proc.DoMap(event);  // E.g. from JDebugProcessingController
+    REQUIRE(proc.batch_count == 1);
+    REQUIRE(proc.processed_count == 1);
+    REQUIRE(proc.begin_run_count == 1);
+    REQUIRE(proc.GetEventCount() == 1);
+}
+
+} // namespace jeventprocessorbatchtests
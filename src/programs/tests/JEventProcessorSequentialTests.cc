@@ -7,6 +7,8 @@
 #include <JANA/JEventSource.h>
 #include <JANA/JEventProcessorSequential.h>
 #include <JANA/JEventProcessorSequentialRoot.h>
+#include <JANA/JFactoryGenerator.h>
+#include <JANA/Services/JTaskPool.h>
 
 namespace jeventprocessorsequentialtests {
 // If you reuse type names in different Catch tests (e.g. DummyFactory),
@@ -190,4 +192,122 @@ TEST_CASE("JEventProcessorSequentialTests") {
     }
 }
 
+TEST_CASE("JTaskPoolTests") {
+
+    SECTION("Disabled pool runs everything in order on the calling thread") {
+        JTaskPool pool;
+        std::vector<int> order;
+        std::vector<std::function<void()>> tasks;
+        for (int i=0; i<5; ++i) tasks.push_back([&order, i](){ order.push_back(i); });
+        pool.run_all(tasks);
+        REQUIRE(order == std::vector<int>({0,1,2,3,4}));
+        REQUIRE(pool.try_help() == false);
+    }
+
+    SECTION("Enabled pool runs every task exactly once") {
+        JTaskPool pool(true);
+        std::atomic<int> counts[20];
+        for (auto& c : counts) c = 0;
+        std::vector<std::function<void()>> tasks;
+        for (int i=0; i<20; ++i) tasks.push_back([&counts, i](){ counts[i]++; });
+
+        std::atomic<bool> done {false};
+        std::thread helper([&](){ while (!done) pool.try_help(); });
+        for (int rep=0; rep<50; ++rep) {
+            pool.run_all(tasks);
+        }
+        done = true;
+        helper.join();
+        for (auto& c : counts) REQUIRE(c == 50);
+    }
+
+    SECTION("Exceptions are rethrown once all tasks have finished") {
+        JTaskPool pool(true);
+        std::atomic<int> finished {0};
+        std::vector<std::function<void()>> tasks;
+        tasks.push_back([](){ throw JException("Task failed"); });
+        for (int i=0; i<3; ++i) tasks.push_back([&finished](){ finished++; });
+        REQUIRE_THROWS_AS(pool.run_all(tasks), JException);
+        REQUIRE(finished == 3);
+    }
+}
+
+struct RawHit { int value; };
+struct Track { int value; };
+struct Cluster { int value; };
+
+/// Both Track and Cluster depend on RawHit, so concurrent prefetches of those two race for it
+struct RawHitFactory : public JFactoryT<RawHit> {
+    std::atomic<int>* process_count;  // Shared by all RawHitFactories, which may be gone by the time the test checks
+    explicit RawHitFactory(std::atomic<int>* process_count) : process_count(process_count) {}
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        (*process_count)++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        Insert(new RawHit {(int) event->GetEventNumber()});
+    }
+};
+
+struct TrackFactory : public JFactoryT<Track> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        auto hits = event->Get<RawHit>();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        Insert(new Track {hits.at(0)->value * 10});
+    }
+};
+
+struct ClusterFactory : public JFactoryT<Cluster> {
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        auto hits = event->Get<RawHit>();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        Insert(new Cluster {hits.at(0)->value * 100});
+    }
+};
+
+struct PrefetchGenerator : public JFactoryGenerator {
+    std::atomic<int> raw_hit_process_count {0};
+    void GenerateFactories(JFactorySet* factory_set) override {
+        factory_set->Add(new RawHitFactory(&raw_hit_process_count));
+        factory_set->Add(new TrackFactory);
+        factory_set->Add(new ClusterFactory);
+    }
+};
+
+struct PrefetchingProcessor : public JEventProcessorSequential {
+    PrefetchT<Track> tracks = {this};
+    PrefetchT<Cluster> clusters = {this};
+    int event_count = 0;
+    bool all_correct = true;
+
+    void ProcessSequential(const std::shared_ptr<const JEvent>& event) override {
+        event_count++;
+        int n = (int) event->GetEventNumber();
+        all_correct &= (tracks().size() == 1 && tracks()[0]->value == n * 10);
+        all_correct &= (clusters().size() == 1 && clusters()[0]->value == n * 100);
+    }
+};
+
+TEST_CASE("JEventProcessorSequentialParallelPrefetchTests") {
+
+    auto enabled = GENERATE(false, true);
+
+    JParameterManager *params = new JParameterManager;
+    JApplication app(params);
+    app.Add(new DummySource);
+    auto generator = new PrefetchGenerator;
+    app.Add(generator);
+    auto proc = new PrefetchingProcessor;
+    app.Add(proc);
+    app.SetParameterValue("nthreads", 1);
+    app.SetParameterValue("jana:nevents", 20);
+    app.SetParameterValue("jana:intraevent_parallelism", enabled);
+    app.SetParameterValue("jana:intraevent_threads", 2);
+    app.Run(true);
+
+    REQUIRE(proc->event_count == 20);
+    REQUIRE(proc->all_correct);
+
+    // The shared upstream factory ran exactly once per event, even when both prefetches asked for it at the same time
+    REQUIRE(generator->raw_hit_process_count == 20);
+}
+
 } // namespace
\ No newline at end of file
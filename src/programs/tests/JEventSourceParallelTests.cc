@@ -0,0 +1,118 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+
+#include <JANA/JApplication.h>
+#include <JANA/JEventSource.h>
+#include <JANA/JEventProcessor.h>
+
+#include <chrono>
+#include <set>
+#include <thread>
+
+namespace jeventsourceparalleltests {
+
+/// Reads records 0..record_count-1, each of which takes a while to come in, like a seekable file on a slow disk
+struct RecordSource : public JEventSource {
+    size_t record_count;
+    bool busy_sometimes;
+    std::atomic_int concurrent_calls {0};
+    std::atomic_int max_concurrent_calls {0};
+    std::atomic_int call_count {0};
+
+    RecordSource(size_t record_count, bool parallel, bool busy_sometimes)
+        : JEventSource("RecordSource", nullptr), record_count(record_count), busy_sometimes(busy_sometimes) {
+        SetTypeName("RecordSource");
+        if (parallel) EnableParallelGetEvent();
+    }
+
+    void GetEvent(std::shared_ptr<JEvent> event) override {
+        int concurrent = ++concurrent_calls;
+        int max_concurrent = max_concurrent_calls;
+        while (concurrent > max_concurrent && !max_concurrent_calls.compare_exchange_weak(max_concurrent, concurrent)) {}
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        concurrent_calls -= 1;
+
+        if (busy_sometimes && ++call_count % 5 == 0) {
+            throw RETURN_STATUS::kBUSY;
+        }
+        if (event->GetEventNumber() >= record_count) {
+            throw RETURN_STATUS::kNO_MORE_EVENTS;
+        }
+    }
+};
+
+struct RecordProcessor : public JEventProcessor {
+    std::mutex mutex;
+    std::multiset<uint64_t> event_numbers;
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        event_numbers.insert(event->GetEventNumber());
+    }
+};
+
+/// What the source and processor saw, copied out before the JApplication deletes them
+struct RunResult {
+    std::multiset<uint64_t> event_numbers;  // The event numbers which reached the processor
+    int max_concurrent_calls;
+    uint64_t event_count;
+};
+
+RunResult run(RecordSource* source, size_t nskip, size_t nevents) {
+    JApplication app;
+    auto processor = new RecordProcessor;
+    app.Add(source);
+    app.Add(processor);
+    app.SetParameterValue("nthreads", 4);
+    app.SetParameterValue("jana:nskip", nskip);
+    app.SetParameterValue("jana:nevents", nevents);
+    app.SetParameterValue("jana:event_source_chunksize", 1);
+    app.SetParameterValue("log:global", "OFF");
+    app.Run(true);
+    return RunResult {processor->event_numbers, source->max_concurrent_calls, source->GetEventCount()};
+}
+
+std::multiset<uint64_t> range(uint64_t first, uint64_t last) {
+    std::multiset<uint64_t> result;
+    for (uint64_t i=first; i<last; ++i) result.insert(i);
+    return result;
+}
+
+} // namespace jeventsourceparalleltests
+
+
+TEST_CASE("JEventSourceParallelTests") {
+    using namespace jeventsourceparalleltests;
+
+    SECTION("Sources are serialized by default") {
+        auto result = run(new RecordSource(200, false, false), 0, 0);
+        REQUIRE(result.event_numbers == range(0, 200));
+        REQUIRE(result.max_concurrent_calls == 1);
+    }
+
+    SECTION("Parallel sources read several events at once") {
+        auto result = run(new RecordSource(200, true, false), 0, 0);
+        REQUIRE(result.event_numbers == range(0, 200));
+        REQUIRE(result.max_concurrent_calls > 1);
+    }
+
+    SECTION("Parallel sources honor nskip and nevents exactly") {
+        auto result = run(new RecordSource(200, true, false), 30, 100);
+        REQUIRE(result.event_numbers == range(30, 130));
+        REQUIRE(result.event_count == 130);
+    }
+
+    SECTION("Parallel sources running out early emit every event exactly once") {
+        auto result = run(new RecordSource(75, true, false), 10, 100);
+        REQUIRE(result.event_numbers == range(10, 75));
+    }
+
+    SECTION("Event numbers of failed reads are retried, not skipped") {
+        auto result = run(new RecordSource(200, true, true), 20, 150);
+        REQUIRE(result.event_numbers == range(20, 170));
+        REQUIRE(result.event_count == 170);
+    }
+}
@@ -8,6 +8,9 @@
 #include <JANA/JEvent.h>
 #include "JEventTests.h"
 
+#include <chrono>
+#include <iomanip>
+
 
 TEST_CASE("JEventInsertTests") {
 
@@ -216,3 +219,51 @@ TEST_CASE("JEventInsertTests") {
 
 }
 
+
+
+namespace jeventtests {
+
+/// Returns the mean wall time of one call to fn, in nanoseconds
+template <typename F>
+double time_per_call_ns(size_t iterations, F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0; i<iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+} // namespace jeventtests
+
+
+TEST_CASE("JEventGetOverheadBenchmark", "[.][performance]") {
+
+    const size_t iterations = 1000000;
+    auto event = std::make_shared<JEvent>();
+    event->SetFactorySet(new JFactorySet);
+    event->Insert(new FakeJObject(22));
+    size_t sink = 0;
+
+    auto get = [&](){ sink += event->Get<FakeJObject>().size(); };
+
+    // What every Get<T> used to pay before the demangled name was cached
+    auto legacy_demangle = [&](){ sink += JTypeInfo::demangle<FakeJObject>().size(); };
+
+    std::cout << " scenario                    | ns/call" << std::endl;
+    std::cout << "-----------------------------+---------" << std::endl;
+    auto report = [](const std::string& name, double ns) {
+        std::cout << " " << std::left << std::setw(27) << name << " | "
+                  << std::right << std::setw(7) << std::fixed << std::setprecision(1) << ns << std::endl;
+    };
+
+    report("Get<T>", jeventtests::time_per_call_ns(iterations, get));
+    report("demangle<T> (old per-Get)", jeventtests::time_per_call_ns(iterations, legacy_demangle));
+
+    event->SetDefaultTags({{"SomeOtherObject", "tag"}});
+    report("Get<T>, default tags set", jeventtests::time_per_call_ns(iterations, get));
+    event->SetDefaultTags({});
+
+    event->GetJCallGraphRecorder()->SetEnabled();
+    report("Get<T>, call graph enabled", jeventtests::time_per_call_ns(iterations / 10, get));
+    REQUIRE(sink > 0);
+}
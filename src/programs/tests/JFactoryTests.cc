@@ -8,6 +8,17 @@
 
 #include <JANA/JEvent.h>
 #include <JANA/JFactoryT.h>
+#include <JANA/JFactorySet.h>
+
+// The arena benchmark runs JTest's tracker, which only needs JANA itself, so the JTest plugin needn't be built
+#include "../../plugins/JTest/JTestTracker.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <new>
+#include <thread>
 
 TEST_CASE("JFactoryTests") {
 
@@ -139,3 +150,650 @@ TEST_CASE("JFactoryTests") {
     }
 }
 
+
+
+TEST_CASE("JFactoryConcurrentGetOrCreateTests") {
+
+    JFactoryTestDummyFactory sut;
+    auto event = std::make_shared<JEvent>();
+    const int thread_count = 8;
+    const int event_count = 200;
+
+    for (int evt=0; evt<event_count; ++evt) {
+        std::atomic<int> ready_count {0};
+        std::atomic<int> wrong_size_count {0};
+        std::vector<std::thread> threads;
+        for (int t=0; t<thread_count; ++t) {
+            threads.emplace_back([&](){
+                ready_count++;
+                while (ready_count < thread_count) {}  // Maximize contention on the first call
+                auto results = sut.GetOrCreate(event, nullptr, 0);
+                if (std::distance(results.first, results.second) != 3) wrong_size_count++;
+            });
+        }
+        for (auto& t : threads) t.join();
+        REQUIRE(wrong_size_count == 0);
+        REQUIRE(sut.process_call_count == evt + 1);
+        sut.ClearData();
+    }
+    REQUIRE(sut.init_call_count == 1);
+    REQUIRE(sut.change_run_call_count == 1);
+
+    SECTION("Published data is retracted by ClearData") {
+        sut.GetOrCreate(event, nullptr, 0);
+        REQUIRE(sut.process_call_count == event_count + 1);
+        sut.GetOrCreate(event, nullptr, 0);
+        REQUIRE(sut.process_call_count == event_count + 1);
+        sut.ClearData();
+        sut.GetOrCreate(event, nullptr, 0);
+        REQUIRE(sut.process_call_count == event_count + 2);
+    }
+}
+
+namespace jfactorytests {
+
+/// Overrides the non-owning hooks, and checks that nobody took a reference to the event on the way there
+struct ByReferenceFactory : public JFactoryT<JFactoryTestDummyObject> {
+    std::weak_ptr<const JEvent> owner;
+    long max_use_count = 0;
+    int begin_run_call_count = 0;
+    int process_call_count = 0;
+
+    void BeginRun(const JEvent& event) override {
+        begin_run_call_count++;
+        max_use_count = std::max(max_use_count, owner.use_count());
+        REQUIRE(event.GetRunNumber() == 7);
+    }
+    void Process(const JEvent&) override {
+        process_call_count++;
+        max_use_count = std::max(max_use_count, owner.use_count());
+        Insert(new JFactoryTestDummyObject(1));
+    }
+};
+
+} // namespace jfactorytests
+
+TEST_CASE("JFactoryByReferenceTests") {
+    using namespace jfactorytests;
+
+    auto event = std::make_shared<JEvent>();
+    event->SetRunNumber(7);
+    auto factory = new ByReferenceFactory;
+    factory->owner = event;
+    auto factory_set = new JFactorySet;
+    factory_set->Add(factory);
+    event->SetFactorySet(factory_set);
+
+    SECTION("Get reaches the non-owning hooks without touching the event's refcount") {
+        REQUIRE(event->Get<JFactoryTestDummyObject>().size() == 1);
+        REQUIRE(event->GetSingle<JFactoryTestDummyObject>()->data == 1);
+        REQUIRE(factory->begin_run_call_count == 1);
+        REQUIRE(factory->process_call_count == 1);
+        REQUIRE(factory->max_use_count == 1);
+    }
+
+    SECTION("The shared_ptr shim calls the same hooks") {
+        auto results = factory->GetOrCreate(event, nullptr, 7);
+        REQUIRE(std::distance(results.first, results.second) == 1);
+        REQUIRE(factory->process_call_count == 1);
+    }
+
+    SECTION("Factories which only override the shared_ptr hooks still get a shared_ptr") {
+        auto legacy = new JFactoryTestDummyFactory;
+        legacy->SetTag("legacy");
+        factory_set->Add(legacy);
+        REQUIRE(event->Get<JFactoryTestDummyObject>("legacy").size() == 3);
+        REQUIRE(legacy->process_call_count == 1);
+        REQUIRE(legacy->change_run_call_count == 1);
+    }
+}
+
+TEST_CASE("JFactorySetLookupTests") {
+
+    struct OtherObject {};
+
+    JFactorySet sut;
+    auto untagged = new JFactoryT<JFactoryTestDummyObject>;
+    auto tagged = new JFactoryT<JFactoryTestDummyObject>;
+    tagged->SetTag("special");
+    auto other = new JFactoryT<OtherObject>;
+    sut.Add(untagged);
+    sut.Add(tagged);
+    sut.Add(other);
+
+    SECTION("Typed lookup finds factories by type and tag") {
+        REQUIRE(sut.GetFactory<JFactoryTestDummyObject>() == untagged);
+        REQUIRE(sut.GetFactory<JFactoryTestDummyObject>("special") == tagged);
+        REQUIRE(sut.GetFactory<JFactoryTestDummyObject>("missing") == nullptr);
+        REQUIRE(sut.GetFactory<OtherObject>() == other);
+        REQUIRE(sut.GetFactory<OtherObject>("special") == nullptr);
+        REQUIRE(sut.GetAllFactories<JFactoryTestDummyObject>().size() == 2);
+        REQUIRE(sut.GetAllFactories<OtherObject>().size() == 1);
+    }
+
+    SECTION("Types which have no factories in this set are not found") {
+        struct UnregisteredObject {};
+        REQUIRE(sut.GetFactory<UnregisteredObject>() == nullptr);
+        REQUIRE(sut.GetAllFactories<UnregisteredObject>().empty());
+    }
+
+    SECTION("String lookup still works") {
+        REQUIRE(sut.GetFactory("JFactoryTestDummyObject", "special") == tagged);
+    }
+
+    SECTION("Duplicates are rejected by Add and left behind by Merge") {
+        JFactoryT<OtherObject> rejected; // Add() only takes ownership on success
+        REQUIRE_THROWS(sut.Add(&rejected));
+
+        JFactorySet source;
+        auto duplicate = new JFactoryT<JFactoryTestDummyObject>;
+        auto fresh = new JFactoryT<JFactoryTestDummyObject>;
+        fresh->SetTag("fresh");
+        source.Add(duplicate);
+        source.Add(fresh);
+        sut.Merge(source);
+
+        REQUIRE(sut.GetFactory<JFactoryTestDummyObject>() == untagged);
+        REQUIRE(sut.GetFactory<JFactoryTestDummyObject>("fresh") == fresh);
+        REQUIRE(source.GetFactory<JFactoryTestDummyObject>() == duplicate);
+        REQUIRE(source.GetFactory<JFactoryTestDummyObject>("fresh") == nullptr);
+        REQUIRE(source.GetAllFactories().size() == 1);
+    }
+}
+
+
+namespace jfactorytests {
+
+/// Counts how often the JFactorySet clears it
+struct ClearCountingFactory : public JFactoryTestDummyFactory {
+    int clear_count = 0;
+    explicit ClearCountingFactory(std::string tag) { SetTag(std::move(tag)); }
+    void ClearData() override {
+        ++clear_count;
+        JFactoryTestDummyFactory::ClearData();
+    }
+};
+
+/// Builds a factory set of `count` tagged factories, like a large reconstruction with many plugins
+std::vector<ClearCountingFactory*> add_counting_factories(JFactorySet* factory_set, size_t count) {
+    std::vector<ClearCountingFactory*> factories;
+    for (size_t i=0; i<count; ++i) {
+        factories.push_back(new ClearCountingFactory("tag" + std::to_string(i)));
+        factory_set->Add(factories.back());
+    }
+    return factories;
+}
+
+/// Implements JFactory directly, so it never marks itself dirty
+struct UntrackedFactory : public JFactory {
+    std::vector<JObject*> data;
+    int clear_count = 0;
+    UntrackedFactory() : JFactory("UntrackedFactory", "") {}
+    ~UntrackedFactory() override { ClearData(); }
+    std::type_index GetObjectType() const override { return std::type_index(typeid(UntrackedFactory)); }
+    void ClearData() override {
+        ++clear_count;
+        for (auto obj : data) delete obj;
+        data.clear();
+    }
+    size_t Create(const std::shared_ptr<const JEvent>&, JApplication*, uint64_t) override { return data.size(); }
+    void Set(const std::vector<JObject*>& objs) override { ClearData(); data = objs; }
+    void Insert(JObject* obj) override { data.push_back(obj); }
+    std::size_t GetNumObjects() const override { return data.size(); }
+};
+
+} // namespace jfactorytests
+
+TEST_CASE("JFactorySetReleaseTests") {
+    using namespace jfactorytests;
+
+    auto event = std::make_shared<JEvent>();
+    auto factory_set = new JFactorySet;
+    event->SetFactorySet(factory_set);
+    auto factories = add_counting_factories(factory_set, 400);
+
+    SECTION("Only the factories an event touched get cleared") {
+        for (size_t i=0; i<400; i+=7) {
+            REQUIRE(event->Get<JFactoryTestDummyObject>("tag" + std::to_string(i)).size() == 3);
+        }
+        factory_set->Release();
+        for (size_t i=0; i<400; ++i) {
+            REQUIRE(factories[i]->clear_count == ((i % 7 == 0) ? 1 : 0));
+            REQUIRE(factories[i]->GetNumObjects() == 0);
+        }
+
+        // The next event starts from a clean list
+        event->Get<JFactoryTestDummyObject>("tag1");
+        factory_set->Release();
+        factory_set->Release();
+        REQUIRE(factories[0]->clear_count == 1);
+        REQUIRE(factories[1]->clear_count == 1);
+        REQUIRE(factories[1]->process_call_count == 1);
+    }
+
+    SECTION("Inserted data gets cleared") {
+        bool destroyed = false;
+        event->Insert(new JFactoryTestDummyObject(1, &destroyed), "tag3");
+        auto inserted_into_new_factory = event->Insert(new JFactoryTestDummyObject(2), "brand_new");
+        factory_set->Release();
+        REQUIRE(destroyed);
+        REQUIRE(factories[3]->clear_count == 1);
+        REQUIRE(inserted_into_new_factory->GetNumObjects() == 0);
+    }
+
+    SECTION("Factories which already hold data are still cleared after a merge") {
+        auto filled = new ClearCountingFactory("filled_before_merge");
+        filled->Insert(new JFactoryTestDummyObject(1));
+        JFactorySet source;
+        source.Add(filled);
+        source.Add(new ClearCountingFactory("tag5"));  // Duplicate, stays behind
+        source.GetFactory<JFactoryTestDummyObject>("tag5")->Insert(new JFactoryTestDummyObject(2));
+        factory_set->Merge(source);
+
+        factory_set->Release();
+        REQUIRE(filled->clear_count == 1);
+        REQUIRE(factories[5]->clear_count == 0);
+        source.Release();
+        REQUIRE(static_cast<ClearCountingFactory*>(source.GetFactory<JFactoryTestDummyObject>("tag5"))->clear_count == 1);
+    }
+
+    SECTION("Factories which don't mark themselves dirty are cleared every time") {
+        auto untracked = new UntrackedFactory;
+        factory_set->Add(untracked);
+        bool destroyed = false;
+        untracked->Insert(new JFactoryTestDummyObject(1, &destroyed));
+        factory_set->Release();
+        REQUIRE(destroyed);
+        REQUIRE(untracked->GetNumObjects() == 0);
+        factory_set->Release();
+        REQUIRE(untracked->clear_count == 2);
+        REQUIRE(factories[0]->clear_count == 0);
+    }
+
+    SECTION("Factories may be touched from several threads at once") {
+        std::vector<std::thread> threads;
+        for (size_t t=0; t<8; ++t) {
+            threads.emplace_back([&, t](){
+                for (size_t i=t; i<400; i+=8) event->Get<JFactoryTestDummyObject>("tag" + std::to_string(i));
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        factory_set->Release();
+        for (auto factory : factories) REQUIRE(factory->clear_count == 1);
+    }
+}
+
+TEST_CASE("JFactorySetReleaseBenchmark", "[.][performance]") {
+    using namespace jfactorytests;
+
+    // A typical event in a large reconstruction: ~400 factories, of which ~60 are used
+    const size_t event_count = 20000;
+    std::cout << "  factories | touched | clear all [ns/event] | Release [ns/event]" << std::endl;
+    std::cout << "------------+---------+----------------------+-------------------" << std::endl;
+    for (size_t factory_count : {100, 400, 1600}) {
+        for (size_t touched : {0, 60}) {
+            auto event = std::make_shared<JEvent>();
+            auto factory_set = new JFactorySet;
+            event->SetFactorySet(factory_set);
+            auto factories = add_counting_factories(factory_set, factory_count);
+            std::vector<std::string> tags;
+            for (size_t i=0; i<touched; ++i) tags.push_back("tag" + std::to_string(i * factory_count / touched));
+
+            // Only the recycling is timed, not the event itself
+            auto measure_ns = [&](const std::function<void()>& release) {
+                std::chrono::steady_clock::duration elapsed {0};
+                for (size_t i=0; i<event_count; ++i) {
+                    for (const auto& tag : tags) event->Get<JFactoryTestDummyObject>(tag);
+                    auto start = std::chrono::steady_clock::now();
+                    release();
+                    elapsed += std::chrono::steady_clock::now() - start;
+                }
+                return std::chrono::duration<double, std::nano>(elapsed).count() / event_count;
+            };
+
+            // What Release() used to do: visit every factory in the set
+            auto all = factory_set->GetAllFactories();
+            double clear_all_ns = measure_ns([&]{ for (auto f : all) f->ClearData(); factory_set->Release(); });
+            double release_ns = measure_ns([&]{ factory_set->Release(); });
+
+            std::cout << std::setw(10) << factory_count << " | "
+                      << std::setw(7) << touched << " | "
+                      << std::setw(20) << std::fixed << std::setprecision(0) << clear_all_ns << " | "
+                      << std::setw(17) << release_ns << std::endl;
+        }
+    }
+}
+
+
+TEST_CASE("JFactoryArenaTests") {
+
+    auto event = std::make_shared<JEvent>();
+    auto heap_count_before = JFactoryTestHit::heap_allocation_count().load();
+
+    SECTION("With USE_ARENA, objects are destroyed by ClearData and their memory is reused") {
+        JFactoryTestHitFactory sut(100, true);
+        auto first = sut.GetOrCreate(event, nullptr, 0);
+        REQUIRE(std::distance(first.first, first.second) == 100);
+        const JFactoryTestHit* first_hit = *first.first;
+        REQUIRE(sut.GetArena() != nullptr);
+        REQUIRE(sut.GetArena()->Owns(first_hit));
+
+        bool destroyed = false;
+        sut.Insert(sut.Construct(-1, &destroyed));
+        sut.ClearData();
+        REQUIRE(destroyed == true);
+
+        auto second = sut.GetOrCreate(event, nullptr, 0);
+        REQUIRE(*second.first == first_hit);
+        REQUIRE(sut.GetArena()->GetChunkAllocationCount() == 1);
+        REQUIRE(JFactoryTestHit::heap_allocation_count() == heap_count_before);
+        sut.ClearData();
+    }
+
+    SECTION("Without USE_ARENA, every object comes from the heap") {
+        JFactoryTestHitFactory sut(100, false);
+        sut.GetOrCreate(event, nullptr, 0);
+        REQUIRE(sut.GetArena() == nullptr);
+        REQUIRE(JFactoryTestHit::heap_allocation_count() == heap_count_before + 100);
+        sut.ClearData();
+    }
+
+    SECTION("Heap-allocated objects may be mixed in with arena-allocated ones") {
+        JFactoryTestHitFactory sut(10, true);
+        sut.GetOrCreate(event, nullptr, 0);
+        bool destroyed = false;
+        sut.Insert(new JFactoryTestHit(-1, &destroyed));
+        sut.ClearData();
+        REQUIRE(destroyed == true);
+    }
+
+    SECTION("Set() keeps objects which were just constructed in the arena") {
+        JFactoryTestHitFactory sut(10, true);
+        sut.GetOrCreate(event, nullptr, 0);
+        bool old_destroyed = false;
+        bool new_destroyed = false;
+        sut.Insert(sut.Construct(-1, &old_destroyed));
+        auto replacement = sut.Construct(42, &new_destroyed);
+        sut.Set(std::vector<JFactoryTestHit*> {replacement});
+        REQUIRE(old_destroyed == true);
+        REQUIRE(new_destroyed == false);
+
+        // The arena wasn't rewound, so the next object can't land on top of the replacement
+        auto next = sut.Construct(43);
+        REQUIRE(replacement->data == 42);
+        sut.Insert(next);
+        sut.ClearData();
+        REQUIRE(new_destroyed == true);
+    }
+
+    SECTION("NOT_OBJECT_OWNER factories don't allocate from their arena") {
+        JFactoryTestHitFactory sut(10, true);
+        sut.SetFactoryFlag(JFactory::NOT_OBJECT_OWNER);
+        auto hit = sut.Construct(1);
+        REQUIRE(sut.GetArena() == nullptr);
+        REQUIRE(JFactoryTestHit::heap_allocation_count() == heap_count_before + 1);
+        delete hit;
+    }
+
+    SECTION("PERSISTENT factories keep their arena-allocated objects") {
+        JFactoryTestHitFactory sut(10, true);
+        sut.SetFactoryFlag(JFactory::PERSISTENT);
+        sut.GetOrCreate(event, nullptr, 0);
+        bool destroyed = false;
+        sut.Insert(sut.Construct(-1, &destroyed));
+        sut.ClearData();
+        REQUIRE(destroyed == false);
+        sut.ClearFactoryFlag(JFactory::PERSISTENT);
+        sut.ClearData();
+        REQUIRE(destroyed == true);
+    }
+
+    SECTION("An arena which spilled into several chunks settles into one") {
+        JArena arena(64);
+        for (size_t size : {48, 100, 200}) arena.Allocate(size, 8);
+        REQUIRE(arena.GetChunkAllocationCount() == 3);
+        auto capacity = arena.GetCapacity();
+
+        arena.Reset();
+        REQUIRE(arena.GetCapacity() == capacity);
+        REQUIRE(arena.GetChunkAllocationCount() == 4);
+        for (size_t size : {48, 100, 200}) REQUIRE(arena.Owns(arena.Allocate(size, 8)));
+        REQUIRE(arena.GetChunkAllocationCount() == 4);
+
+        arena.Reset();
+        REQUIRE(arena.GetChunkAllocationCount() == 4);
+    }
+}
+
+
+TEST_CASE("JValueFactoryTests") {
+
+    auto event = std::make_shared<JEvent>();
+    auto factory = new JFactoryTestAdcHitFactory(1000);
+    auto factory_set = new JFactorySet;
+    factory_set->Add(factory);
+    event->SetFactorySet(factory_set);
+
+    SECTION("Get<T> sees every by-value object through a pointer, even after the storage grew") {
+        auto hits = event->Get<JFactoryTestAdcHit>();
+        auto& values = event->GetValues<JFactoryTestAdcHit>();
+        REQUIRE(hits.size() == 1000);
+        REQUIRE(values.size() == 1000);
+        for (size_t i=0; i<hits.size(); ++i) {
+            REQUIRE(hits[i] == &values[i]);
+        }
+        REQUIRE(hits[999]->channel == 999);
+    }
+
+    SECTION("Columns can be gathered from the by-value objects") {
+        event->GetValues<JFactoryTestAdcHit>();
+        auto adcs = factory->GetColumn(&JFactoryTestAdcHit::adc);
+        REQUIRE(adcs.size() == 1000);
+        REQUIRE(adcs[10] == 5.0);
+    }
+
+    SECTION("Storage is reused across events") {
+        auto first = event->GetValues<JFactoryTestAdcHit>().data();
+        factory_set->Release();
+        REQUIRE(factory->GetValues().empty());
+        auto second = event->GetValues<JFactoryTestAdcHit>().data();
+        REQUIRE(first == second);
+    }
+
+    SECTION("Objects inserted as pointers are owned as usual but aren't part of GetValues") {
+        factory->Reserve(2000);
+        event->GetValues<JFactoryTestAdcHit>();
+        factory->Insert(new JFactoryTestAdcHit(-1, 0));
+        factory->Emplace(1000, 0);
+        REQUIRE(event->Get<JFactoryTestAdcHit>().size() == 1002);
+        REQUIRE(factory->GetValues().size() == 1001);
+        factory_set->Release();
+        REQUIRE(event->Get<JFactoryTestAdcHit>().size() == 1000);
+    }
+
+    SECTION("GetValues rejects factories which don't store by value") {
+        event->Insert(new JFactoryTestDummyObject(22));
+        REQUIRE_THROWS(event->GetValues<JFactoryTestDummyObject>());
+    }
+}
+
+
+namespace jfactorytests {
+
+/// Set by the arena benchmark around the events it times, so that everything else pays for a single branch
+thread_local bool g_count_heap_allocations = false;
+thread_local size_t g_heap_allocation_count = 0;
+
+} // namespace jfactorytests
+
+// Replacing the global operator new is the only way to see the heap allocations JTest's tracker makes. The array and
+// sized forms forward here by default.
+void* operator new(size_t size) {
+    if (jfactorytests::g_count_heap_allocations) jfactorytests::g_heap_allocation_count++;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+TEST_CASE("JFactoryArenaAllocationBenchmark", "[.][performance]") {
+    using namespace jfactorytests;
+
+    // Runs JTest's tracker with jtest:tracker_objects=hit_count. The CPU and memory load are turned off, so the time
+    // per event is mostly spent creating and recycling the tracker's objects. Every event, the factory gets recycled
+    // via JFactorySet::Release(), just like JEventPool::get() does.
+    const size_t event_count = 20000;
+
+    std::cout << "  hits/event |  arena | arena chunks | heap allocs/event | ns/event" << std::endl;
+    std::cout << "-------------+--------+--------------+-------------------+---------" << std::endl;
+    for (size_t hit_count : {10, 100, 1000}) {
+        for (bool use_arena : {false, true}) {
+            JApplication app;
+            app.SetParameterValue("jtest:tracker_ms", 0);
+            app.SetParameterValue("jtest:tracker_spread", 0);
+            app.SetParameterValue("jtest:tracker_bytes", 0);
+            app.SetParameterValue("jtest:tracker_bytes_spread", 0);
+            app.SetParameterValue("jtest:tracker_objects", hit_count);
+            app.SetParameterValue("jtest:use_arena", use_arena);
+
+            auto event = std::make_shared<JEvent>(&app);
+            auto factory = new JTestTracker;
+            factory->SetApplication(&app);
+            auto factory_set = new JFactorySet;
+            factory_set->Add(factory);
+            event->SetFactorySet(factory_set);
+
+            g_heap_allocation_count = 0;
+            g_count_heap_allocations = true;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i=0; i<event_count; ++i) {
+                event->Insert(new JTestEventData);  // What JTest's source and disentangler would have provided
+                event->Get<JTestTrackData>();
+                factory_set->Release();
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            g_count_heap_allocations = false;
+
+            std::cout << std::setw(12) << hit_count << " | "
+                      << std::setw(6) << (use_arena ? "yes" : "no") << " | "
+                      << std::setw(12) << (factory->GetArena() ? factory->GetArena()->GetChunkAllocationCount() : 0) << " | "
+                      << std::setw(17) << std::fixed << std::setprecision(1)
+                      << static_cast<double>(g_heap_allocation_count) / event_count << " | "
+                      << std::setw(8) << std::fixed << std::setprecision(1)
+                      << std::chrono::duration<double, std::nano>(elapsed).count() / event_count << std::endl;
+        }
+    }
+}
+
+
+namespace jfactorytests {
+
+/// Each link of the chain sums up several Gets of the link below it
+template <int N> struct ChainLink { long value; };
+
+constexpr int kGetsPerLink = 4;
+
+/// legacy=true copies what JEvent::Get used to cost: a shared_from_this() around every single Get
+template <int N>
+struct ChainFactory : public JFactoryT<ChainLink<N>> {
+    bool legacy;
+    explicit ChainFactory(bool legacy) : legacy(legacy) {}
+    void Process(const JEvent& event) override {
+        long sum = 1;
+        for (int i=0; i<kGetsPerLink; ++i) {
+            if (legacy) {
+                auto keepalive = event.shared_from_this();
+                sum += keepalive->GetSingle<ChainLink<N-1>>()->value;
+            }
+            else {
+                sum += event.GetSingle<ChainLink<N-1>>()->value;
+            }
+        }
+        this->Insert(new ChainLink<N> {sum});
+    }
+};
+
+template <>
+struct ChainFactory<0> : public JFactoryT<ChainLink<0>> {
+    explicit ChainFactory(bool) {}
+    void Process(const JEvent&) override { Insert(new ChainLink<0> {1}); }
+};
+
+inline void add_chain(JFactorySet* factory_set, bool legacy, std::integral_constant<int, 0>) {
+    factory_set->Add(new ChainFactory<0>(legacy));
+}
+
+template <int N>
+void add_chain(JFactorySet* factory_set, bool legacy, std::integral_constant<int, N>) {
+    factory_set->Add(new ChainFactory<N>(legacy));
+    add_chain(factory_set, legacy, std::integral_constant<int, N-1>());
+}
+
+} // namespace jfactorytests
+
+TEST_CASE("JEventGetByReferenceBenchmark", "[.][performance]") {
+    using namespace jfactorytests;
+
+    const int depth = 32;
+    using Top = ChainLink<depth>;
+
+    // A whole event: every link is computed once, and asked for kGetsPerLink times by the link above it
+    std::cout << "Factory chain of depth " << depth << ", " << kGetsPerLink << " Gets per link" << std::endl;
+    std::cout << "  variant           | ns/event (1 thread)" << std::endl;
+    for (bool legacy : {true, false}) {
+        auto event = std::make_shared<JEvent>();
+        auto factory_set = new JFactorySet;
+        add_chain(factory_set, legacy, std::integral_constant<int, depth>());
+        event->SetFactorySet(factory_set);
+        const size_t event_count = 20000;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i=0; i<event_count; ++i) {
+            event->GetSingle<Top>();
+            factory_set->Release();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << std::setw(17) << std::left << (legacy ? "shared_from_this" : "by reference") << std::right
+                  << " | " << std::setw(10) << std::fixed << std::setprecision(0) << elapsed / event_count << std::endl;
+    }
+
+    // Many threads reading already-computed data from the same event, as with intra-event parallelism
+    std::cout << "  variant           | threads | ns/Get" << std::endl;
+    for (size_t thread_count : {1, 4, 8}) {
+        for (bool legacy : {true, false}) {
+            auto event = std::make_shared<JEvent>();
+            auto factory_set = new JFactorySet;
+            add_chain(factory_set, false, std::integral_constant<int, depth>());
+            event->SetFactorySet(factory_set);
+            event->GetSingle<Top>();
+
+            const size_t get_count = 1000000;
+            std::atomic<size_t> ready_count {0};
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t t=0; t<thread_count; ++t) {
+                threads.emplace_back([&](){
+                    ready_count++;
+                    while (ready_count < thread_count) {}
+                    const JEvent& e = *event;
+                    for (size_t i=0; i<get_count; ++i) {
+                        if (legacy) {
+                            auto keepalive = e.shared_from_this();
+                            keepalive->GetSingle<ChainLink<depth/2>>();
+                        }
+                        else {
+                            e.GetSingle<ChainLink<depth/2>>();
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "  " << std::setw(17) << std::left << (legacy ? "shared_from_this" : "by reference") << std::right
+                      << " | " << std::setw(7) << thread_count << " | " << std::setw(6) << std::setprecision(1)
+                      << elapsed / get_count << std::endl;
+        }
+    }
+}
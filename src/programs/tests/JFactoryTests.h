@@ -7,8 +7,11 @@
 
 #include <JANA/JObject.h>
 #include <JANA/JFactoryT.h>
+#include <JANA/JValueFactoryT.h>
 #include <JANA/JEventSource.h>
 
+#include <atomic>
+
 /// DummyObject is a trivial JObject which reports its own destruction.
 struct JFactoryTestDummyObject : public JObject {
 
@@ -51,6 +54,72 @@ struct JFactoryTestDummyFactory : public JFactoryT<JFactoryTestDummyObject> {
 };
 
 
+/// JFactoryTestHit counts how often it gets allocated on the heap, so that tests can tell whether
+/// a factory allocated it from its arena instead
+struct JFactoryTestHit : public JObject {
+
+    int data;
+    bool* is_destroyed_flag = nullptr;
+
+    JFactoryTestHit(int data, bool* is_destroyed_flag=nullptr) : data(data), is_destroyed_flag(is_destroyed_flag) {}
+    ~JFactoryTestHit() {
+        if (is_destroyed_flag != nullptr) {
+            *is_destroyed_flag = true;
+        }
+    }
+
+    static std::atomic<size_t>& heap_allocation_count() {
+        static std::atomic<size_t> count {0};
+        return count;
+    }
+    static void* operator new(size_t size) {
+        heap_allocation_count() += 1;
+        return ::operator new(size);
+    }
+    static void operator delete(void* ptr) {
+        ::operator delete(ptr);
+    }
+};
+
+
+/// HitFactory produces many small objects per event, like a hit or cluster factory would
+struct JFactoryTestHitFactory : public JFactoryT<JFactoryTestHit> {
+
+    size_t hit_count;
+
+    JFactoryTestHitFactory(size_t hit_count, bool use_arena) : hit_count(hit_count) {
+        if (use_arena) SetFactoryFlag(USE_ARENA);
+    }
+
+    void Process(const std::shared_ptr<const JEvent>&) override {
+        for (size_t i=0; i<hit_count; ++i) {
+            Insert(Construct((int) i));
+        }
+    }
+};
+
+
+/// AdcHit is plain data, the kind of thing JValueFactoryT is meant for
+struct JFactoryTestAdcHit {
+    int channel;
+    double adc;
+    JFactoryTestAdcHit(int channel, double adc) : channel(channel), adc(adc) {}
+};
+
+struct JFactoryTestAdcHitFactory : public JValueFactoryT<JFactoryTestAdcHit> {
+
+    size_t hit_count;
+
+    explicit JFactoryTestAdcHitFactory(size_t hit_count) : hit_count(hit_count) {}
+
+    void Process(const std::shared_ptr<const JEvent>&) override {
+        for (size_t i=0; i<hit_count; ++i) {
+            Emplace((int) i, 0.5 * i);
+        }
+    }
+};
+
+
 struct JFactoryTestDummySource: public JEventSource {
 
     JFactoryTestDummySource() : JEventSource("dummy", nullptr) {}
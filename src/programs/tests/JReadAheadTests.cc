@@ -0,0 +1,174 @@
+
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include "catch.hpp"
+
+#include <JANA/JApplication.h>
+#include <JANA/JEventSource.h>
+#include <JANA/JEventProcessor.h>
+#include <JANA/Utils/JReadAhead.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace jreadaheadtests {
+
+struct Record {
+    std::vector<char> payload;
+    int id = -1;
+};
+
+/// Pretends to read record_count records of record_size bytes each from a slow disk
+struct SlowReader {
+    int record_count;
+    size_t record_size;
+    std::chrono::microseconds latency;
+    int next_id = 0;
+
+    bool operator()(Record& record) {
+        if (next_id == record_count) return false;
+        std::this_thread::sleep_for(latency);
+        record.payload.resize(record_size);
+        record.id = next_id++;
+        return true;
+    }
+};
+
+std::vector<int> drain(JReadAhead<Record>& readahead) {
+    std::vector<int> ids;
+    while (true) {
+        std::unique_ptr<Record> record;
+        auto status = readahead.TryPop(record);
+        if (status == JReadAhead<Record>::Status::Finished) break;
+        if (status == JReadAhead<Record>::Status::NotReady) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        ids.push_back(record->id);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));  // Processing is the bottleneck
+        readahead.Recycle(std::move(record));
+    }
+    return ids;
+}
+
+struct ReadAheadSource : public JEventSource {
+    JReadAhead<Record> readahead;
+
+    ReadAheadSource(JApplication* app, int record_count)
+        : JEventSource("ReadAheadSource", app)
+        , readahead(SlowReader{record_count, 64, std::chrono::microseconds(100)},
+                    [](const Record& r){ return r.payload.size(); }) {
+        SetTypeName("ReadAheadSource");
+    }
+
+    void Open() override {
+        readahead.Configure(GetApplication()->GetJParameterManager(), "readaheadsource");
+        readahead.Start();
+    }
+
+    void Close() override {
+        readahead.Stop();
+    }
+
+    void GetEvent(std::shared_ptr<JEvent> event) override {
+        std::unique_ptr<Record> record;
+        switch (readahead.TryPop(record)) {
+            case JReadAhead<Record>::Status::NotReady: throw RETURN_STATUS::kBUSY;
+            case JReadAhead<Record>::Status::Finished: throw RETURN_STATUS::kNO_MORE_EVENTS;
+            case JReadAhead<Record>::Status::Ready: break;
+        }
+        event->SetEventNumber(record->id);
+        readahead.Recycle(std::move(record));
+    }
+};
+
+struct OrderProcessor : public JEventProcessor {
+    std::atomic_int processed_count {0};
+    void Process(const std::shared_ptr<const JEvent>&) override {
+        processed_count += 1;
+    }
+};
+
+} // namespace jreadaheadtests
+
+
+TEST_CASE("JReadAheadTests") {
+    using namespace jreadaheadtests;
+
+    SECTION("Records come out in order, and buffers are reused") {
+        JReadAhead<Record> readahead(SlowReader{500, 16, std::chrono::microseconds(10)});
+        readahead.SetDepth(4);
+        readahead.Start();
+        auto ids = drain(readahead);
+        readahead.Stop();
+
+        std::vector<int> expected(500);
+        std::iota(expected.begin(), expected.end(), 0);
+        REQUIRE(ids == expected);
+        auto metrics = readahead.GetMetrics();
+        REQUIRE(metrics.records_read == 500);
+        REQUIRE(metrics.max_records_in_flight <= 4);
+        REQUIRE(metrics.buffers_allocated <= 5);  // One per slot, plus the one the consumer is holding
+        REQUIRE(metrics.reader_stalls > 0);
+    }
+
+    SECTION("Bytes in flight are bounded") {
+        JReadAhead<Record> readahead(SlowReader{200, 100, std::chrono::microseconds(10)},
+                                     [](const Record& r){ return r.payload.size(); });
+        readahead.SetDepth(100);
+        readahead.SetMaxBytesInFlight(250);
+        readahead.Start();
+        auto ids = drain(readahead);
+        readahead.Stop();
+
+        REQUIRE(ids.size() == 200);
+        auto metrics = readahead.GetMetrics();
+        REQUIRE(metrics.bytes_read == 200 * 100);
+        REQUIRE(metrics.bytes_in_flight == 0);
+        REQUIRE(metrics.max_records_in_flight <= 3);  // A record is only started while under the limit
+        REQUIRE(metrics.max_bytes_in_flight <= 300);
+    }
+
+    SECTION("Reader errors surface in TryPop") {
+        int calls = 0;
+        JReadAhead<Record> readahead([&](Record&) -> bool {
+            if (++calls == 3) throw std::runtime_error("Disk on fire");
+            return true;
+        });
+        readahead.Start();
+        REQUIRE_THROWS_AS(drain(readahead), std::runtime_error);
+        readahead.Stop();
+    }
+
+    SECTION("Stop can interrupt a reader which is waiting for room") {
+        JReadAhead<Record> readahead(SlowReader{1000, 16, std::chrono::microseconds(0)});
+        readahead.SetDepth(2);
+        readahead.Start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        readahead.Stop();
+        REQUIRE(readahead.GetMetrics().records_read == 2);
+    }
+}
+
+
+TEST_CASE("JReadAheadEventSourceTests") {
+    using namespace jreadaheadtests;
+    JApplication app;
+    auto source = new ReadAheadSource(&app, 300);
+    auto processor = new OrderProcessor;
+    app.Add(source);
+    app.Add(processor);
+    app.SetParameterValue("nthreads", 4);
+    app.SetParameterValue("readaheadsource:readahead_depth", 16);
+    app.SetParameterValue("log:global", "OFF");
+    app.Run(true);
+
+    REQUIRE(processor->processed_count == 300);
+    auto metrics = source->readahead.GetMetrics();
+    REQUIRE(metrics.records_read == 300);
+    REQUIRE(metrics.max_records_in_flight <= 16);
+}
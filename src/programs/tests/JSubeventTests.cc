@@ -0,0 +1,211 @@
+// Copyright 2020, Jefferson Science Associates, LLC.
+// Subject to the terms in the LICENSE file found in the top-level directory.
+
+#include <catch.hpp>
+#include <JANA/JApplication.h>
+#include <JANA/JEventSource.h>
+#include <JANA/JEventProcessor.h>
+#include <JANA/JSubeventProcessor.h>
+#include <JANA/Engine/JArrowProcessingController.h>
+#include <JANA/Engine/JSubeventArrow.h>
+
+#include <set>
+#include <thread>
+
+namespace jsubeventtests {
+
+struct Cluster : public JObject {
+    int value;
+    int squared = 0;
+    explicit Cluster(int value) : value(value) {}
+};
+
+struct ClusterSum : public JObject {
+    long sum;
+    size_t cluster_count;
+    ClusterSum(long sum, size_t cluster_count) : sum(sum), cluster_count(cluster_count) {}
+};
+
+/// Event n contains clusters 0..(n%5)*10-1, so every fifth event has none at all
+struct ClusterSource : public JEventSource {
+    ClusterSource() : JEventSource("ClusterSource", nullptr) {
+        SetTypeName("ClusterSource");
+    }
+    void GetEvent(std::shared_ptr<JEvent>) override {}
+};
+
+size_t cluster_count_for(uint64_t event_number) {
+    return (event_number % 5) * 10;
+}
+
+struct SquaringSubeventProcessor : public JSubeventProcessor {
+    std::chrono::milliseconds process_latency {0};
+    std::mutex thread_ids_mutex;
+    std::set<std::thread::id> process_thread_ids;
+    std::atomic_int merge_count {0};
+    std::atomic_int out_of_order_merges {0};
+
+    SquaringSubeventProcessor() {
+        SetTypeName("SquaringSubeventProcessor");
+    }
+
+    void split(JEvent& parent, std::vector<JObject*>& subevents) override {
+        for (size_t i=0; i<cluster_count_for(parent.GetEventNumber()); ++i) {
+            subevents.push_back(new Cluster((int) i));
+        }
+    }
+
+    void process(JObject& subevent) override {
+        auto& cluster = static_cast<Cluster&>(subevent);
+        cluster.squared = cluster.value * cluster.value;
+        std::this_thread::sleep_for(process_latency);
+        std::lock_guard<std::mutex> lock(thread_ids_mutex);
+        process_thread_ids.insert(std::this_thread::get_id());
+    }
+
+    void merge(JEvent& parent, std::vector<JObject*>& subevents) override {
+        merge_count++;
+        long sum = 0;
+        for (size_t i=0; i<subevents.size(); ++i) {
+            auto cluster = static_cast<Cluster*>(subevents[i]);
+            if (cluster->value != (int) i) out_of_order_merges++;
+            sum += cluster->squared;
+        }
+        parent.Insert(new ClusterSum(sum, subevents.size()));
+    }
+};
+
+struct CheckingProcessor : public JEventProcessor {
+    std::atomic_int processed_count {0};
+    std::atomic_int wrong_count {0};
+
+    void Process(const std::shared_ptr<const JEvent>& event) override {
+        processed_count++;
+        auto n = cluster_count_for(event->GetEventNumber());
+        long expected_sum = 0;
+        for (size_t i=0; i<n; ++i) expected_sum += i*i;
+        auto sums = event->Get<ClusterSum>();
+        if (sums.size() != 1 || sums[0]->sum != expected_sum || sums[0]->cluster_count != n) {
+            wrong_count++;
+        }
+    }
+};
+
+TEST_CASE("JSubeventTests") {
+
+    JApplication app;
+    app.Add(new ClusterSource);
+    auto subevent_proc = new SquaringSubeventProcessor;
+    auto checking_proc = new CheckingProcessor;
+    app.Add(subevent_proc);
+    app.Add(checking_proc);
+
+    SECTION("Every event is split, processed, merged back together, and processed") {
+        auto nthreads = GENERATE(1, 4);
+        auto scheduler = GENERATE(as<std::string>{}, "roundrobin", "eventdriven");
+        app.SetParameterValue("nthreads", nthreads);
+        app.SetParameterValue("jana:scheduler", scheduler);
+        app.SetParameterValue("jana:nevents", 50);
+        app.SetParameterValue("jana:subevent_chunksize", 3);
+        app.Run(true);
+
+        REQUIRE(subevent_proc->merge_count == 50);
+        REQUIRE(subevent_proc->out_of_order_merges == 0);
+        REQUIRE(checking_proc->processed_count == 50);
+        REQUIRE(checking_proc->wrong_count == 0);
+    }
+
+    SECTION("An event may split into more subevents than the lock-free queues can hold") {
+        auto nthreads = GENERATE(1, 4);
+        auto scheduler = GENERATE(as<std::string>{}, "roundrobin", "eventdriven");
+        app.SetParameterValue("nthreads", nthreads);
+        app.SetParameterValue("jana:scheduler", scheduler);
+        app.SetParameterValue("jana:queue_backend", "lockfree");
+        app.SetParameterValue("jana:subevent_queue_threshold", 4);  // Rings hold 8 subevents, events have up to 40
+        app.SetParameterValue("jana:nevents", 50);
+        app.Run(true);
+
+        REQUIRE(subevent_proc->merge_count == 50);
+        REQUIRE(subevent_proc->out_of_order_merges == 0);
+        REQUIRE(checking_proc->processed_count == 50);
+        REQUIRE(checking_proc->wrong_count == 0);
+    }
+
+    SECTION("Subevents from a single event are spread across workers") {
+        subevent_proc->process_latency = std::chrono::milliseconds(2);
+        app.SetParameterValue("nthreads", 4);
+        app.SetParameterValue("jana:nevents", 5);  // Events 1..4 have 10..40 clusters apiece
+        app.SetParameterValue("jana:event_source_chunksize", 1);
+        app.SetParameterValue("jana:subevent_chunksize", 1);
+        app.Run(true);
+
+        REQUIRE(checking_proc->processed_count == 5);
+        REQUIRE(checking_proc->wrong_count == 0);
+        REQUIRE(subevent_proc->process_thread_ids.size() > 1);
+    }
+
+    SECTION("Changing the event queue threshold leaves the subevent queues alone") {
+        app.SetParameterValue("jana:event_queue_threshold", 80);
+        app.SetParameterValue("jana:subevent_queue_threshold", 50);
+        app.Initialize();
+        auto japc = app.GetService<JArrowProcessingController>();
+        japc->set_event_queue_threshold(7);
+
+        auto perf = japc->measure_internal_performance();
+        REQUIRE(perf->event_queue_capacity == 2 * 7);  // The source's queue and the merged queue
+        for (auto& arrow : perf->arrows) {
+            if (arrow.arrow_name == "SquaringSubeventProcessor:process" || arrow.arrow_name == "SquaringSubeventProcessor:merge") {
+                REQUIRE(arrow.threshold == 50);
+            }
+            else if (arrow.arrow_type != JArrow::NodeType::Source) {
+                REQUIRE(arrow.threshold == 7);
+            }
+        }
+    }
+}
+
+/// Keeps track of how many of these are still alive
+struct CountedCluster : public JObject {
+    static int alive;
+    CountedCluster() { alive++; }
+    ~CountedCluster() override { alive--; }
+};
+int CountedCluster::alive = 0;
+
+struct CountedSubeventProcessor : public JSubeventProcessor {
+    void split(JEvent&, std::vector<JObject*>& subevents) override {
+        for (int i=0; i<10; ++i) subevents.push_back(new CountedCluster);
+    }
+    void process(JObject&) override {}
+    void merge(JEvent&, std::vector<JObject*>&) override {}
+};
+
+TEST_CASE("JSubeventTests: Subevents left behind are deleted along with the arrows") {
+
+    CountedSubeventProcessor processor;
+    JMailbox<Event> events;
+    JMailbox<Event> merged_events;
+    auto subevents = new JMailbox<JSubevent>(4);
+    auto processed_subevents = new JMailbox<JSubevent>(100);
+    auto split = new JSplitArrow("split", &processor, &events, subevents);
+    auto process = new JSubeventArrow("process", &processor, subevents, processed_subevents);
+    auto merge = new JMergeArrow("merge", &processor, processed_subevents, &merged_events);
+    process->set_chunksize(2);
+    merge->set_chunksize(1);
+
+    auto event = std::make_shared<JEvent>();
+    events.push(event);
+    JArrowMetrics metrics;
+    split->execute(metrics, 0);    // 4 fit into the subevent queue, 6 overflow
+    process->execute(metrics, 0);  // 2 move on to the merge queue
+    merge->execute(metrics, 0);    // 1 waits for the rest of its event
+    REQUIRE(CountedCluster::alive == 10);
+
+    // E.g. the topology was torn down partway through an event
+    delete split;
+    delete process;
+    delete merge;
+    REQUIRE(CountedCluster::alive == 0);
+}
+
+} // namespace jsubeventtests
@@ -1,4 +1,3 @@
-
 // Copyright 2020, Jefferson Science Associates, LLC.
 // Subject to the terms in the LICENSE file found in the top-level directory.
 
@@ -6,6 +5,10 @@
 
 #include "catch.hpp"
 
+#include <thread>
+#include <algorithm>
+#include <iomanip>
+
 
 TEST_CASE("Queue: Basic functionality") {
     JMailbox<int> q;
@@ -33,3 +36,339 @@ TEST_CASE("Queue: Basic functionality") {
     REQUIRE(result == JMailbox<int>::Status::Ready);
 
 }
+
+TEST_CASE("Queue: LockFree backend matches Locking semantics") {
+    JMailbox<int> q(10, 1, false, JMailbox<int>::Backend::LockFree);
+    REQUIRE(q.get_backend() == JMailbox<int>::Backend::LockFree);
+    REQUIRE(q.size() == 0);
+
+    int item = 22;
+    q.push(item, 0);
+    REQUIRE(q.size() == 1);
+
+    std::vector<int> items;
+    auto result = q.pop(items, 22);
+    REQUIRE(items.size() == 1);
+    REQUIRE(items[0] == 22);
+    REQUIRE(q.size() == 0);
+    REQUIRE(result == JMailbox<int>::Status::Empty);
+
+    std::vector<int> buffer {1,2,3};
+    q.push(buffer, 0);
+    REQUIRE(q.size() == 3);
+    REQUIRE(buffer.size() == 0);
+
+    items.clear();
+    result = q.pop(items, 2);
+    REQUIRE(items.size() == 2);
+    REQUIRE(items[0] == 1);
+    REQUIRE(items[1] == 2);
+    REQUIRE(q.size() == 1);
+    REQUIRE(result == JMailbox<int>::Status::Ready);
+
+    bool success = false;
+    result = q.pop(item, success);
+    REQUIRE(success);
+    REQUIRE(item == 3);
+    REQUIRE(result == JMailbox<int>::Status::Empty);
+
+    result = q.pop(item, success);
+    REQUIRE(!success);
+    REQUIRE(result == JMailbox<int>::Status::Empty);
+
+    SECTION("Reservations are bounded by the threshold") {
+        auto reserved = q.reserve(7);
+        REQUIRE(reserved == 7);
+        reserved = q.reserve(7);
+        REQUIRE(reserved == 3);
+        REQUIRE(q.reserve(1) == 0);
+
+        std::vector<int> chunk {1,2,3,4,5,6,7};
+        q.push(chunk, 7);
+        REQUIRE(q.reserve(7) == 0);  // 7 in queue plus 3 still reserved
+
+        std::vector<int> empty;
+        q.push(empty, 3);  // Give back the unused reservation
+        REQUIRE(q.reserve(7) == 3);
+    }
+
+    SECTION("Pushing past the threshold reports Full") {
+        std::vector<int> chunk {1,2,3,4,5,6,7,8,9,10,11};
+        result = q.push(chunk);
+        REQUIRE(result == JMailbox<int>::Status::Full);
+        REQUIRE(q.size() == 11);
+    }
+
+    SECTION("Pushing past the ring's capacity throws instead of waiting forever") {
+        std::vector<int> chunk(32);  // Twice the threshold, rounded up to a power of two
+        q.push(chunk);
+        REQUIRE(q.size() == 32);
+        REQUIRE(q.reserve(1) == 0);
+        REQUIRE_THROWS_AS(q.push(item), JException);
+    }
+}
+
+TEST_CASE("Queue: LockFree backend under concurrent producers and consumers") {
+
+    const int producer_count = 4;
+    const int consumer_count = 4;
+    const int items_per_producer = 20000;
+
+    JMailbox<int> q(64, 1, false, JMailbox<int>::Backend::LockFree);
+    std::atomic<long> consumed_sum {0};
+    std::atomic<int> consumed_count {0};
+
+    std::vector<std::thread> threads;
+    for (int p=0; p<producer_count; ++p) {
+        threads.emplace_back([&](){
+            for (int i=1; i<=items_per_producer; ++i) {
+                int item = i;
+                while (q.reserve(1) == 0) std::this_thread::yield();
+                q.push(item, 1);
+            }
+        });
+    }
+    for (int c=0; c<consumer_count; ++c) {
+        threads.emplace_back([&](){
+            std::vector<int> buffer;
+            while (consumed_count < producer_count * items_per_producer) {
+                buffer.clear();
+                q.pop(buffer, 5);
+                for (int x : buffer) consumed_sum += x;
+                consumed_count += buffer.size();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    long expected_sum = (long) producer_count * items_per_producer * (items_per_producer + 1) / 2;
+    REQUIRE(consumed_count == producer_count * items_per_producer);
+    REQUIRE(consumed_sum == expected_sum);
+    REQUIRE(q.size() == 0);
+}
+
+namespace queuetests {
+
+/// Location 1 is nearer to location 0 than location 2 is. Location 2 starts out with items 1..8.
+std::unique_ptr<JMailbox<int>> make_stealing_mailbox(JMailbox<int>::Backend backend) {
+    auto q = std::unique_ptr<JMailbox<int>>(new JMailbox<int>(100, 3, true, backend));
+    q->set_neighbors(0, {{1}, {2}});
+    std::vector<int> far_items {1,2,3,4,5,6,7,8};
+    q->push(far_items, 0, 2);
+    return q;
+}
+} // namespace queuetests
+
+TEST_CASE("Queue: Work stealing between locations") {
+
+    auto backend = GENERATE(JMailbox<int>::Backend::Locking, JMailbox<int>::Backend::LockFree);
+
+    SECTION("Stealing takes a batch from a non-empty neighbor") {
+        auto q = queuetests::make_stealing_mailbox(backend);
+        std::vector<int> buffer;
+        size_t stolen_count = 0;
+        auto result = q->pop(buffer, 3, 0, stolen_count);
+        REQUIRE(result == JMailbox<int>::Status::Ready);
+        REQUIRE(stolen_count == 3);
+        REQUIRE(buffer == std::vector<int>({1,2,3}));
+        REQUIRE(q->size(2) == 5);
+    }
+
+    SECTION("Stealing prefers the nearest tier, even when a farther queue is fuller") {
+        auto q = queuetests::make_stealing_mailbox(backend);
+        std::vector<int> near_items {10,11};
+        q->push(near_items, 0, 1);
+        std::vector<int> buffer;
+        size_t stolen_count = 0;
+        q->pop(buffer, 10, 0, stolen_count);
+        REQUIRE(stolen_count == 1);  // No more than half of the victim's queue
+        REQUIRE(buffer == std::vector<int>({10}));
+        REQUIRE(q->size(1) == 1);
+        REQUIRE(q->size(2) == 8);
+    }
+
+    SECTION("Single-item pops steal half of the victim's queue and keep the surplus locally") {
+        auto q = queuetests::make_stealing_mailbox(backend);
+        int item = 0;
+        bool success = false;
+        size_t stolen_count = 0;
+        q->pop(item, success, 0, stolen_count);
+        REQUIRE(success);
+        REQUIRE(item == 1);
+        REQUIRE(stolen_count == 4);
+        REQUIRE(q->size(0) == 3);
+        REQUIRE(q->size(2) == 4);
+    }
+
+    SECTION("Single-item pops only keep as much surplus as they could reserve locally") {
+        JMailbox<int> q(4, 2, true, backend);
+        std::vector<int> far_items {1,2,3,4,5,6,7,8};
+        q.push(far_items, 0, 1);
+        REQUIRE(q.reserve(3, 0) == 3);
+        int item = 0;
+        bool success = false;
+        size_t stolen_count = 0;
+        q.pop(item, success, 0, stolen_count);
+        REQUIRE(success);
+        REQUIRE(stolen_count == 2);  // The returned item, plus the one slot that was left to reserve
+        REQUIRE(q.size(0) == 1);
+        REQUIRE(q.reserve(1, 0) == 0);
+        std::vector<int> reserved_items {10,11,12};
+        REQUIRE_NOTHROW(q.push(reserved_items, 3, 0));
+        REQUIRE(q.size(0) == 4);
+    }
+
+    SECTION("Local items are always preferred over stealing") {
+        auto q = queuetests::make_stealing_mailbox(backend);
+        int local_item = 42;
+        q->push(local_item, 0, 0);
+        int item = 0;
+        bool success = false;
+        size_t stolen_count = 0;
+        q->pop(item, success, 0, stolen_count);
+        REQUIRE(success);
+        REQUIRE(item == 42);
+        REQUIRE(stolen_count == 0);
+    }
+
+    SECTION("Without work stealing, an empty location stays empty") {
+        JMailbox<int> q(100, 2, false, backend);
+        int item = 7;
+        q.push(item, 0, 1);
+        bool success = true;
+        auto result = q.pop(item, success, 0);
+        REQUIRE(!success);
+        REQUIRE(result == JMailbox<int>::Status::Empty);
+    }
+}
+
+
+TEST_CASE("Queue: Push signal wakes parked consumers") {
+
+    auto backend = GENERATE(JMailbox<int>::Backend::Locking, JMailbox<int>::Backend::LockFree);
+    JMailbox<int> q(10, 1, false, backend);
+    auto& signal = q.get_push_signal();
+
+    SECTION("Waiting without a push times out") {
+        auto epoch = signal.get_epoch();
+        REQUIRE(signal.wait_for(epoch, std::chrono::milliseconds(1)) == false);
+    }
+
+    SECTION("A push after the epoch was read is never lost") {
+        auto epoch = signal.get_epoch();
+        int x = 22;
+        q.push(x);
+        REQUIRE(signal.has_changed(epoch));
+        REQUIRE(signal.wait_for(epoch, std::chrono::seconds(10)) == true);
+    }
+
+    SECTION("Pushing an empty buffer does not signal") {
+        auto epoch = signal.get_epoch();
+        std::vector<int> buffer;
+        q.push(buffer);
+        REQUIRE(!signal.has_changed(epoch));
+    }
+
+    SECTION("A parked consumer is woken by a push from another thread") {
+        auto epoch = signal.get_epoch();
+        std::thread producer([&](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            std::vector<int> buffer {1, 2, 3};
+            q.push(buffer);
+        });
+        auto start = std::chrono::steady_clock::now();
+        bool notified = signal.wait_for(epoch, std::chrono::seconds(10));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        producer.join();
+        REQUIRE(notified);
+        REQUIRE(elapsed < std::chrono::seconds(5));
+        REQUIRE(q.size() == 3);
+    }
+}
+
+TEST_CASE("Queue: Pushes skip the signal until somebody asks for it") {
+
+    auto backend = GENERATE(JMailbox<int>::Backend::Locking, JMailbox<int>::Backend::LockFree);
+    JMailbox<int> q(10, 1, false, backend);
+    int x = 22;
+    q.push(x);
+    std::vector<int> buffer {1, 2};
+    q.push(buffer);
+
+    auto& signal = q.get_push_signal();
+    REQUIRE(signal.get_epoch() == 0);
+    q.push(x);
+    REQUIRE(signal.get_epoch() == 1);
+}
+
+namespace queuetests {
+
+struct BenchmarkResult {
+    double ops_per_sec;
+    double p50_latency_us;
+    double p99_latency_us;
+    double p999_latency_us;
+};
+
+/// Each thread repeatedly pushes one item and pops one item (retrying on Congested/Empty),
+/// recording the latency of each push+pop round trip.
+BenchmarkResult benchmark_mailbox(JMailbox<int>::Backend backend, size_t nthreads, size_t iterations_per_thread) {
+
+    using clock_t = std::chrono::steady_clock;
+    JMailbox<int> q(2*nthreads + 16, 1, false, backend);
+    std::vector<std::vector<double>> latencies(nthreads);
+    std::vector<std::thread> threads;
+
+    auto start = clock_t::now();
+    for (size_t t=0; t<nthreads; ++t) {
+        threads.emplace_back([&, t](){
+            auto& lats = latencies[t];
+            lats.reserve(iterations_per_thread);
+            for (size_t i=0; i<iterations_per_thread; ++i) {
+                auto before = clock_t::now();
+                int item = (int) i;
+                q.push(item);
+                bool success = false;
+                while (!success) {
+                    q.pop(item, success);
+                }
+                lats.push_back(std::chrono::duration<double, std::micro>(clock_t::now() - before).count());
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    auto elapsed_s = std::chrono::duration<double>(clock_t::now() - start).count();
+
+    std::vector<double> all;
+    for (auto& lats : latencies) all.insert(all.end(), lats.begin(), lats.end());
+    std::sort(all.begin(), all.end());
+
+    BenchmarkResult result;
+    result.ops_per_sec = 2.0 * all.size() / elapsed_s;  // One push and one pop per iteration
+    result.p50_latency_us = all[all.size() / 2];
+    result.p99_latency_us = all[all.size() * 99 / 100];
+    result.p999_latency_us = all[all.size() * 999 / 1000];
+    return result;
+}
+} // namespace queuetests
+
+
+TEST_CASE("QueueBackendBenchmark", "[.][performance]") {
+
+    using Backend = JMailbox<int>::Backend;
+    const size_t total_iterations = 1000000;
+
+    std::cout << " threads |   backend |       ops/sec |  p50 [us] |  p99 [us] | p99.9 [us]" << std::endl;
+    std::cout << "---------+-----------+---------------+-----------+-----------+-----------" << std::endl;
+    for (size_t nthreads = 1; nthreads <= 128; nthreads *= 2) {
+        for (auto backend : {Backend::Locking, Backend::LockFree}) {
+            auto r = queuetests::benchmark_mailbox(backend, nthreads, total_iterations / nthreads);
+            std::cout << std::setw(8) << nthreads << " | "
+                      << std::setw(9) << ((backend == Backend::Locking) ? "locking" : "lockfree") << " | "
+                      << std::setw(13) << std::fixed << std::setprecision(0) << r.ops_per_sec << " | "
+                      << std::setw(9) << std::setprecision(2) << r.p50_latency_us << " | "
+                      << std::setw(9) << r.p99_latency_us << " | "
+                      << std::setw(9) << r.p999_latency_us << std::endl;
+        }
+    }
+}
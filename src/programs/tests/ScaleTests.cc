@@ -4,6 +4,8 @@
 #include <JANA/Utils/JCpuInfo.h>
 #include <JANA/Engine/JArrowProcessingController.h>
 
+#include <iomanip>
+
 #include "ScaleTests.h"
 
 TEST_CASE("NThreads") {
@@ -58,6 +60,37 @@ TEST_CASE("ScaleNWorkerUpdate") {
     app.Quit();
 }
 
+TEST_CASE("ScaleWhileRunningKeepsTopologyRunning") {
+    auto scheduler = GENERATE(as<std::string>{}, "roundrobin", "eventdriven");
+    JApplication app;
+    auto processor = new scaletest::CountingProcessor(1);
+    app.Add(new scaletest::CountingSource(&app));
+    app.Add(processor);
+    app.SetParameterValue("jana:scheduler", scheduler);
+    app.SetParameterValue("jana:nevents", 2000);
+    app.SetParameterValue("nthreads", 2);
+    app.Run(false);
+    auto japc = app.GetService<JArrowProcessingController>();
+
+    for (size_t nthreads : {6, 1, 4}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto processed_before = processor->processed_count.load();
+        app.Scale(nthreads);
+        REQUIRE(!japc->is_stopped());   // Scaling live never pauses the topology
+        auto perf_summary = japc->measure_internal_performance();
+        REQUIRE(perf_summary->thread_count == nthreads);
+        REQUIRE(perf_summary->workers.size() == nthreads);
+        REQUIRE(processor->processed_count >= processed_before);
+    }
+
+    // Wait for the source to run dry. Every event must make it through, despite workers joining and retiring
+    while (!japc->is_stopped()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    app.Stop(true);
+    REQUIRE(processor->processed_count == 2000);
+}
+
 TEST_CASE("ScaleThroughputImprovement", "[.][performance]") {
 
     auto parms = new JParameterManager;
@@ -92,3 +125,64 @@ TEST_CASE("ScaleThroughputImprovement", "[.][performance]") {
     REQUIRE(throughput_hz_2 > throughput_hz_1*1.5);
     REQUIRE(throughput_hz_4 > throughput_hz_2*1.25);
 }
+
+TEST_CASE("EventDrivenSchedulerRunsToCompletion") {
+    JApplication app;
+    auto processor = new scaletest::CountingProcessor;
+    app.Add(new scaletest::CountingSource(&app));
+    app.Add(processor);
+    app.SetParameterValue("jana:scheduler", "eventdriven");
+    app.SetParameterValue("jana:nevents", 500);
+    app.SetParameterValue("nthreads", 8);
+    app.Run(true);
+    REQUIRE(processor->processed_count == 500);
+}
+
+TEST_CASE("AdaptiveBackoffRunsToCompletion") {
+    JApplication app;
+    auto processor = new scaletest::CountingProcessor;
+    app.Add(new scaletest::CountingSource(&app));
+    app.Add(processor);
+    app.SetParameterValue("jana:backoff_strategy", "adaptive");
+    app.SetParameterValue("jana:nevents", 500);
+    app.SetParameterValue("nthreads", 4);
+    app.Run(true);
+    REQUIRE(processor->processed_count == 500);
+
+    auto japc = app.GetService<JArrowProcessingController>();
+    auto perf = japc->measure_internal_performance();
+    for (auto& worker : perf->workers) {
+        REQUIRE(worker.total_spin_time_ms >= 0);
+        REQUIRE(worker.total_park_time_ms >= 0);
+        REQUIRE(worker.total_spin_time_ms + worker.total_park_time_ms <= worker.total_retry_time_ms + 1e-6);
+    }
+}
+
+TEST_CASE("SchedulerThroughputComparison", "[.][performance]") {
+
+    std::cout << std::endl;
+    std::cout << "  Scheduler   | Threads | Throughput [Hz] " << std::endl;
+    std::cout << "--------------+---------+-----------------" << std::endl;
+
+    for (std::string scheduler : {"roundrobin", "eventdriven"}) {
+        for (size_t nthreads = 1; nthreads <= 256; nthreads *= 2) {
+            auto params = new JParameterManager;
+            params->SetParameter("log:off", "JArrowProcessingController,JApplication");
+            JApplication app(params);
+            app.SetTicker(false);
+            app.Add(new scaletest::CountingSource(&app));
+            app.Add(new scaletest::CountingProcessor(1));
+            app.SetParameterValue("jana:scheduler", scheduler);
+            app.SetParameterValue("nthreads", nthreads);
+            app.Initialize();
+            auto japc = app.GetService<JArrowProcessingController>();
+            app.Run(false);
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+            auto throughput_hz = japc->measure_internal_performance()->latest_throughput_hz;
+            app.Quit();
+            std::cout << "  " << std::setw(11) << std::left << scheduler << " | "
+                      << std::setw(7) << std::right << nthreads << " | "
+                      << std::setw(15) << throughput_hz << std::endl;
+        }
+    }
+}
@@ -27,5 +27,27 @@ struct DummyProcessor : public JEventProcessor {
         std::this_thread::sleep_for(std::chrono::nanoseconds(1));
     }
 };
+
+struct CountingSource : public JEventSource {
+
+    uint64_t cpu_ms;
+    explicit CountingSource(JApplication *app, uint64_t cpu_ms=0) : JEventSource("CountingSource", app), cpu_ms(cpu_ms) {}
+
+    void GetEvent(std::shared_ptr<JEvent>) override {
+        if (cpu_ms > 0) consume_cpu_ms(cpu_ms);
+    }
+};
+
+struct CountingProcessor : public JEventProcessor {
+
+    uint64_t cpu_ms;
+    std::atomic_ullong processed_count {0};
+    explicit CountingProcessor(uint64_t cpu_ms=0) : cpu_ms(cpu_ms) {}
+
+    void Process(const std::shared_ptr<const JEvent> &) override {
+        if (cpu_ms > 0) consume_cpu_ms(cpu_ms);
+        processed_count += 1;
+    }
+};
 } // namespace scaletest
 #endif //JANA2_SCALETESTS_H
@@ -6,8 +6,12 @@
 #include "catch.hpp"
 
 #include <JANA/Engine/JScheduler.h>
+#include <JANA/Engine/JEventDrivenScheduler.h>
 #include <TestTopologyComponents.h>
 #include <JANA/Engine/JArrowTopology.h>
+#include <JANA/Engine/JEventSourceArrow.h>
+#include <JANA/Utils/JEventPool.h>
+#include <JANA/JApplication.h>
 
 TEST_CASE("SchedulerTests") {
 
@@ -213,3 +217,152 @@ TEST_CASE("SchedulerRoundRobinBehaviorTests") {
 }
 
 
+TEST_CASE("EventDrivenSchedulerTests") {
+
+    RandIntSource source;
+    MultByTwoProcessor p1;
+    SubOneProcessor p2;
+    SumSink<double> sink;
+
+    JArrowTopology topology;
+
+    auto q1 = new JMailbox<int>();
+    auto q2 = new JMailbox<double>();
+    auto q3 = new JMailbox<double>();
+
+    auto emit_rand_ints = new SourceArrow<int>("emit_rand_ints", source, q1);
+    auto multiply_by_two = new MapArrow<int,double>("multiply_by_two", p1, q1, q2);
+    auto subtract_one = new MapArrow<double,double>("subtract_one", p2, q2, q3);
+    auto sum_everything = new SinkArrow<double>("sum_everything", sink, q3);
+
+    emit_rand_ints->attach(multiply_by_two);
+    multiply_by_two->attach(subtract_one);
+    subtract_one->attach(sum_everything);
+
+    topology.sources.push_back(emit_rand_ints);
+    topology.arrows.push_back(emit_rand_ints);
+    topology.arrows.push_back(multiply_by_two);
+    topology.arrows.push_back(subtract_one);
+    topology.arrows.push_back(sum_everything);
+    topology.sinks.push_back(sum_everything);
+
+    emit_rand_ints->set_chunksize(1);
+    topology.run(1);
+
+    JEventDrivenScheduler scheduler(&topology);
+
+    SECTION("Arrows are switched to zero backoff tries") {
+        for (auto arrow : topology.arrows) {
+            REQUIRE(arrow->get_backoff_tries() == 0);
+        }
+    }
+
+    SECTION("Only arrows with pending input are runnable") {
+        // Initially nothing is in any queue, so every worker gets the source or nothing
+        auto first = scheduler.next_assignment(0, nullptr, JArrowMetrics::Status::NotRunYet);
+        REQUIRE(first == emit_rand_ints);
+        auto second = scheduler.next_assignment(1, nullptr, JArrowMetrics::Status::NotRunYet);
+        REQUIRE(second == nullptr);
+
+        // Once the source emits something, the fullest queue wins
+        JArrowMetrics metrics;
+        first->execute(metrics, 0);
+        second = scheduler.next_assignment(1, nullptr, JArrowMetrics::Status::NotRunYet);
+        REQUIRE(second == multiply_by_two);
+    }
+
+    SECTION("When run sequentially, topology finished => scheduler returns nullptr and worker shuts down") {
+
+        auto last_result = JArrowMetrics::Status::NotRunYet;
+        JArrow* assignment = nullptr;
+        do {
+            assignment = scheduler.next_assignment(0, assignment, last_result);
+            if (assignment != nullptr) {
+                JArrowMetrics metrics;
+                assignment->execute(metrics, 0);
+                last_result = metrics.get_last_status();
+            }
+        } while (assignment != nullptr);
+
+        REQUIRE(emit_rand_ints->get_status() == JArrow::Status::Finished);
+        REQUIRE(multiply_by_two->get_status() == JArrow::Status::Paused);
+        REQUIRE(subtract_one->get_status() == JArrow::Status::Paused);
+        REQUIRE(sum_everything->get_status() == JArrow::Status::Paused);
+        REQUIRE(sink.sum == 20 * 13);
+        REQUIRE(scheduler.wait_for_work(0) == false);
+    }
+
+    SECTION("Parked workers are woken by progress and leave once the topology pauses") {
+
+        std::atomic_int finished_workers {0};
+        std::vector<std::thread> workers;
+        for (uint32_t worker_id=0; worker_id<4; ++worker_id) {
+            workers.emplace_back([&, worker_id](){
+                auto last_result = JArrowMetrics::Status::NotRunYet;
+                JArrow* assignment = nullptr;
+                while (true) {
+                    assignment = scheduler.next_assignment(worker_id, assignment, last_result);
+                    if (assignment == nullptr) {
+                        last_result = JArrowMetrics::Status::NotRunYet;
+                        if (!scheduler.wait_for_work(worker_id)) break;
+                        continue;
+                    }
+                    JArrowMetrics metrics;
+                    assignment->execute(metrics, 0);
+                    last_result = metrics.get_last_status();
+                    if (last_result == JArrowMetrics::Status::KeepGoing) {
+                        scheduler.report_progress(assignment);
+                    }
+                }
+                finished_workers += 1;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        REQUIRE(finished_workers == 4);
+        REQUIRE(topology.running_arrow_count == 0);
+        REQUIRE(sink.sum == 20 * 13);
+        REQUIRE(scheduler.get_parked_count() == 0);
+    }
+}
+
+namespace schedulertests {
+struct PlainSource : public JEventSource {
+    PlainSource() : JEventSource("PlainSource") {}
+    void GetEvent(std::shared_ptr<JEvent>) override {}
+};
+} // namespace schedulertests
+
+TEST_CASE("SchedulerBackpressuredSourceTests") {
+
+    JApplication app;
+    app.Initialize();
+    auto pool = std::make_shared<JEventPool>(app.GetService<JComponentManager>(), 1, 1, true);
+    schedulertests::PlainSource source;
+
+    JArrowTopology topology;
+    auto queue = new EventQueue(10);
+    auto arrow = new JEventSourceArrow("source", &source, queue, pool);
+    arrow->set_running_arrows(&topology.running_arrow_count);
+    topology.queues.push_back(queue);
+    topology.arrows.push_back(arrow);
+    topology.sources.push_back(arrow);
+    topology.run(1);
+
+    auto event = pool->get(0);
+    REQUIRE(arrow->is_backpressured());
+
+    SECTION("A backpressured source is still handed out when nothing else is runnable") {
+        JScheduler scheduler(&topology);
+        auto assignment = scheduler.next_assignment(0, nullptr, JArrowMetrics::Status::ComeBackLater);
+        REQUIRE(assignment == arrow);
+
+        // It is sequential, so the next worker has to wait
+        REQUIRE(scheduler.next_assignment(1, nullptr, JArrowMetrics::Status::ComeBackLater) == nullptr);
+
+        // Once the source has been visited, the worker may keep coming back to it
+        REQUIRE(scheduler.next_assignment(0, assignment, JArrowMetrics::Status::ComeBackLater) == arrow);
+    }
+    pool->put(event, 0);
+}